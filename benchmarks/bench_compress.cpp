@@ -0,0 +1,92 @@
+#include <benchmark/benchmark.h>
+
+#include <slogger/CompressedFileSink.hpp>
+#include <slogger/Lz.hpp>
+
+#include <format>
+#include <string>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace
+{
+/** repetitive log text, like a debug capture */
+std::string log_text(size_t size)
+{
+    std::string text;
+    for (uint32_t i = 0; text.size() < size; i++)
+    {
+        text += std::format("src/rtp/session.cpp:{}: [12:00:{:02}.{:09}] INFO "
+                            "- received {} bytes from 192.168.1.{} seq={}\n",
+            100 + i % 7, i / 1000 % 60, i * 7919 % 1000000000,
+            1000 + i % 300, i % 16, i);
+    }
+    text.resize(size);
+    return text;
+}
+
+void BM_LzCompress(benchmark::State& state)
+{
+    const auto text = log_text(state.range(0));
+    std::string out(logging::lz::max_compressed_size(text.size()), '\0');
+    size_t size = 0;
+    for (auto _ : state)
+    {
+        size = logging::lz::compress(text.data(), text.size(), out.data());
+        benchmark::DoNotOptimize(out.data());
+    }
+    state.SetBytesProcessed(state.iterations() * text.size());
+    state.counters["ratio"] = double(text.size()) / double(size);
+}
+BENCHMARK(BM_LzCompress)->Arg(64 * 1024)->Arg(256 * 1024);
+
+void BM_LzDecompress(benchmark::State& state)
+{
+    const auto text = log_text(state.range(0));
+    std::string compressed(logging::lz::max_compressed_size(text.size()), '\0');
+    compressed.resize(
+        logging::lz::compress(text.data(), text.size(), compressed.data()));
+    std::string out(text.size(), '\0');
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(logging::lz::decompress(
+            compressed.data(), compressed.size(), out.data(), out.size()));
+    }
+    state.SetBytesProcessed(state.iterations() * text.size());
+}
+BENCHMARK(BM_LzDecompress)->Arg(256 * 1024);
+
+/** records per second through the sink into /dev/null, arg is the number
+ * of workers
+ */
+void BM_CompressedFileSink(benchmark::State& state)
+{
+    logging::CompressedFileConfig cfg;
+    cfg.workers = state.range(0);
+    double ratio = 0;
+    {
+        logging::CompressedFileSink sink(
+            open("/dev/null", O_WRONLY), true, cfg);
+        const auto now = std::chrono::system_clock::now().time_since_epoch();
+        uint32_t i = 0;
+        for (auto _ : state)
+        {
+            const auto msg = std::format(
+                "received {} bytes from 192.168.1.{}", 1000 + i % 300, i % 16);
+            sink.write(logging::SinkRecord { 12, "src/rtp/session.cpp",
+                logging::Level::INFO, msg, now + std::chrono::microseconds(i) });
+            i++;
+        }
+        sink.flush();
+        state.counters["stalls"] = sink.stalls();
+        ratio = sink.stored_bytes() == 0
+            ? 0.0
+            : double(sink.raw_bytes()) / double(sink.stored_bytes());
+    }
+    state.SetItemsProcessed(state.iterations());
+    state.counters["ratio"] = ratio;
+}
+BENCHMARK(BM_CompressedFileSink)->Arg(1)->Arg(2)->Arg(4);
+
+} // namespace
@@ -0,0 +1,79 @@
+#include <benchmark/benchmark.h>
+
+#include <slogger/ThreadedLogger.hpp>
+
+#include <string_view>
+
+namespace
+{
+static constexpr int DRAIN_EVERY = 64;
+
+#define MESSAGE "received {} bytes from {} port {} err={}"
+
+/** caller side cost of a typical log call when the message is formatted
+ * on the logging thread. The ring is drained outside of the timing.
+ */
+void BM_LogFormatOnCaller(benchmark::State& state)
+{
+    logging::Hard_RT_RecordThreadedLogger logger(true, true);
+    const std::string_view peer = "192.168.1.1";
+    int i = 0;
+    for (auto _ : state)
+    {
+        LOG_INFO(logger, MESSAGE, i, peer, 5004, error::Error::OK);
+        if (++i % DRAIN_EVERY == 0)
+        {
+            state.PauseTiming();
+            while (logger.remove())
+            {
+            }
+            state.ResumeTiming();
+        }
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_LogFormatOnCaller);
+
+/** same message with the arguments captured and formatted when drained */
+void BM_LogDeferred(benchmark::State& state)
+{
+    static constinit logging::LogSite site { __FILE__, __LINE__,
+        logging::Level::INFO, MESSAGE };
+    logging::Hard_RT_RecordThreadedLogger logger(true, true);
+    const std::string_view peer = "192.168.1.1";
+    int i = 0;
+    for (auto _ : state)
+    {
+        logging::log_deferred_at(
+            logger, site, MESSAGE, i, peer, 5004, error::Error::OK);
+        if (++i % DRAIN_EVERY == 0)
+        {
+            state.PauseTiming();
+            while (logger.remove())
+            {
+            }
+            state.ResumeTiming();
+        }
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_LogDeferred);
+
+/** consumer side cost of formatting one deferred record */
+void BM_DrainDeferred(benchmark::State& state)
+{
+    static constinit logging::LogSite site { __FILE__, __LINE__,
+        logging::Level::INFO, MESSAGE };
+    logging::Hard_RT_RecordThreadedLogger logger(true, true);
+    const std::string_view peer = "192.168.1.1";
+    for (auto _ : state)
+    {
+        logging::log_deferred_at(
+            logger, site, MESSAGE, 1234, peer, 5004, error::Error::OK);
+        benchmark::DoNotOptimize(logger.remove());
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_DrainDeferred);
+
+} // namespace
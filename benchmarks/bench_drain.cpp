@@ -0,0 +1,54 @@
+#include <benchmark/benchmark.h>
+
+#include <slogger/DrainScheduler.hpp>
+#include <slogger/ThreadedLogger.hpp>
+
+#include <chrono>
+#include <memory>
+#include <vector>
+
+namespace
+{
+/** drains arg sources holding 64 entries each, by turns or, with the
+ * second arg set, merged in time order
+ */
+void BM_DrainScheduler(benchmark::State& state)
+{
+    const auto count = static_cast<uint32_t>(state.range(0));
+    logging::DrainScheduler scheduler;
+    std::vector<std::shared_ptr<logging::Hard_RT_ThreadedLogger>> loggers;
+    for (uint32_t i = 0; i < count; i++)
+    {
+        loggers.push_back(
+            std::make_shared<logging::Hard_RT_ThreadedLogger>(true, true));
+        scheduler.add(loggers.back());
+    }
+    if (state.range(1) != 0)
+    {
+        scheduler.set_reorder_window(std::chrono::milliseconds(1));
+    }
+
+    uint64_t drained = 0;
+    for (auto _ : state)
+    {
+        state.PauseTiming();
+        for (uint32_t n = 0; n < 64; n++)
+        {
+            for (auto& logger : loggers)
+            {
+                logger->log(1, "src/a.cpp", logging::Level::INFO, "x");
+            }
+        }
+        state.ResumeTiming();
+        drained += scheduler.flush(false,
+            [](const logging::LogEntry& e) { benchmark::DoNotOptimize(&e); });
+    }
+    state.SetItemsProcessed(drained);
+}
+BENCHMARK(BM_DrainScheduler)
+    ->Args({ 2, 0 })
+    ->Args({ 2, 1 })
+    ->Args({ 16, 0 })
+    ->Args({ 16, 1 });
+
+} // namespace
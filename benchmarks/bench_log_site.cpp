@@ -0,0 +1,63 @@
+#include <benchmark/benchmark.h>
+
+#include <slogger/ThreadedLogger.hpp>
+
+namespace
+{
+/** loop without logging, for reference */
+void BM_NoLogging(benchmark::State& state)
+{
+    int i = 0;
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(i++);
+    }
+}
+BENCHMARK(BM_NoLogging);
+
+/** LOG_DEBUG with debug disabled on the logger: one relaxed load of the
+ * site's state plus the logger's flag, both branches predicted not taken.
+ */
+void BM_DisabledSite(benchmark::State& state)
+{
+    logging::Hard_RT_ThreadedLogger logger(false, false);
+    int i = 0;
+    for (auto _ : state)
+    {
+        LOG_DEBUG(logger, "value {}", i);
+        benchmark::DoNotOptimize(i++);
+    }
+}
+BENCHMARK(BM_DisabledSite);
+
+/** same while sites in other files are switched on */
+void BM_DisabledSiteOthersEnabled(benchmark::State& state)
+{
+    logging::enable_log_sites("*/rtp/*");
+    logging::Hard_RT_ThreadedLogger logger(false, false);
+    int i = 0;
+    for (auto _ : state)
+    {
+        LOG_DEBUG(logger, "value {}", i);
+        benchmark::DoNotOptimize(i++);
+    }
+    logging::reset_log_sites();
+}
+BENCHMARK(BM_DisabledSiteOthersEnabled);
+
+/** site switched off by pattern on a logger that has debug enabled */
+void BM_SwitchedOffSite(benchmark::State& state)
+{
+    logging::disable_log_sites("*/bench_log_site.cpp");
+    logging::Hard_RT_ThreadedLogger logger(true, true);
+    int i = 0;
+    for (auto _ : state)
+    {
+        LOG_DEBUG(logger, "value {}", i);
+        benchmark::DoNotOptimize(i++);
+    }
+    logging::reset_log_sites();
+}
+BENCHMARK(BM_SwitchedOffSite);
+
+} // namespace
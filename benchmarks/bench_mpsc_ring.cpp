@@ -0,0 +1,62 @@
+#include <benchmark/benchmark.h>
+
+#include <slogger/MpscRing.hpp>
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+namespace
+{
+
+/** state.range(0) producer threads hammer one ring, the benchmark thread is
+ * the consumer. Reports transferred elements per second.
+ */
+void BM_MpscRingContention(benchmark::State& state)
+{
+    MpscRing<uint64_t, 1024> ring;
+    std::atomic<bool> stop { false };
+
+    std::vector<std::thread> producers;
+    for (int64_t p = 0; p < state.range(0); p++)
+    {
+        producers.emplace_back([&]() {
+            uint64_t i = 0;
+            while (!stop.load(std::memory_order_relaxed))
+            {
+                if (!ring.add(i))
+                {
+                    std::this_thread::yield();
+                    continue;
+                }
+                i++;
+            }
+        });
+    }
+
+    for (auto _ : state)
+    {
+        std::optional<uint64_t> v;
+        while (!(v = ring.remove()))
+        {
+            std::this_thread::yield();
+        }
+        benchmark::DoNotOptimize(v);
+    }
+
+    stop = true;
+    for (auto& t : producers)
+    {
+        t.join();
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_MpscRingContention)
+    ->ArgName("producers")
+    ->Arg(1)
+    ->Arg(4)
+    ->Arg(16)
+    ->Arg(64)
+    ->UseRealTime();
+
+} // namespace
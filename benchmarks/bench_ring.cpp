@@ -0,0 +1,99 @@
+#include <benchmark/benchmark.h>
+
+#include <slogger/RecordRing.hpp>
+#include <slogger/Ring.hpp>
+
+#include <atomic>
+#include <thread>
+
+namespace
+{
+
+/** uncontended cost of one add + remove on the same thread */
+void BM_RingAddRemove(benchmark::State& state)
+{
+    Ring<uint64_t, 1024> ring;
+    uint64_t i = 0;
+    for (auto _ : state)
+    {
+        ring.add(i++);
+        benchmark::DoNotOptimize(ring.remove());
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_RingAddRemove);
+
+
+/** one producer thread pushes as fast as it can, the benchmark thread is the
+ * consumer. Reports transferred elements per second.
+ */
+template<uint32_t SIZE>
+void BM_RingSpscThroughput(benchmark::State& state)
+{
+    Ring<uint64_t, SIZE> ring;
+    std::atomic<bool> stop { false };
+
+    std::thread producer([&]() {
+        uint64_t i = 0;
+        while (!stop.load(std::memory_order_relaxed))
+        {
+            if (!ring.add(i))
+            {
+                std::this_thread::yield();
+                continue;
+            }
+            i++;
+        }
+    });
+
+    for (auto _ : state)
+    {
+        std::optional<uint64_t> v;
+        while (!(v = ring.remove()))
+        {
+            std::this_thread::yield();
+        }
+        benchmark::DoNotOptimize(v);
+    }
+
+    stop = true;
+    producer.join();
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK_TEMPLATE(BM_RingSpscThroughput, 64)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_RingSpscThroughput, 256)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_RingSpscThroughput, 1024)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_RingSpscThroughput, 4096)->UseRealTime();
+
+
+/** a typical log message through a ring of LogEntry objects vs. serialized
+ * in place into a byte ring
+ */
+void BM_LogEntryRing(benchmark::State& state)
+{
+    Ring<logging::LogEntry> ring;
+    const std::string msg = "received 1234 bytes from 192.168.1.1 port 5004";
+    for (auto _ : state)
+    {
+        ring.add(logging::LogEntry {
+            __LINE__, __FILE__, logging::Level::INFO, msg });
+        benchmark::DoNotOptimize(ring.remove());
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_LogEntryRing);
+
+void BM_LogRecordRing(benchmark::State& state)
+{
+    logging::LogRecordRing<> ring;
+    const std::string msg = "received 1234 bytes from 192.168.1.1 port 5004";
+    for (auto _ : state)
+    {
+        ring.add(__LINE__, __FILE__, logging::Level::INFO, msg);
+        benchmark::DoNotOptimize(ring.remove());
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_LogRecordRing);
+
+} // namespace
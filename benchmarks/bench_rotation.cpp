@@ -0,0 +1,165 @@
+#include <benchmark/benchmark.h>
+
+#include <slogger/FdSink.hpp>
+#include <slogger/RotatingFileSink.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <format>
+#include <memory>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace
+{
+static constexpr std::string_view MESSAGE =
+    "received 1234 bytes from 192.168.1.1 port 5004 err=OK";
+
+// small files, so that there are many rotations
+static constexpr uint64_t FILE_SIZE = 256 * 1024;
+static constexpr uint32_t RETENTION = 4;
+
+std::string bench_path()
+{
+    return (std::filesystem::temp_directory_path() / "slogger_bench_rotate")
+        .string();
+}
+
+void remove_files(const std::string& path)
+{
+    const std::filesystem::path p(path);
+    for (const auto& entry :
+        std::filesystem::directory_iterator(p.parent_path()))
+    {
+        if (entry.path().filename().string().starts_with(
+                p.filename().string() + "."))
+        {
+            std::filesystem::remove(entry.path());
+        }
+    }
+}
+
+// records between poll() calls, like the drain thread's batches
+static constexpr uint32_t BATCH = 64;
+
+/** times every write, separately those that started a new file */
+template<typename SINK> void run(benchmark::State& state, SINK& sink)
+{
+    const auto now = std::chrono::system_clock::now().time_since_epoch();
+    const logging::SinkRecord rec { 12, "src/a.cpp", logging::Level::INFO,
+        MESSAGE, now };
+    std::chrono::nanoseconds worst { 0 };
+    std::chrono::nanoseconds rotating { 0 };
+    uint32_t batch = 0;
+    for (auto _ : state)
+    {
+        const auto rotations = sink.rotations();
+        const auto start = std::chrono::steady_clock::now();
+        sink.write(rec);
+        const auto took = std::chrono::steady_clock::now() - start;
+        worst = std::max(worst, took);
+        if (sink.rotations() != rotations)
+        {
+            rotating += took;
+        }
+        if (++batch == BATCH)
+        {
+            sink.poll(now);
+            batch = 0;
+        }
+    }
+    state.SetItemsProcessed(state.iterations());
+    state.counters["worst_write_us"] = worst.count() / 1000.0;
+    state.counters["rotations"] = sink.rotations();
+    state.counters["rotating_write_us"] = sink.rotations() == 0
+        ? 0.0
+        : rotating.count() / 1000.0 / sink.rotations();
+}
+
+/** rotating on the writing thread: close, delete the oldest, open */
+class InlineRotatingSink
+{
+public:
+    explicit InlineRotatingSink(const std::string& path)
+        : m_path(path)
+    {
+        open_next();
+    }
+
+    void write(const logging::SinkRecord& rec)
+    {
+        if (m_sink->bytes() >= FILE_SIZE)
+        {
+            m_sink.reset();
+            if (m_index >= RETENTION)
+            {
+                unlink(name(m_index - RETENTION).c_str());
+            }
+            m_index++;
+            m_rotations++;
+            open_next();
+        }
+        m_sink->write(rec);
+    }
+
+    void poll(std::chrono::nanoseconds now)
+    {
+        m_sink->poll(now);
+    }
+
+    uint64_t rotations() const
+    {
+        return m_rotations;
+    }
+
+private:
+    std::string name(uint32_t index) const
+    {
+        return std::format("{}.{:06}", m_path, index);
+    }
+
+    void open_next()
+    {
+        const int fd = open(name(m_index).c_str(),
+            O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+        m_sink = std::make_unique<logging::FdSink>(fd, true);
+    }
+
+    std::string m_path;
+    uint32_t m_index = 0;
+    uint64_t m_rotations = 0;
+    std::unique_ptr<logging::FdSink> m_sink;
+};
+
+void BM_RotateInline(benchmark::State& state)
+{
+    const auto path = bench_path();
+    remove_files(path);
+    {
+        InlineRotatingSink sink(path);
+        run(state, sink);
+    }
+    remove_files(path);
+}
+BENCHMARK(BM_RotateInline);
+
+void BM_RotatingFileSink(benchmark::State& state)
+{
+    const auto path = bench_path();
+    remove_files(path);
+    {
+        logging::RotatingFileConfig cfg;
+        cfg.path = path;
+        cfg.max_bytes = FILE_SIZE;
+        cfg.retention = RETENTION;
+        logging::RotatingFileSink sink(cfg);
+        run(state, sink);
+        state.counters["late_rotations"] = sink.late_rotations();
+    }
+    remove_files(path);
+}
+BENCHMARK(BM_RotatingFileSink);
+
+} // namespace
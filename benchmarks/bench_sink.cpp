@@ -0,0 +1,208 @@
+#include <benchmark/benchmark.h>
+
+#include <slogger/BinarySink.hpp>
+#include <slogger/DeferredFormat.hpp>
+#include <slogger/FdSink.hpp>
+#include <slogger/MmapSink.hpp>
+#include <slogger/ShmCollector.hpp>
+#include <slogger/ShmSink.hpp>
+#include <slogger/TimeUtils.hpp>
+#include <slogger/UringSink.hpp>
+
+#include <cstdio>
+#include <filesystem>
+#include <format>
+#include <tuple>
+#include <type_traits>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace
+{
+static constexpr std::string_view MESSAGE =
+    "received 1234 bytes from 192.168.1.1 port 5004 err=OK";
+
+/** the old DirectConsoleLogger path: std::format into a temporary string,
+ * then fprintf, to /dev/null
+ */
+void BM_FormatAndFprintf(benchmark::State& state)
+{
+    FILE* f = fopen("/dev/null", "w");
+    const auto now = std::chrono::system_clock::now().time_since_epoch();
+    for (auto _ : state)
+    {
+        auto s = std::format("{}:{}: [{}] {} - {}\n", "src/a.cpp", 12,
+            time_utils::format_time_of_day(now), "INFO", MESSAGE);
+        fprintf(f, "%s", s.c_str());
+    }
+    fclose(f);
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_FormatAndFprintf);
+
+/** FdSink to /dev/null, arg is the buffer size */
+void BM_FdSink(benchmark::State& state)
+{
+    logging::FdSinkConfig cfg;
+    cfg.buffer_size = state.range(0);
+    logging::FdSink sink(open("/dev/null", O_WRONLY), true, cfg);
+    const auto now = std::chrono::system_clock::now().time_since_epoch();
+    const logging::SinkRecord rec { 12, "src/a.cpp", logging::Level::INFO,
+        MESSAGE, now };
+    for (auto _ : state)
+    {
+        sink.write(rec);
+    }
+    sink.flush();
+    state.SetItemsProcessed(state.iterations());
+    state.counters["syscalls/record"] =
+        double(sink.syscalls()) / double(sink.records());
+}
+BENCHMARK(BM_FdSink)->Arg(0)->Arg(4096)->Arg(64 * 1024);
+
+/** BinarySink to /dev/null with the arguments captured, as the drain thread
+ * gets them in SLOGGER_DEFERRED_FORMAT builds
+ */
+void BM_BinarySink(benchmark::State& state)
+{
+    static constinit logging::LogSite site { "src/a.cpp", 12,
+        logging::Level::INFO, "received {} bytes from {} port {} err={}" };
+    const auto id = site.get_id();
+
+    const uint32_t bytes = 1234;
+    const char* from = "192.168.1.1";
+    const uint32_t port = 5004;
+    const auto err = error::Error::OK;
+    const std::tuple<const uint32_t&, const char* const&, const uint32_t&,
+        const error::Error&>
+        refs(bytes, from, port, err);
+    const auto d = logging::make_deferred_args(site.fmt, refs);
+    std::string captured(d.size, '\0');
+    d.encode(reinterpret_cast<std::byte*>(captured.data()), d.args);
+
+    logging::BinarySink sink(open("/dev/null", O_WRONLY), true);
+    const auto now = std::chrono::system_clock::now().time_since_epoch();
+    const logging::SinkRecord rec { site.line, site.file, site.level,
+        captured, now, id, true };
+    for (auto _ : state)
+    {
+        sink.write(rec);
+    }
+    sink.flush();
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_BinarySink);
+
+/** MmapSink into 64MB segments in the temp directory, arg is the msync
+ * policy
+ */
+void BM_MmapSink(benchmark::State& state)
+{
+    const auto dir = std::filesystem::temp_directory_path();
+    logging::MmapSinkConfig cfg;
+    cfg.path = (dir / "slogger_bench_mmap").string();
+    cfg.msync = static_cast<logging::MsyncPolicy>(state.range(0));
+    uint32_t segments = 0;
+    {
+        logging::MmapSink sink(cfg);
+        const auto now = std::chrono::system_clock::now().time_since_epoch();
+        const logging::SinkRecord rec { 12, "src/a.cpp", logging::Level::INFO,
+            MESSAGE, now };
+        for (auto _ : state)
+        {
+            sink.write(rec);
+        }
+        sink.flush();
+        segments = sink.segment() + 1;
+        for (uint32_t i = 0; i < segments; i++)
+        {
+            std::filesystem::remove(sink.segment_path(i));
+        }
+    }
+    state.SetItemsProcessed(state.iterations());
+    state.counters["segments"] = segments;
+}
+BENCHMARK(BM_MmapSink)
+    ->Arg(int(logging::MsyncPolicy::NONE))
+    ->Arg(int(logging::MsyncPolicy::ASYNC_ON_ROLL));
+
+/** file in the temp directory, O_DSYNC if arg is 1 to stand for a slow
+ * disk: each write() then waits for the storage
+ */
+template<typename Sink, typename Config>
+void run_file_sink(benchmark::State& state, const Config& cfg)
+{
+    const auto path =
+        (std::filesystem::temp_directory_path() / "slogger_bench_file")
+            .string();
+    const int fd = open(path.c_str(),
+        O_WRONLY | O_CREAT | O_TRUNC | (state.range(0) ? O_DSYNC : 0), 0644);
+    {
+        Sink sink(fd, true, cfg);
+        const auto now = std::chrono::system_clock::now().time_since_epoch();
+        const logging::SinkRecord rec { 12, "src/a.cpp", logging::Level::INFO,
+            MESSAGE, now };
+        for (auto _ : state)
+        {
+            sink.write(rec);
+        }
+        sink.flush();
+        if constexpr (std::is_same_v<Sink, logging::UringSink>)
+        {
+            state.counters["waits"] = sink.waits();
+        }
+    }
+    std::filesystem::remove(path);
+    state.SetItemsProcessed(state.iterations());
+}
+
+/** FdSink with 64KB batches to a file, arg 1 for O_DSYNC */
+void BM_FileFdSink(benchmark::State& state)
+{
+    run_file_sink<logging::FdSink>(state, logging::FdSinkConfig {});
+}
+BENCHMARK(BM_FileFdSink)->Arg(0)->Arg(1);
+
+/** the same with the batches submitted through io_uring */
+void BM_FileUringSink(benchmark::State& state)
+{
+    run_file_sink<logging::UringSink>(state, logging::UringSinkConfig {});
+}
+BENCHMARK(BM_FileUringSink)->Arg(0)->Arg(1);
+
+class NullSink : public logging::ISink
+{
+public:
+    void write(const logging::SinkRecord&) override {}
+};
+
+/** ShmSink publishing text records for a collector, which is not timed */
+void BM_ShmSink(benchmark::State& state)
+{
+    auto sink = std::make_unique<logging::ShmSink>("bench");
+    logging::ShmCollector collector(std::make_unique<NullSink>());
+    collector.attach("bench");
+    const auto now = std::chrono::system_clock::now().time_since_epoch();
+    const logging::SinkRecord rec { 12, "src/a.cpp", logging::Level::INFO,
+        MESSAGE, now };
+    uint32_t n = 0;
+    for (auto _ : state)
+    {
+        sink->write(rec);
+        if (++n % 4096 == 0)
+        {
+            state.PauseTiming();
+            collector.flush();
+            state.ResumeTiming();
+        }
+    }
+    state.SetItemsProcessed(state.iterations());
+    state.counters["dropped"] = sink->dropped();
+    // the collector removes the ring once it is closed
+    sink.reset();
+    collector.poll(now);
+}
+BENCHMARK(BM_ShmSink);
+
+} // namespace
@@ -0,0 +1,109 @@
+#include <benchmark/benchmark.h>
+
+#include <slogger/ClockRawTimer.hpp>
+#include <slogger/ILogger.hpp>
+#include <slogger/TimestampFormatter.hpp>
+#include <slogger/TscTimer.hpp>
+
+#include <chrono>
+#include <ctime>
+#include <format>
+#include <iterator>
+#include <string>
+
+namespace
+{
+/** timestamp capture cost of a log call */
+void BM_TscNowTicks(benchmark::State& state)
+{
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(logging::now_ticks());
+    }
+    state.counters["counter"] =
+        time_utils::TscTimer::instance().uses_counter() ? 1 : 0;
+}
+BENCHMARK(BM_TscNowTicks);
+
+void BM_ClockRawTimer(benchmark::State& state)
+{
+    time_utils::ClockRawTimer timer;
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(timer.get_time_ns());
+    }
+}
+BENCHMARK(BM_ClockRawTimer);
+
+/** what DirectConsoleLogger used to do per line */
+void BM_TimeAndStrftime(benchmark::State& state)
+{
+    char buf[128];
+    for (auto _ : state)
+    {
+        std::time_t time = std::time({});
+        std::strftime(buf, sizeof(buf), "%T", std::gmtime(&time));
+        benchmark::DoNotOptimize(buf);
+    }
+}
+BENCHMARK(BM_TimeAndStrftime);
+
+/** timestamps of 10M records, 1us apart: a new second every 1M records */
+constexpr int64_t TIMESTAMP_RECORDS = 10'000'000;
+constexpr std::chrono::nanoseconds TIMESTAMP_START =
+    std::chrono::seconds(1700000000);
+
+/** what the text sinks did per record before TimestampFormatter */
+void BM_GmtimeTimestamp(benchmark::State& state)
+{
+    std::string out;
+    auto t = TIMESTAMP_START;
+    for (auto _ : state)
+    {
+        out.clear();
+        const auto secs = std::chrono::floor<std::chrono::seconds>(t);
+        const std::time_t tt = secs.count();
+        struct tm tm;
+        gmtime_r(&tt, &tm);
+        std::format_to(std::back_inserter(out), "{:02}:{:02}:{:02}.{:09}",
+            tm.tm_hour, tm.tm_min, tm.tm_sec, (t - secs).count());
+        benchmark::DoNotOptimize(out.data());
+        t += std::chrono::microseconds(1);
+    }
+}
+BENCHMARK(BM_GmtimeTimestamp)->Iterations(TIMESTAMP_RECORDS);
+
+void BM_TimestampFormatter(benchmark::State& state)
+{
+    time_utils::TimestampFormatter formatter(
+        static_cast<time_utils::TimestampFormatter::Precision>(
+            state.range(0)));
+    std::string out;
+    auto t = TIMESTAMP_START;
+    for (auto _ : state)
+    {
+        out.clear();
+        formatter.append(out, t);
+        benchmark::DoNotOptimize(out.data());
+        t += std::chrono::microseconds(1);
+    }
+}
+BENCHMARK(BM_TimestampFormatter)->Arg(9)->Arg(6)->Iterations(
+    TIMESTAMP_RECORDS);
+
+void BM_TimestampFormatterTai(benchmark::State& state)
+{
+    time_utils::TimestampFormatter formatter;
+    std::string out;
+    auto t = time_utils::tai::nanoseconds(1700000037ULL, 0);
+    for (auto _ : state)
+    {
+        out.clear();
+        formatter.append(out, t);
+        benchmark::DoNotOptimize(out.data());
+        t = t + time_utils::tai::nanoseconds(1000ULL);
+    }
+}
+BENCHMARK(BM_TimestampFormatterTai)->Iterations(TIMESTAMP_RECORDS);
+
+} // namespace
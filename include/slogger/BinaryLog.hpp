@@ -0,0 +1,145 @@
+#pragma once
+
+/**
+ * @file BinaryLog.hpp
+ * @brief The compact binary log file format written by BinarySink, and its
+ * reader.
+ *
+ * A file starts with the 8 byte MAGIC and the writer's ByteOrder byte,
+ * followed by entries that each start with an EntryType byte. Integers are
+ * LEB128 varints. The captured arguments of ARGS entries are in the
+ * writer's byte order, so a file is only read on a host of the same order.
+ *
+ *  - DICT: key, line, level, file length + bytes, format length + bytes.
+ *    Defines what the records with that key were logged from. Keys are
+ *    numbered per file, a DICT entry precedes the first record using it.
+ *  - TEXT: key, time, length + message bytes.
+ *  - ARGS: key, time, length + arguments captured by DeferredArgs, to be
+ *    formatted with the key's format string.
+ *
+ * The time is the difference to the previous record's wall clock time in
+ * nanoseconds (the first record's is relative to 1970), zigzag encoded as
+ * merged sources are not strictly ordered.
+ */
+
+#include <bit>
+#include <chrono>
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "Error.hpp"
+#include "LogSite.hpp"
+
+
+namespace logging
+{
+namespace binary_log
+{
+    static constexpr std::string_view MAGIC { "SLOGBIN\x02", 8 };
+
+    enum class ByteOrder : uint8_t
+    {
+        LITTLE = 'L',
+        BIG = 'B'
+    };
+
+    static constexpr ByteOrder NATIVE_BYTE_ORDER =
+        std::endian::native == std::endian::big ? ByteOrder::BIG
+                                                : ByteOrder::LITTLE;
+
+    enum class EntryType : uint8_t
+    {
+        DICT = 1,
+        TEXT = 2,
+        ARGS = 3
+    };
+
+    inline void put_varint(std::string& out, uint64_t v)
+    {
+        while (v >= 0x80)
+        {
+            out += static_cast<char>((v & 0x7f) | 0x80);
+            v >>= 7;
+        }
+        out += static_cast<char>(v);
+    }
+
+    inline uint64_t zigzag(int64_t v)
+    {
+        return (static_cast<uint64_t>(v) << 1) ^ static_cast<uint64_t>(v >> 63);
+    }
+
+    inline int64_t unzigzag(uint64_t v)
+    {
+        return static_cast<int64_t>(v >> 1) ^ -static_cast<int64_t>(v & 1);
+    }
+} // namespace binary_log
+
+/** a record read back from a binary log */
+struct DecodedRecord
+{
+    uint32_t line = 0;
+    std::string file;
+    Level level = Level::DEBUG;
+
+    /** the formatted message */
+    std::string msg;
+
+    /** wall clock time since 1970 */
+    std::chrono::nanoseconds time { 0 };
+};
+
+/** Reads the records of a binary log one at a time, formatting captured
+ * arguments with the file's format strings.
+ */
+class BinaryLogReader
+{
+public:
+    explicit BinaryLogReader(std::istream& in);
+
+    /** @returns false at the end of the input, or when it is not a binary
+     * log or corrupt, see status()
+     */
+    bool next(DecodedRecord& rec);
+
+    /** OK, BAD_PPROTOCOL if the input is not a valid binary log, or RANGE
+     * if it was written on a host of the other byte order
+     */
+    error::Error status() const
+    {
+        return m_status;
+    }
+
+private:
+    struct DictEntry
+    {
+        uint32_t line = 0;
+        Level level = Level::DEBUG;
+        std::string file;
+        std::string fmt;
+    };
+
+    bool read_varint(uint64_t& v);
+    bool read_bytes(std::string& out);
+    bool read_dict();
+    bool fail();
+
+    std::istream& m_in;
+    error::Error m_status = error::Error::OK;
+    std::vector<DictEntry> m_dict;
+    int64_t m_time = 0;
+    std::string m_bytes;
+};
+
+/** converts a binary log to the text lines FdSink would have written.
+ * @returns OK, BAD_PPROTOCOL when the input is not a valid binary log, the
+ * records before the corruption are written, or RANGE when it was written on
+ * a host of the other byte order
+ */
+error::Error decode_binary_log(std::istream& in, std::ostream& out);
+
+} // namespace logging
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "BinaryLog.hpp"
+#include "FdSink.hpp"
+
+
+namespace logging
+{
+/** Writes records in the compact binary format of BinaryLog.hpp instead of
+ * text: a key per call site, the time and the message or, better, the
+ * captured arguments. No formatting happens while logging at all when the
+ * arguments are captured (SLOGGER_DEFERRED_FORMAT), slogger-decode turns
+ * the file into text later.
+ * Buffering and flushing are those of FdSink.
+ */
+class BinarySink : public FdSink
+{
+public:
+    /** @param owned close fd on destruction */
+    BinarySink(int fd, bool owned, const FdSinkConfig& cfg = {});
+
+    bool wants_args() const override
+    {
+        return true;
+    }
+
+    bool writes_text() const override
+    {
+        return false;
+    }
+
+protected:
+    void append(std::string& buf, const SinkRecord& rec) override;
+
+private:
+    /** @returns the key of rec's call site, appends its DICT entry when new
+     */
+    uint64_t key_of(std::string& buf, const SinkRecord& rec);
+
+    bool m_header_written = false;
+    int64_t m_time = 0;
+    uint64_t m_next_key = 0;
+
+    // key + 1 by site id, 0 when not in the dictionary yet
+    std::vector<uint64_t> m_site_keys;
+
+    // records not logged through a LOG_ macro, keyed by file, line, level
+    struct Location
+    {
+        const char* file;
+        uint32_t line;
+        Level level;
+
+        bool operator==(const Location&) const = default;
+    };
+    struct LocationHash
+    {
+        size_t operator()(const Location& l) const
+        {
+            return std::hash<const char*>()(l.file) ^ (l.line << 2) ^
+                static_cast<size_t>(l.level);
+        }
+    };
+    std::unordered_map<Location, uint64_t, LocationHash> m_location_keys;
+};
+
+} // namespace logging
@@ -0,0 +1,188 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <span>
+
+#include "Ring.hpp"
+
+
+/** Single-producer/single-consumer ring of variable length byte records.
+ *
+ * Records are stored contiguously (bip-buffer style): when a record does not
+ * fit in the space left before the end of the buffer, that tail is marked as
+ * padding and the record starts at offset 0 again. The producer writes in
+ * place:
+ *
+ *     if (auto* p = ring.reserve(max_len)) { fill p; ring.commit(len); }
+ *
+ * and the consumer reads in place:
+ *
+ *     auto rec = ring.peek(); if (!rec.empty()) { use rec; ring.release(); }
+ *
+ * Publication uses the same release/acquire protocol as Ring.
+ */
+template<uint32_t SIZE_BYTES = 16384>
+class ByteRing
+{
+    static_assert(SIZE_BYTES >= 64 && (SIZE_BYTES & (SIZE_BYTES - 1)) == 0,
+        "ByteRing SIZE_BYTES must be a power of two");
+
+public:
+    static constexpr uint32_t MASK = SIZE_BYTES - 1;
+    static constexpr uint32_t ALIGNMENT = 8;
+    static constexpr uint32_t HEADER_SIZE = 8;
+
+    /** largest payload a single record can hold */
+    static constexpr uint32_t MAX_RECORD_SIZE = SIZE_BYTES / 2 - HEADER_SIZE;
+
+    /** producer side: reserves len contiguous bytes.
+     * @returns nullptr when the ring has no room (or len is too large),
+     * otherwise a pointer to write the payload to; it stays private to the
+     * producer until commit()
+     */
+    std::byte* reserve(uint32_t len)
+    {
+        if (len > MAX_RECORD_SIZE)
+        {
+            return nullptr;
+        }
+        const auto wp = m_producer.pos.load(std::memory_order_relaxed);
+        const auto off = wp & MASK;
+        const auto total = record_size(len);
+        const auto tail_room = SIZE_BYTES - off;
+        const auto skip = total > tail_room ? tail_room : 0;
+
+        if (wp + skip + total - m_producer.cached_other_pos > SIZE_BYTES)
+        {
+            m_producer.cached_other_pos =
+                m_consumer.pos.load(std::memory_order_acquire);
+            if (wp + skip + total - m_producer.cached_other_pos > SIZE_BYTES)
+            {
+                return nullptr;
+            }
+        }
+
+        if (skip != 0)
+        {
+            store_header(off, PADDING);
+        }
+        m_reserved_skip = skip;
+        m_reserved_off = (wp + skip) & MASK;
+        return &m_data[m_reserved_off + HEADER_SIZE];
+    }
+
+    /** producer side: publishes the last reservation, len may be smaller
+     * than what was reserved.
+     * @returns true when the consumer had taken every record before this
+     * one, it may be waiting for a wake-up then
+     */
+    bool commit(uint32_t len)
+    {
+        store_header(m_reserved_off, len);
+        const auto wp = m_producer.pos.load(std::memory_order_relaxed);
+        m_producer.pos.store(
+            wp + m_reserved_skip + record_size(len), std::memory_order_release);
+        // after publishing, as in Ring::add()
+        if (wp != m_producer.cached_other_pos)
+        {
+            m_producer.cached_other_pos =
+                m_consumer.pos.load(std::memory_order_acquire);
+        }
+        return wp == m_producer.cached_other_pos;
+    }
+
+    /** consumer side.
+     * @returns the oldest record's payload, empty when there is none
+     */
+    std::span<const std::byte> peek()
+    {
+        auto rp = m_consumer.pos.load(std::memory_order_relaxed);
+        if (rp == m_consumer.cached_other_pos)
+        {
+            m_consumer.cached_other_pos =
+                m_producer.pos.load(std::memory_order_acquire);
+            if (rp == m_consumer.cached_other_pos)
+            {
+                return {};
+            }
+        }
+        auto off = rp & MASK;
+        auto len = load_header(off);
+        if (len == PADDING)
+        {
+            m_peeked_skip = SIZE_BYTES - off;
+            off = 0;
+            len = load_header(off);
+        }
+        else
+        {
+            m_peeked_skip = 0;
+        }
+        m_peeked_len = len;
+        return { &m_data[off + HEADER_SIZE], len };
+    }
+
+    /** consumer side: frees the record returned by the last peek() */
+    void release()
+    {
+        const auto rp = m_consumer.pos.load(std::memory_order_relaxed);
+        m_consumer.pos.store(rp + m_peeked_skip + record_size(m_peeked_len),
+            std::memory_order_release);
+    }
+
+    /** approximate when called concurrently */
+    bool empty() const
+    {
+        return m_consumer.pos.load(std::memory_order_acquire) ==
+            m_producer.pos.load(std::memory_order_acquire);
+    }
+
+    static constexpr uint32_t capacity()
+    {
+        return SIZE_BYTES;
+    }
+
+private:
+    static constexpr uint32_t PADDING = UINT32_MAX;
+
+    static constexpr uint32_t record_size(uint32_t len)
+    {
+        return (HEADER_SIZE + len + ALIGNMENT - 1) & ~(ALIGNMENT - 1);
+    }
+
+    void store_header(uint32_t off, uint32_t len)
+    {
+        std::memcpy(&m_data[off], &len, sizeof(len));
+    }
+
+    uint32_t load_header(uint32_t off) const
+    {
+        uint32_t len;
+        std::memcpy(&len, &m_data[off], sizeof(len));
+        return len;
+    }
+
+    struct alignas(RING_CACHE_LINE_SIZE) Index
+    {
+        std::atomic<uint32_t> pos { 0 };
+
+        // owned by the same side as pos, copy of the other side's pos
+        uint32_t cached_other_pos = 0;
+    };
+
+    Index m_producer;
+    Index m_consumer;
+
+    // producer private
+    alignas(RING_CACHE_LINE_SIZE) uint32_t m_reserved_off = 0;
+    uint32_t m_reserved_skip = 0;
+
+    // consumer private
+    alignas(RING_CACHE_LINE_SIZE) uint32_t m_peeked_len = 0;
+    uint32_t m_peeked_skip = 0;
+
+    alignas(RING_CACHE_LINE_SIZE) std::byte m_data[SIZE_BYTES];
+};
@@ -0,0 +1,153 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <format>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+#include "ILogger.hpp"
+#include "ISink.hpp"
+#include "TimeUtils.hpp"
+
+
+namespace logging
+{
+/** Consumer side stage that folds consecutive identical entries (same file,
+ * line, level and message) into a single "last message repeated N times"
+ * line, so a failing hot loop does not flood the output.
+ *
+ * The first entry is passed on right away, the repeats are only counted.
+ * The summary is passed on when a different entry arrives, when the repeats
+ * span more than the window, or on flush().
+ * Not thread-safe: meant for the one thread that writes the output.
+ */
+class Coalescer
+{
+public:
+    static constexpr std::chrono::seconds DEFAULT_WINDOW { 1 };
+
+    explicit Coalescer(std::chrono::nanoseconds window = DEFAULT_WINDOW)
+        : m_window(window)
+    {
+    }
+
+    /** @param write called as write(const SinkRecord&), or as
+     * write(line, file, level, msg, time), for the entries that need to be
+     * written, including summaries
+     */
+    template<typename F> void add(const SinkRecord& rec, F&& write)
+    {
+        if (repeats_last(rec))
+        {
+            if (m_repeats != 0 && rec.time - m_first_repeat >= m_window)
+            {
+                flush(write);
+            }
+            if (m_repeats++ == 0)
+            {
+                m_first_repeat = rec.time;
+            }
+            m_last_repeat = rec.time;
+            return;
+        }
+
+        flush(write);
+        emit(write, rec);
+        m_line = rec.line;
+        m_file = rec.file;
+        m_level = rec.level;
+        m_site_id = rec.site_id;
+        m_args = rec.args;
+        m_msg.assign(rec.msg);
+    }
+
+    /** @param time wall clock time the entry was logged at */
+    template<typename F>
+    void add(uint32_t line, const char* file, Level level,
+        std::string_view msg, std::chrono::nanoseconds time, F&& write)
+    {
+        add(SinkRecord { line, file, level, msg, time }, write);
+    }
+
+    template<typename F>
+    void add(const LogEntry& elt, std::chrono::nanoseconds time, F&& write)
+    {
+        add(SinkRecord { elt.line, elt.file, elt.level, elt.msg, time,
+                elt.site_id, elt.args },
+            write);
+    }
+
+    /** passes on the summary of the repeats counted so far, if any */
+    template<typename F> void flush(F&& write)
+    {
+        if (m_repeats == 0)
+        {
+            return;
+        }
+        const auto summary =
+            std::format("last message repeated {} times, first {} last {}",
+                m_repeats, time_utils::format_time_of_day(m_first_repeat),
+                time_utils::format_time_of_day(m_last_repeat));
+        m_repeats = 0;
+        emit(write,
+            SinkRecord { m_line, m_file, m_level, summary, m_last_repeat,
+                m_site_id });
+    }
+
+    /** flush() if the first uncounted repeat is older than the window, so
+     * that an idle output still gets its summary
+     */
+    template<typename F>
+    void flush_expired(std::chrono::nanoseconds now, F&& write)
+    {
+        if (m_repeats != 0 && now - m_first_repeat >= m_window)
+        {
+            flush(write);
+        }
+    }
+
+    /** number of repeats not summarized yet */
+    uint32_t pending() const
+    {
+        return m_repeats;
+    }
+
+private:
+    template<typename F> static void emit(F& write, const SinkRecord& rec)
+    {
+        if constexpr (std::is_invocable_v<F&, const SinkRecord&>)
+        {
+            write(rec);
+        }
+        else
+        {
+            write(rec.line, rec.file, rec.level, rec.msg, rec.time);
+        }
+    }
+
+    bool repeats_last(const SinkRecord& rec) const
+    {
+        return m_file != nullptr && rec.line == m_line &&
+            rec.level == m_level && rec.args == m_args && rec.msg == m_msg &&
+            (rec.file == m_file || std::strcmp(rec.file, m_file) == 0);
+    }
+
+    const std::chrono::nanoseconds m_window;
+
+    // the last entry that was passed on, m_msg keeps its capacity
+    uint32_t m_line = 0;
+    const char* m_file = nullptr;
+    Level m_level = Level::DEBUG;
+    uint32_t m_site_id = NO_LOG_SITE;
+    bool m_args = false;
+    std::string m_msg;
+
+    uint32_t m_repeats = 0;
+    std::chrono::nanoseconds m_first_repeat { 0 };
+    std::chrono::nanoseconds m_last_repeat { 0 };
+};
+
+} // namespace logging
@@ -0,0 +1,107 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "CompressedLog.hpp"
+#include "FdSink.hpp"
+
+
+namespace logging
+{
+struct CompressedFileConfig
+{
+    /** buffer_size is the size of a block before compression. Blocks are
+     * also cut by max_latency and after ERROR records, like FdSink's
+     * batches, so a long latency compresses better.
+     */
+    FdSinkConfig sink { 256 * 1024, std::chrono::seconds(1) };
+
+    /** threads compressing blocks in parallel */
+    uint32_t workers = 2;
+
+    /** blocks handed over but not written yet. When there are that many,
+     * the writing thread waits for the workers.
+     */
+    uint32_t max_pending_blocks = 8;
+};
+
+/** Writes text records as LZ compressed blocks, see CompressedLog.hpp.
+ *
+ * The writing thread only formats into the current block. A full block is
+ * handed to a small pool of worker threads that compress blocks in parallel;
+ * they are written in order by whichever worker finishes the next one. The
+ * block index is written on destruction.
+ */
+class CompressedFileSink : public FdSink
+{
+public:
+    /** @param owned close fd on destruction */
+    CompressedFileSink(
+        int fd, bool owned, const CompressedFileConfig& cfg = {});
+
+    /** writes the remaining blocks and the index */
+    ~CompressedFileSink() override;
+
+    /** number of blocks written */
+    uint64_t blocks() const;
+
+    /** bytes before and after compression, including block headers */
+    uint64_t raw_bytes() const;
+    uint64_t stored_bytes() const;
+
+    /** number of times the writing thread waited for the workers */
+    uint64_t stalls() const;
+
+protected:
+    void write_buffer(std::string& buf) override;
+
+private:
+    struct Job
+    {
+        uint64_t seq;
+        std::string raw;
+    };
+
+    struct Block
+    {
+        std::string data;
+        uint32_t raw_size;
+    };
+
+    void run();
+
+    const CompressedFileConfig m_cfg;
+
+    mutable std::mutex m_mutex;
+    std::condition_variable m_work_cond;
+    std::condition_variable m_space_cond;
+    bool m_stop = false;
+
+    std::vector<Job> m_jobs;
+    // compressed blocks waiting for their turn to be written, by seq
+    std::map<uint64_t, Block> m_done;
+    // cleared block buffers to hand out again
+    std::vector<std::string> m_free;
+    uint64_t m_next_seq = 0;
+    uint64_t m_next_write = 0;
+    uint32_t m_pending = 0;
+
+    // one worker writes at a time, it owns the members below
+    bool m_writing = false;
+    uint64_t m_offset = compressed_log::MAGIC.size();
+    std::vector<BlockIndexEntry> m_index;
+
+    uint64_t m_raw_bytes = 0;
+    uint64_t m_stored_bytes = 0;
+    uint64_t m_stalls = 0;
+
+    std::vector<std::thread> m_threads;
+};
+
+} // namespace logging
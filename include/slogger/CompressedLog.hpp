@@ -0,0 +1,119 @@
+#pragma once
+
+/**
+ * @file CompressedLog.hpp
+ * @brief The block compressed log file format written by
+ * CompressedFileSink, and its reader.
+ *
+ * A file starts with the 8 byte MAGIC, followed by blocks. A block is a
+ * header of stored size (u32), raw size (u32) and Codec (u8), followed by
+ * the stored bytes. Decompressed, the blocks are consecutive pieces of the
+ * text log, each ends at the end of a line.
+ *
+ * A closed file ends with the block index: a stored size of 0, the number
+ * of blocks (u32), per block its file offset (u64) and raw size (u32), then
+ * the offset of the index (u64) and INDEX_MAGIC. A file that was not closed
+ * properly has no index, its blocks can still be read one by one.
+ * Integers are little endian.
+ */
+
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "Error.hpp"
+
+
+namespace logging
+{
+namespace compressed_log
+{
+    static constexpr std::string_view MAGIC { "SLOGLZB1", 8 };
+    static constexpr std::string_view INDEX_MAGIC { "SLOGIDX1", 8 };
+
+    static constexpr uint32_t BLOCK_HEADER_SIZE = 4 + 4 + 1;
+
+    /** index offset + INDEX_MAGIC */
+    static constexpr uint32_t TRAILER_SIZE = 8 + 8;
+
+    enum class Codec : uint8_t
+    {
+        // did not compress, stored as is
+        STORED = 0,
+        // see Lz.hpp
+        LZ = 1
+    };
+
+    inline void put_u32(std::string& out, uint32_t v)
+    {
+        for (int i = 0; i < 4; i++)
+        {
+            out += static_cast<char>(v >> (8 * i));
+        }
+    }
+
+    inline void put_u64(std::string& out, uint64_t v)
+    {
+        for (int i = 0; i < 8; i++)
+        {
+            out += static_cast<char>(v >> (8 * i));
+        }
+    }
+
+    /** appends raw as a block, compressed if that makes it smaller */
+    void append_block(std::string& out, std::string_view raw);
+} // namespace compressed_log
+
+struct BlockIndexEntry
+{
+    /** of the block header, from the start of the file */
+    uint64_t offset;
+    uint32_t raw_size;
+};
+
+/** Reads the blocks of a compressed log front to back, without needing
+ * the index.
+ */
+class CompressedLogReader
+{
+public:
+    explicit CompressedLogReader(std::istream& in);
+
+    /** @param block the next decompressed block
+     * @returns false at the end of the blocks, or when the input is not a
+     * compressed log or corrupt, see status()
+     */
+    bool next(std::string& block);
+
+    /** OK, or BAD_PPROTOCOL if the input is not a valid compressed log */
+    error::Error status() const
+    {
+        return m_status;
+    }
+
+private:
+    bool fail();
+
+    std::istream& m_in;
+    error::Error m_status = error::Error::OK;
+    std::string m_stored;
+};
+
+/** reads the block index at the end of a seekable compressed log, for
+ * random access to its blocks.
+ * @returns OK, NOT_READY if the file was not closed properly and has no
+ * index, or BAD_PPROTOCOL if it is not a compressed log
+ */
+error::Error read_block_index(
+    std::istream& in, std::vector<BlockIndexEntry>& index);
+
+/** writes the text of a compressed log.
+ * @returns OK, or BAD_PPROTOCOL if the input is not a valid compressed log,
+ * the blocks before the corruption are written
+ */
+error::Error decode_compressed_log(std::istream& in, std::ostream& out);
+
+} // namespace logging
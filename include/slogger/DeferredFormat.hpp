@@ -0,0 +1,276 @@
+#pragma once
+
+/**
+ * @file DeferredFormat.hpp
+ * @brief Binary capture of log call arguments so that the expensive
+ * formatting can be done later by the thread that drains the log.
+ *
+ * Every captured argument is stored as an ArgTag byte followed by its value,
+ * strings are copied inline (length + bytes). format_deferred() turns the
+ * format string and the captured bytes back into the text std::format would
+ * have produced.
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <format>
+#include <span>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+
+#include "Error.hpp"
+#include "TimeUtils.hpp"
+
+
+namespace logging
+{
+/** type of a captured argument */
+enum class ArgTag : uint8_t
+{
+    BOOL,
+    CHAR,
+    INT,
+    UINT,
+    FLOAT,
+    DOUBLE,
+    STRING,
+    POINTER,
+    ERROR,
+    TAI_NANOS
+};
+
+/** more arguments than this are formatted on the caller's thread */
+static constexpr uint32_t MAX_DEFERRED_ARGS = 32;
+
+/** Everything needed to capture the arguments of a single log call, or to
+ * format them right away. Only valid for the duration of that call.
+ */
+struct DeferredArgs
+{
+    std::string_view fmt;
+
+    /** number of bytes encode() writes */
+    uint32_t size;
+
+    void (*encode)(std::byte* dst, const void* args);
+    std::string (*format)(std::string_view fmt, const void* args);
+
+    /** the call's arguments, only to be passed to encode() and format() */
+    const void* args;
+};
+
+/** formats arguments written by DeferredArgs::encode().
+ * Errors in the format string or the arguments end up in the returned text,
+ * they are not thrown.
+ */
+std::string format_deferred(
+    std::string_view fmt, std::span<const std::byte> args);
+
+
+namespace detail
+{
+    template<typename T> using arg_t = std::remove_cv_t<std::decay_t<T>>;
+
+    template<typename T>
+    static constexpr bool is_string_arg =
+        std::is_same_v<arg_t<T>, std::string> ||
+        std::is_same_v<arg_t<T>, std::string_view> ||
+        std::is_same_v<arg_t<T>, const char*> ||
+        std::is_same_v<arg_t<T>, char*>;
+
+    /** the character types other than char, which std::format with a char
+     * format string rejects and which must not be captured as integers
+     */
+    template<typename T>
+    static constexpr bool is_wide_char_arg =
+        std::is_same_v<arg_t<T>, wchar_t> ||
+        std::is_same_v<arg_t<T>, char8_t> ||
+        std::is_same_v<arg_t<T>, char16_t> ||
+        std::is_same_v<arg_t<T>, char32_t>;
+
+    template<typename T>
+    static constexpr bool is_pointer_arg =
+        std::is_same_v<arg_t<T>, const void*> ||
+        std::is_same_v<arg_t<T>, void*> ||
+        std::is_same_v<arg_t<T>, std::nullptr_t>;
+
+    template<typename T> constexpr ArgTag tag_of()
+    {
+        using U = arg_t<T>;
+        if constexpr (std::is_same_v<U, bool>)
+        {
+            return ArgTag::BOOL;
+        }
+        else if constexpr (std::is_same_v<U, char>)
+        {
+            return ArgTag::CHAR;
+        }
+        else if constexpr (is_wide_char_arg<T>)
+        {
+            static_assert(!is_wide_char_arg<T>, "not a deferrable type");
+        }
+        else if constexpr (std::is_integral_v<U> && std::is_signed_v<U>)
+        {
+            return ArgTag::INT;
+        }
+        else if constexpr (std::is_integral_v<U>)
+        {
+            return ArgTag::UINT;
+        }
+        else if constexpr (std::is_same_v<U, float>)
+        {
+            return ArgTag::FLOAT;
+        }
+        else if constexpr (std::is_same_v<U, double>)
+        {
+            return ArgTag::DOUBLE;
+        }
+        else if constexpr (is_string_arg<T>)
+        {
+            return ArgTag::STRING;
+        }
+        else if constexpr (is_pointer_arg<T>)
+        {
+            return ArgTag::POINTER;
+        }
+        else if constexpr (std::is_same_v<U, error::Error>)
+        {
+            return ArgTag::ERROR;
+        }
+        else
+        {
+            return ArgTag::TAI_NANOS;
+        }
+    }
+
+    template<typename T> std::string_view as_string(const T& v)
+    {
+        if constexpr (std::is_pointer_v<std::remove_cvref_t<T>>)
+        {
+            return v ? std::string_view(v) : std::string_view();
+        }
+        else
+        {
+            return std::string_view(v);
+        }
+    }
+
+    template<typename T> uint32_t encoded_size(const T& v)
+    {
+        constexpr auto TAG = tag_of<T>();
+        if constexpr (TAG == ArgTag::BOOL || TAG == ArgTag::CHAR)
+        {
+            return 1 + 1;
+        }
+        else if constexpr (TAG == ArgTag::FLOAT || TAG == ArgTag::ERROR)
+        {
+            return 1 + 4;
+        }
+        else if constexpr (TAG == ArgTag::STRING)
+        {
+            return 1 + 4 + static_cast<uint32_t>(as_string(v).size());
+        }
+        else
+        {
+            return 1 + 8;
+        }
+    }
+
+    template<typename V> std::byte* put(std::byte* dst, const V& v)
+    {
+        std::memcpy(dst, &v, sizeof(v));
+        return dst + sizeof(v);
+    }
+
+    template<typename T> std::byte* encode_arg(std::byte* dst, const T& v)
+    {
+        constexpr auto TAG = tag_of<T>();
+        *dst++ = static_cast<std::byte>(TAG);
+        if constexpr (TAG == ArgTag::BOOL || TAG == ArgTag::CHAR)
+        {
+            return put(dst, static_cast<uint8_t>(v));
+        }
+        else if constexpr (TAG == ArgTag::INT)
+        {
+            return put(dst, static_cast<int64_t>(v));
+        }
+        else if constexpr (TAG == ArgTag::UINT)
+        {
+            return put(dst, static_cast<uint64_t>(v));
+        }
+        else if constexpr (TAG == ArgTag::FLOAT || TAG == ArgTag::DOUBLE)
+        {
+            return put(dst, v);
+        }
+        else if constexpr (TAG == ArgTag::STRING)
+        {
+            const auto s = as_string(v);
+            dst = put(dst, static_cast<uint32_t>(s.size()));
+            std::memcpy(dst, s.data(), s.size());
+            return dst + s.size();
+        }
+        else if constexpr (TAG == ArgTag::POINTER)
+        {
+            return put(dst,
+                static_cast<uint64_t>(
+                    reinterpret_cast<uintptr_t>(static_cast<const void*>(v))));
+        }
+        else if constexpr (TAG == ArgTag::ERROR)
+        {
+            return put(dst, static_cast<uint32_t>(v));
+        }
+        else
+        {
+            return put(dst, static_cast<uint64_t>(v.count()));
+        }
+    }
+
+    template<typename... Args> void encode(std::byte* dst, const void* args)
+    {
+        std::apply([&](const auto&... a) { ((dst = encode_arg(dst, a)), ...); },
+            *static_cast<const std::tuple<const Args&...>*>(args));
+    }
+
+    template<typename... Args>
+    std::string format(std::string_view fmt, const void* args)
+    {
+        return std::apply(
+            [&](const auto&... a) {
+                return std::vformat(fmt, std::make_format_args(a...));
+            },
+            *static_cast<const std::tuple<const Args&...>*>(args));
+    }
+} // namespace detail
+
+
+/** true for the argument types that can be captured as bytes */
+template<typename T>
+static constexpr bool is_deferrable_arg =
+    (std::is_integral_v<detail::arg_t<T>> &&
+        !detail::is_wide_char_arg<T>) ||
+    std::is_same_v<detail::arg_t<T>, float> ||
+    std::is_same_v<detail::arg_t<T>, double> ||
+    detail::is_string_arg<T> || detail::is_pointer_arg<T> ||
+    std::is_same_v<detail::arg_t<T>, error::Error> ||
+    std::is_same_v<detail::arg_t<T>, time_utils::tai::nanoseconds>;
+
+template<typename... Args>
+static constexpr bool are_deferrable_args =
+    sizeof...(Args) <= MAX_DEFERRED_ARGS && (is_deferrable_arg<Args> && ...);
+
+/** @param refs the call's arguments, must outlive the returned object */
+template<typename... Args>
+DeferredArgs make_deferred_args(
+    std::string_view fmt, const std::tuple<const Args&...>& refs)
+{
+    const uint32_t size = std::apply(
+        [](const auto&... a) { return (0U + ... + detail::encoded_size(a)); },
+        refs);
+    return DeferredArgs { fmt, size, &detail::encode<Args...>,
+        &detail::format<Args...>, &refs };
+}
+
+} // namespace logging
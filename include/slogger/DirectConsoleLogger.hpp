@@ -1,39 +1,176 @@
 #pragma once
 
+#include <chrono>
 #include <cstdint>
 #include <memory>
+#include <mutex>
 #include <string>
+#include <string_view>
 #include <vector>
 
+#include "Coalescer.hpp"
+#include "DrainScheduler.hpp"
+#include "DrainThread.hpp"
+#include "ISink.hpp"
 #include "ILogger.hpp"
+#include "ITimer.hpp"
 
 
 namespace logging
 {
+static constexpr uint32_t DEFAULT_POLL_BUDGET = 64;
 
+/** poll(budget) reads the timer once per this many entries */
+static constexpr uint32_t POLL_TIME_CHECK_INTERVAL = 8;
+
+struct PollResult
+{
+    /** entries written */
+    uint32_t written = 0;
+
+    /** approximate number of entries still waiting */
+    uint32_t remaining = 0;
+};
+
+/** Writes to the console, a file or any sink, e.g. a FanOutSink.
+ * Consecutive identical messages are folded into "last message repeated N
+ * times" lines, see Coalescer.
+ * There can be any number of instances, each with its own sink, but only
+ * one at a time in LogMode::THREAD_LOCAL_BUFFERS: the thread buffers are
+ * shared by the whole process.
+ */
 class DirectConsoleLogger : public ILogger
 {
 public:
-    DirectConsoleLogger(bool debug, bool info, LogOutput output);
+    DirectConsoleLogger(bool debug, bool info, LogOutput output,
+        LogMode mode = LogMode::DIRECT);
+
+    /** writes to the given sink, e.g. a MmapSink or a FanOutSink with its
+     * sinks already added
+     */
+    DirectConsoleLogger(bool debug, bool info, std::unique_ptr<ISink> sink,
+        LogMode mode = LogMode::DIRECT);
     ~DirectConsoleLogger();
 
     void log(uint32_t line, const char* file, Level level,
         const std::string& msg) override;
 
-    /** check if some other core has something to say and print it in here
+    void log_site(LogSite& site, const std::string& msg) override;
+
+    /** captured arguments are written as they are when the sink wants them
+     * and we are writing directly, formatted otherwise
+     */
+    void log_deferred(LogSite& site, const DeferredArgs& args) override;
+
+    /** check if some other core has something to say and print it in here.
+     * In LogMode::THREAD_LOCAL_BUFFERS this also drains the buffers of all
+     * threads that logged through us.
+     * Writes at most the poll budget, see DrainScheduler for the order.
+     * Does nothing while the drain thread runs.
     */
     void poll() override;
 
-    void add(const std::shared_ptr<ILogger>& logger)
+    /** like poll(), but drains until budget is spent instead of a number
+     * of entries. The time is read every POLL_TIME_CHECK_INTERVAL entries,
+     * the call can take that many entries longer.
+     */
+    PollResult poll(std::chrono::microseconds budget);
+
+    /** the clock poll(budget) is measured with, steady clock by default.
+     * timer must outlive the logger.
+     */
+    void set_poll_timer(time_utils::ITimer& timer)
+    {
+        m_poll_timer = &timer;
+    }
+
+    /** loggers to drain, add them before starting the drain thread
+     * @param quantum entries drained from logger per round
+     */
+    void add(const std::shared_ptr<ILogger>& logger,
+        uint32_t quantum = DEFAULT_DRAIN_QUANTUM)
+    {
+        m_scheduler.add(logger, quantum);
+    }
+
+    /** writes the entries of the added loggers in time order, merging
+     * them over reorder_window, see DrainScheduler. Zero (the default)
+     * drains them by turns instead.
+     */
+    void set_time_order(std::chrono::nanoseconds reorder_window)
+    {
+        m_scheduler.set_reorder_window(reorder_window);
+    }
+
+    /** most entries a poll() writes, from all sources together */
+    void set_poll_budget(uint32_t entries)
     {
-        m_poll_loggers.push_back(logger);
+        m_poll_budget = entries;
     }
 
+    /** starts a thread that drains continuously instead of poll(), it
+     * parks when there is nothing to do.
+     * @returns OK, or why cfg's pinning/scheduling could not be applied,
+     * the thread is running either way
+     */
+    error::Error start_drain_thread(const DrainThreadConfig& cfg = {});
+
+    /** drains what is left and stops the thread, also done on destruction
+     */
+    void stop_drain_thread();
+
 private:
-    LogOutput m_output;
-    FILE* m_f = nullptr;
+    /** passes the entry through the coalescer, any thread.
+     * @param ticks LogEntry::ticks of the entry
+     * @param args LogEntry::args of the entry
+     */
+    void write(uint32_t line, const char* file, Level level,
+        std::string_view msg, uint64_t ticks, uint32_t site_id = NO_LOG_SITE,
+        bool args = false);
+
+    void write(const LogEntry& elt)
+    {
+        write(elt.line, elt.file, elt.level, elt.msg, elt.ticks, elt.site_id,
+            elt.args);
+    }
+
+
+    /** drains up to budget entries from all sources.
+     * @returns number of entries written
+     */
+    uint32_t drain(uint32_t budget);
+
+    /** like drain(budget), stops early when stop() returns true, it is
+     * called after each entry
+     */
+    template<typename S> uint32_t drain(uint32_t budget, S&& stop);
+
+    /** writes the counts of rate limited sites of ours that went quiet
+     * after refusing messages, see RateLimiter::take_suppressed()
+     */
+    void report_suppressed();
+
+    /** passes the coalescer's output on to the sink */
+    auto line_writer()
+    {
+        return [this](const SinkRecord& rec) { m_sink->write(rec); };
+    }
+
+    LogMode m_mode;
+
+    // guards the coalescer and the sink
+    std::mutex m_write_mutex;
+    Coalescer m_coalescer;
+    std::unique_ptr<ISink> m_sink;
+
+    // m_sink->wants_args()
+    bool m_sink_args = false;
+
+    DrainScheduler m_scheduler;
+    uint32_t m_poll_budget = DEFAULT_POLL_BUDGET;
+    time_utils::ITimer* m_poll_timer;
 
-    std::vector<std::shared_ptr<ILogger> > m_poll_loggers;
+    std::unique_ptr<DrainThread> m_drain_thread;
 };
 
 } // namespace logging
\ No newline at end of file
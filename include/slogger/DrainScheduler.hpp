@@ -0,0 +1,308 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <vector>
+
+#include "ILogger.hpp"
+
+
+namespace logging
+{
+/** records a source may drain per round unless given another quantum */
+static constexpr uint32_t DEFAULT_DRAIN_QUANTUM = 4;
+
+/** Decides in which order the entries of several loggers are drained.
+ *
+ * Sources take turns by deficit round-robin: each turn grants a source its
+ * quantum of entries, what it does not use is lost once it runs empty. A
+ * call stops after its budget and the next one continues with the source
+ * whose turn it was, so no source waits more than one round however busy
+ * the others are.
+ *
+ * One entry of every source is taken ahead (its head), the heads are
+ * refilled between turns. ERROR heads are written before anything else,
+ * the oldest first, so an error does not wait behind another source's
+ * flood of lower levels. Within a source entries stay in order.
+ *
+ * With a reorder window set, entries are written in time order instead:
+ * a k-way merge of the heads on a min-heap by LogEntry::ticks. An entry is
+ * written once every source has a later one at its head, or when it is
+ * older than the window. Entries reaching a source later than the window
+ * after being logged can still come out of order.
+ *
+ * Only to be used by the single draining thread.
+ */
+class DrainScheduler
+{
+public:
+    void add(const std::shared_ptr<ILogger>& logger,
+        uint32_t quantum = DEFAULT_DRAIN_QUANTUM)
+    {
+        m_sources.push_back(
+            Source { logger, quantum > 0 ? quantum : 1, 0, std::nullopt });
+    }
+
+    /** switches to time order, see above. Zero switches back to turns.
+     */
+    void set_reorder_window(std::chrono::nanoseconds window)
+    {
+        m_time_order = window.count() > 0;
+        m_window_ticks = static_cast<uint64_t>(window.count() *
+            time_utils::TscTimer::instance().ticks_per_ns());
+    }
+
+    size_t sources() const
+    {
+        return m_sources.size();
+    }
+
+    /** @returns true if logger was added */
+    bool has_source(const ILogger* logger) const
+    {
+        return std::any_of(m_sources.begin(), m_sources.end(),
+            [&](const Source& src) { return src.logger.get() == logger; });
+    }
+
+    /** approximate number of entries left, including the heads */
+    uint32_t pending() const
+    {
+        uint32_t count = 0;
+        for (const auto& src : m_sources)
+        {
+            count += (src.head ? 1 : 0) + src.logger->pending();
+        }
+        return count;
+    }
+
+    /** hands at most budget entries to write(const LogEntry&)
+     * @param unformatted take them with remove_unformatted()
+     * @returns number of entries written
+     */
+    template<typename F>
+    uint32_t drain(uint32_t budget, bool unformatted, F&& write)
+    {
+        return drain(budget, unformatted, write, [] { return false; });
+    }
+
+    /** like drain(budget, unformatted, write), stops early when stop()
+     * returns true, it is called after each entry
+     */
+    template<typename F, typename S>
+    uint32_t drain(uint32_t budget, bool unformatted, F&& write, S&& stop)
+    {
+        if (m_sources.empty())
+        {
+            return 0;
+        }
+        if (m_time_order)
+        {
+            const auto now = now_ticks();
+            return merge(budget, unformatted, write, stop,
+                now > m_window_ticks ? now - m_window_ticks : 0);
+        }
+        uint32_t count = 0;
+        uint32_t idle = 0;
+        fill_all(unformatted);
+        while (count < budget)
+        {
+            if (auto* src = oldest_error())
+            {
+                take(*src, unformatted, write);
+                count++;
+                if (stop())
+                {
+                    break;
+                }
+                continue;
+            }
+
+            auto& src = m_sources[m_turn];
+            if (!fill(src, unformatted))
+            {
+                src.deficit = 0;
+                next_turn(unformatted);
+                // every source was empty in a row
+                if (++idle == m_sources.size())
+                {
+                    break;
+                }
+                continue;
+            }
+            idle = 0;
+            if (src.deficit == 0)
+            {
+                src.deficit = src.quantum;
+            }
+            take(src, unformatted, write);
+            count++;
+            if (--src.deficit == 0)
+            {
+                next_turn(unformatted);
+            }
+            if (stop())
+            {
+                break;
+            }
+        }
+        return count;
+    }
+
+    /** writes everything, also what time order would still hold back
+     * @returns number of entries written
+     */
+    template<typename F> uint32_t flush(bool unformatted, F&& write)
+    {
+        if (!m_time_order)
+        {
+            return drain(UINT32_MAX, unformatted, write);
+        }
+        const auto never = [] { return false; };
+        return merge(UINT32_MAX, unformatted, write, never, UINT64_MAX);
+    }
+
+private:
+    struct Source
+    {
+        std::shared_ptr<ILogger> logger;
+        uint32_t quantum;
+        uint32_t deficit = 0;
+        std::optional<LogEntry> head;
+    };
+
+    /** @returns false if src has nothing to drain */
+    bool fill(Source& src, bool unformatted)
+    {
+        if (!src.head)
+        {
+            src.head = unformatted ? src.logger->remove_unformatted()
+                                   : src.logger->remove();
+            if (src.head && src.head->level == Level::ERROR)
+            {
+                m_error_heads++;
+            }
+        }
+        return src.head.has_value();
+    }
+
+    /** picks up new ERRORs, done between turns */
+    void fill_all(bool unformatted)
+    {
+        for (auto& src : m_sources)
+        {
+            fill(src, unformatted);
+        }
+    }
+
+    template<typename F> void take(Source& src, bool unformatted, F& write)
+    {
+        if (src.head->level == Level::ERROR)
+        {
+            m_error_heads--;
+        }
+        write(*src.head);
+        src.head.reset();
+        fill(src, unformatted);
+    }
+
+    Source* oldest_error()
+    {
+        if (m_error_heads == 0)
+        {
+            return nullptr;
+        }
+        Source* oldest = nullptr;
+        for (auto& src : m_sources)
+        {
+            if (src.head && src.head->level == Level::ERROR &&
+                (oldest == nullptr || src.head->ticks < oldest->head->ticks))
+            {
+                oldest = &src;
+            }
+        }
+        return oldest;
+    }
+
+    /** @param cutoff entries up to this time are written without waiting
+     * for the other sources
+     */
+    template<typename F, typename S>
+    uint32_t merge(
+        uint32_t budget, bool unformatted, F& write, S& stop, uint64_t cutoff)
+    {
+        // min-heap of the sources with a head, by the head's time
+        const auto later = [this](uint32_t a, uint32_t b) {
+            return m_sources[a].head->ticks > m_sources[b].head->ticks;
+        };
+        m_heap.clear();
+        m_empty.clear();
+        for (uint32_t i = 0; i < m_sources.size(); i++)
+        {
+            (fill(m_sources[i], unformatted) ? m_heap : m_empty).push_back(i);
+        }
+        std::make_heap(m_heap.begin(), m_heap.end(), later);
+
+        uint32_t count = 0;
+        while (count < budget && !m_heap.empty())
+        {
+            if (m_sources[m_heap.front()].head->ticks > cutoff &&
+                !m_empty.empty())
+            {
+                // recent: only safe once no source can have an older one
+                std::erase_if(m_empty, [&](uint32_t i) {
+                    if (!fill(m_sources[i], unformatted))
+                    {
+                        return false;
+                    }
+                    m_heap.push_back(i);
+                    std::push_heap(m_heap.begin(), m_heap.end(), later);
+                    return true;
+                });
+                if (!m_empty.empty())
+                {
+                    break;
+                }
+            }
+            std::pop_heap(m_heap.begin(), m_heap.end(), later);
+            const auto i = m_heap.back();
+            take(m_sources[i], unformatted, write);
+            count++;
+            if (m_sources[i].head)
+            {
+                std::push_heap(m_heap.begin(), m_heap.end(), later);
+            }
+            else
+            {
+                m_heap.pop_back();
+                m_empty.push_back(i);
+            }
+            if (stop())
+            {
+                break;
+            }
+        }
+        return count;
+    }
+
+    void next_turn(bool unformatted)
+    {
+        m_turn = (m_turn + 1) % m_sources.size();
+        fill_all(unformatted);
+    }
+
+    std::vector<Source> m_sources;
+    size_t m_turn = 0;
+    // heads that are ERRORs
+    uint32_t m_error_heads = 0;
+
+    bool m_time_order = false;
+    uint64_t m_window_ticks = 0;
+    // indices into m_sources, reused by merge()
+    std::vector<uint32_t> m_heap;
+    std::vector<uint32_t> m_empty;
+};
+
+} // namespace logging
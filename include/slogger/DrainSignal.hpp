@@ -0,0 +1,87 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+#include "Ring.hpp"
+
+
+namespace logging
+{
+/** Wakes the drain threads (see DrainThread) when they are parked.
+ *
+ * A drain thread only parks after finding every ring empty, so only the
+ * producer that adds to an empty ring calls notify(), adding behind entries
+ * the drain thread has not taken yet costs nothing. notify() is a fence
+ * plus a load of a cache line that is only written when parking, without a
+ * drain thread it is a single load.
+ * The ring tells whether it was empty after publishing the entry, so a
+ * drain thread that took the previous entry meanwhile finds the new one in
+ * its next rounds. Should it park regardless, max_park bounds the delay.
+ *
+ * There is one signal for the process because the thread buffers are
+ * shared by every DirectConsoleLogger: with several drain threads a wake-up
+ * wakes all parked ones, those with nothing to do park again.
+ */
+class DrainSignal
+{
+public:
+    static DrainSignal& instance();
+
+    /** producer side, call after adding an entry to an empty ring */
+    void notify()
+    {
+        if (m_drain_threads.load(std::memory_order_relaxed) == 0)
+        {
+            return;
+        }
+        // orders the add before the check, pairs with the fence in
+        // prepare_park()
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (m_parked.load(std::memory_order_relaxed) != 0) [[unlikely]]
+        {
+            wake();
+        }
+    }
+
+    /** consumer side, step 1: announce parking.
+     * @returns the value to pass to park()
+     */
+    uint32_t prepare_park();
+
+    /** consumer side, step 2 after checking the rings once more: sleeps
+     * until notified or for at most timeout
+     */
+    void park(uint32_t seq, std::chrono::nanoseconds timeout);
+
+    /** consumer side: step 2 when the rings turned out not to be empty */
+    void cancel_park();
+
+    /** wakes the parked drain threads, e.g. to stop one */
+    void wake();
+
+    /** called by DrainThread when it starts/stops */
+    void add_drain_thread(int delta)
+    {
+        m_drain_threads.fetch_add(delta, std::memory_order_relaxed);
+    }
+
+private:
+    DrainSignal() = default;
+
+    alignas(RING_CACHE_LINE_SIZE) std::atomic<int> m_drain_threads { 0 };
+    // number of drain threads between prepare_park() and the end of park()
+    std::atomic<int> m_parked { 0 };
+
+    // futex word, bumped on every wake()
+    std::atomic<uint32_t> m_seq { 0 };
+};
+
+/** @see DrainSignal::notify() */
+inline void notify_drain()
+{
+    DrainSignal::instance().notify();
+}
+
+} // namespace logging
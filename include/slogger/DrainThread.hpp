@@ -0,0 +1,78 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <thread>
+
+#include <sched.h>
+
+#include "DrainSignal.hpp"
+#include "Error.hpp"
+
+
+namespace logging
+{
+struct DrainThreadConfig
+{
+    /** core to pin the thread to, -1 to leave it to the scheduler */
+    int cpu = -1;
+
+    /** e.g. SCHED_FIFO, priority is that policy's priority */
+    int policy = SCHED_OTHER;
+    int priority = 0;
+
+    /** empty drain rounds before parking */
+    uint32_t spin_rounds = 1000;
+
+    /** longest park, so drain() still runs now and then, e.g. to flush
+     * repeated messages
+     */
+    std::chrono::milliseconds max_park { 100 };
+};
+
+/** Background thread that calls drain() until stopped.
+ *
+ * When drain() finds nothing it spins for a while, then parks on the
+ * DrainSignal until a producer adds an entry. Producers must call
+ * notify_drain() after adding to an empty ring for this to work.
+ */
+class DrainThread
+{
+public:
+    /** @param drain hands pending entries to the output, returns how many.
+     * Always called from the drain thread.
+     */
+    DrainThread(std::function<uint32_t()> drain, const DrainThreadConfig& cfg);
+
+    /** stops the thread after a final drain */
+    ~DrainThread();
+
+    DrainThread(const DrainThread&) = delete;
+    DrainThread& operator=(const DrainThread&) = delete;
+
+    /** @returns OK, or why pinning or the scheduling policy failed. The
+     * thread runs either way.
+     */
+    error::Error setup_error() const
+    {
+        return m_setup_error;
+    }
+
+private:
+    /** pins the calling thread and sets its scheduling policy
+     * @returns OK, or why that failed
+     */
+    error::Error apply_config();
+
+    void run();
+
+    std::function<uint32_t()> m_drain;
+    const DrainThreadConfig m_cfg;
+    error::Error m_setup_error = error::Error::OK;
+    std::atomic<bool> m_stop { false };
+    std::thread m_thread;
+};
+
+} // namespace logging
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "ISink.hpp"
+
+
+namespace logging
+{
+/** Passes records on to several sinks, each with its own lowest level,
+ * e.g. ERROR to the console, everything to a BinarySink and INFO and up to
+ * a socket through an FdSink.
+ *
+ * The level filter comes first, a record no sink wants is not formatted at
+ * all. Captured arguments are passed on as they are to the sinks that want
+ * them and formatted once for the others, and the text line is made once
+ * for all sinks that write text, see SinkRecord::text.
+ * Add the sinks before handing the fan-out to a logger.
+ */
+class FanOutSink : public ISink
+{
+public:
+    /** @param min_level records below this level do not reach sink */
+    void add(std::unique_ptr<ISink> sink, Level min_level = Level::DEBUG);
+
+    void write(const SinkRecord& rec) override;
+    void poll(std::chrono::nanoseconds now) override;
+    void flush() override;
+
+    /** true if any of the sinks wants the arguments */
+    bool wants_args() const override;
+
+    /** number of records formatted from captured arguments */
+    uint64_t formatted_args() const
+    {
+        return m_formatted_args;
+    }
+
+    /** number of text lines made */
+    uint64_t formatted_lines() const
+    {
+        return m_formatted_lines;
+    }
+
+private:
+    struct Target
+    {
+        std::unique_ptr<ISink> sink;
+        Level min_level;
+    };
+
+    std::vector<Target> m_targets;
+
+    // reused for every record
+    std::string m_msg;
+    std::string m_text;
+
+    uint64_t m_formatted_args = 0;
+    uint64_t m_formatted_lines = 0;
+};
+
+} // namespace logging
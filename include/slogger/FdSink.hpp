@@ -0,0 +1,104 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+#include "ISink.hpp"
+
+
+namespace logging
+{
+struct FdSinkConfig
+{
+    /** bytes formatted before handing them to the kernel */
+    uint32_t buffer_size = 64 * 1024;
+
+    /** longest a record may stay in the buffer, checked in poll().
+     * Zero writes every record right away.
+     */
+    std::chrono::nanoseconds max_latency = std::chrono::milliseconds(5);
+};
+
+/** Formats records as text straight into a reusable buffer and writes it
+ * to a file descriptor in batches: when the buffer is full, when the oldest
+ * record is older than max_latency, and at the first poll() after an ERROR
+ * record.
+ * Derived sinks can write another format by overriding append(), or
+ * process the batches by overriding write_buffer().
+ */
+class FdSink : public ISink
+{
+public:
+    /** @param owned close fd on destruction */
+    FdSink(int fd, bool owned, const FdSinkConfig& cfg = {});
+    ~FdSink() override;
+
+    FdSink(const FdSink&) = delete;
+    FdSink& operator=(const FdSink&) = delete;
+
+    void write(const SinkRecord& rec) override;
+    void poll(std::chrono::nanoseconds now) override;
+    void flush() override;
+
+    bool writes_text() const override
+    {
+        return true;
+    }
+
+    /** number of write() system calls made */
+    uint64_t syscalls() const
+    {
+        return m_syscalls;
+    }
+
+    /** number of records written */
+    uint64_t records() const
+    {
+        return m_records;
+    }
+
+    /** number of bytes written, including those still buffered */
+    uint64_t bytes() const
+    {
+        return m_bytes;
+    }
+
+protected:
+    int fd() const
+    {
+        return m_fd;
+    }
+
+    /** appends rec to the buffer, as a text line */
+    virtual void append(std::string& buf, const SinkRecord& rec);
+
+    /** hands the buffered records to the file, they are write()n. buf is
+     * cleared afterwards, an override may swap it for another buffer.
+     * Not called from ~FdSink(), flush() in the derived destructor.
+     */
+    virtual void write_buffer(std::string& buf);
+
+    /** writes all of data to the file, retrying on EINTR.
+     * @returns false if that failed, the rest is then dropped
+     */
+    bool write_all(std::string_view data);
+
+private:
+    int m_fd;
+    bool m_owned;
+    const FdSinkConfig m_cfg;
+
+    std::string m_buf;
+
+    // time of the oldest record in m_buf
+    std::chrono::nanoseconds m_oldest { 0 };
+    bool m_error_pending = false;
+
+    uint64_t m_syscalls = 0;
+    uint64_t m_records = 0;
+    uint64_t m_bytes = 0;
+};
+
+} // namespace logging
@@ -11,20 +11,20 @@
 #include <stdarg.h>
 #include <stdint.h>
 #include <stdio.h>
+#include <atomic>
+#include <optional>
 #include <string>
 
 #include <format>
+#include <tuple>
+
+#include "DeferredFormat.hpp"
+#include "LogSite.hpp"
+#include "RateLimit.hpp"
+#include "TscTimer.hpp"
 
 namespace logging
 {
-// Where to log to, common to impls.
-enum class Level
-{
-    DEBUG,
-    INFO,
-    ERROR
-};
-
 // Where to log to, common to impls.
 enum class LogOutput
 {
@@ -32,14 +32,42 @@ enum class LogOutput
     FILE_STREAM
 };
 
+// How log() calls reach the output.
+enum class LogMode
+{
+    // the calling thread writes the entry itself
+    DIRECT,
+    // each calling thread queues into its own buffer, poll() writes them
+    THREAD_LOCAL_BUFFERS
+};
+
 struct LogEntry
 {
     uint32_t line;
     const char* file;
     Level level;
     std::string msg;
+
+    /** NO_LOG_SITE if the entry was not logged through a LOG_ macro */
+    uint32_t site_id = NO_LOG_SITE;
+
+    /** msg holds the arguments captured for the format string of site_id
+     * (see DeferredArgs) instead of text, only from remove_unformatted()
+     */
+    bool args = false;
+
+    /** TscTimer ticks taken when the entry was logged, 0 if unknown.
+     * Converted to a time by the consumer, see TscTimer::to_wall_ns().
+     */
+    uint64_t ticks = 0;
 };
 
+/** @returns the timestamp for LogEntry::ticks */
+inline uint64_t now_ticks()
+{
+    return time_utils::TscTimer::instance().now_ticks();
+}
+
 class ILogger
 {
 public:
@@ -68,12 +96,25 @@ public:
 
     bool enable_debug() const
     {
-        return m_debug;
+        return m_debug.load(std::memory_order_relaxed);
     }
 
     bool enable_info() const
     {
-        return m_info;
+        return m_info.load(std::memory_order_relaxed);
+    }
+
+    /** may be called from any thread, sites switched with
+     * enable_log_sites()/disable_log_sites() are not affected
+     */
+    void set_debug(bool debug)
+    {
+        m_debug.store(debug, std::memory_order_relaxed);
+    }
+
+    void set_info(bool info)
+    {
+        m_info.store(info, std::memory_order_relaxed);
     }
 
     /** check if some other core/logger has something to say and print it in here
@@ -82,108 +123,262 @@ public:
 
     virtual std::optional<LogEntry> remove() { return std::nullopt; }
 
+    /** like remove(), but deferred arguments may be passed on still
+     * captured (LogEntry::args), for a sink that stores them as they are
+     */
+    virtual std::optional<LogEntry> remove_unformatted() { return remove(); }
+
+    /** approximate number of entries remove() would return, from the
+     * consumer side
+     */
+    virtual uint32_t pending() const { return 0; }
+
     virtual void log(uint32_t line, const char* file, Level level,
         const std::string& msg) = 0;
 
+    /** log from a LOG_ macro call site, file/line/level come from the site
+     */
+    virtual void log_site(LogSite& site, const std::string& msg)
+    {
+        log(site.line, site.file, site.level, msg);
+    }
+
+    /** log from a LOG_ macro call site with the arguments still unformatted.
+     * Loggers that hand entries to another thread can capture the arguments
+     * and let the draining thread format them, by default they are
+     * formatted right away.
+     */
+    virtual void log_deferred(LogSite& site, const DeferredArgs& args)
+    {
+        log_site(site, args.format(args.fmt, args.args));
+    }
+
 protected:
-    bool m_debug = true;
-    bool m_info = true;
+    std::atomic<bool> m_debug = true;
+    std::atomic<bool> m_info = true;
 };
 
-const char* strip_prefix(const char* path);
-
+/** used by the LOG_ macros: registers the site on first use and logs the
+ * formatted message.
+ */
+template<typename... Args>
+void log_at(ILogger& logger, LogSite& site, std::format_string<Args...> fmt,
+    Args&&... args)
+{
+    site.get_id();
+    logger.log_site(site, std::format(fmt, std::forward<Args>(args)...));
+}
 
-#define LOG_DEBUG(logger, ...)                                                 \
-    if (logger.enable_debug())                                                 \
-    {                                                                          \
-        logger.debug_msg(__LINE__, logging::strip_prefix(__FILE__),            \
-            std::format(__VA_ARGS__));                                         \
+/** used by the LOG_ macros in SLOGGER_DEFERRED_FORMAT builds: arguments that
+ * can be captured as bytes are passed on unformatted, other types are
+ * formatted on the caller's thread.
+ */
+template<typename... Args>
+void log_deferred_at(ILogger& logger, LogSite& site,
+    std::format_string<Args...> fmt, Args&&... args)
+{
+    site.get_id();
+    if constexpr (are_deferrable_args<Args...>)
+    {
+        const std::tuple<const std::remove_cvref_t<Args>&...> refs(args...);
+        logger.log_deferred(site, make_deferred_args(fmt.get(), refs));
     }
-
-#define LOG_INFO(logger, ...)                                                  \
-    if (logger.enable_info())                                                  \
-    {                                                                          \
-        logger.info_msg(__LINE__, logging::strip_prefix(__FILE__),             \
-            std::format(__VA_ARGS__));                                         \
+    else
+    {
+        logger.log_site(site, std::format(fmt, std::forward<Args>(args)...));
     }
+}
 
-#define LOG_INFO_ONCE(logger, ...)                                             \
-    do                                                                         \
-    {                                                                          \
-        static bool init_once;                                                 \
-        if (logger.enable_info() && !init_once)                                \
-        {                                                                      \
-            logger.info_msg(__LINE__, logging::strip_prefix(__FILE__),         \
-                std::format(__VA_ARGS__));                                     \
-            init_once = true;                                                  \
-        }                                                                      \
-    } while (0)
+/** used by the rate limited LOG_ macros before the first message that passes
+ * after some were refused. When no message follows, DirectConsoleLogger
+ * reports them once the limit allows messages again.
+ */
+inline void log_suppressed(ILogger& logger, LogSite& site, uint32_t count)
+{
+    logger.log(site.line, site.file, site.level,
+        std::format("{} messages suppressed", count));
+}
 
-#define LOG_ERROR(logger, ...)                                                 \
-    logger.error_msg(                                                          \
-        __LINE__, logging::strip_prefix(__FILE__), std::format(__VA_ARGS__))
+#ifdef SLOGGER_DEFERRED_FORMAT
+#define SLOGGER_LOG_AT logging::log_deferred_at
+#else
+#define SLOGGER_LOG_AT logging::log_at
+#endif
 
-#define LOG_ERROR_ONCE(logger, ...)                                            \
+#define SLOGGER_FIRST(first, ...) first
+
+/** defines the call site's LogSite named slogger_site, constant initialized
+ * so there is no runtime cost besides registering it on first use.
+ */
+#define SLOGGER_SITE(level, ...)                                               \
+    static constinit logging::LogSite slogger_site {                           \
+        logging::strip_prefix(__FILE__), __LINE__, logging::Level::level,      \
+        SLOGGER_FIRST(__VA_ARGS__) }
+
+/** the site's runtime switch, enable is only evaluated when the site is not
+ * switched on or off explicitly.
+ */
+#define SLOGGER_ENABLED(enable) slogger_site.enabled([&] { return (enable); })
+
+#define SLOGGER_EMIT(logger, level, enable, ...)                               \
     do                                                                         \
     {                                                                          \
-        static bool init_once;                                                 \
-        if (!init_once)                                                        \
+        SLOGGER_SITE(level, __VA_ARGS__);                                      \
+        if (SLOGGER_ENABLED(enable)) [[unlikely]]                              \
         {                                                                      \
-            logger.error_msg(__LINE__, logging::strip_prefix(__FILE__),        \
-                std::format(__VA_ARGS__));                                     \
-            init_once = true;                                                  \
+            SLOGGER_LOG_AT(logger, slogger_site, __VA_ARGS__);                 \
         }                                                                      \
     } while (0)
 
-#define LOG_ERROR_SLOW(logger, ...)                                            \
+
+/** like SLOGGER_EMIT, at most per_second messages with bursts of burst */
+#define SLOGGER_EMIT_RATE(logger, level, per_second, burst, ...)               \
     do                                                                         \
     {                                                                          \
-        static uint32_t counter;                                               \
-        if (counter++ > 1000)                                                  \
+        SLOGGER_SITE(level, __VA_ARGS__);                                      \
+        static constinit logging::RateLimiter slogger_limiter { per_second,    \
+            burst };                                                           \
+        uint32_t slogger_suppressed = 0;                                       \
+        if (SLOGGER_ENABLED(true))                                             \
         {                                                                      \
-            logger.error_msg(__LINE__, logging::strip_prefix(__FILE__),        \
-                std::format(__VA_ARGS__));                                     \
-            counter = 0;                                                       \
+            if (slogger_limiter.allow(                                         \
+                    logging::rate_limit_timer(), slogger_suppressed))          \
+            {                                                                  \
+                if (slogger_suppressed != 0)                                   \
+                {                                                              \
+                    logging::log_suppressed(                                   \
+                        logger, slogger_site, slogger_suppressed);             \
+                }                                                              \
+                SLOGGER_LOG_AT(logger, slogger_site, __VA_ARGS__);             \
+            }                                                                  \
+            else                                                               \
+            {                                                                  \
+                slogger_limiter.track(slogger_site, logger);                   \
+            }                                                                  \
         }                                                                      \
     } while (0)
 
 
-#define LOG_INFO_SLOW(logger, ...)                                            \
+/** values for SLOGGER_MIN_LEVEL */
+#define SLOGGER_LEVEL_DEBUG 0
+#define SLOGGER_LEVEL_INFO 1
+#define SLOGGER_LEVEL_ERROR 2
+#define SLOGGER_LEVEL_NONE 3
+
+/** LOG_ macros below this level expand to nothing at all: no enable check,
+ * no LogSite and no formatting code in the binary.
+ */
+#ifndef SLOGGER_MIN_LEVEL
+#define SLOGGER_MIN_LEVEL SLOGGER_LEVEL_DEBUG
+#endif
+
+/** a compiled out LOG_ macro. The call sits in a discarded statement so the
+ * format string and the arguments are still checked by the compiler but
+ * nothing is evaluated, the arguments must not have side effects anyway.
+ */
+#define SLOGGER_DISCARD(logger, ...)                                           \
     do                                                                         \
     {                                                                          \
-        static uint32_t counter;                                               \
-        if (counter++ > 1000)                                                  \
+        if constexpr (false)                                                   \
         {                                                                      \
-            logger.info_msg(__LINE__, logging::strip_prefix(__FILE__),        \
-                std::format(__VA_ARGS__));                                     \
-            counter = 0;                                                       \
+            (void)(logger).enable_info();                                      \
+            (void)std::format(__VA_ARGS__);                                    \
         }                                                                      \
     } while (0)
 
 
-#define LOG_INFO_VERY_SLOW(logger, ...)                                            \
+#if SLOGGER_MIN_LEVEL <= SLOGGER_LEVEL_DEBUG
+
+#define LOG_DEBUG(logger, ...)                                                 \
+    SLOGGER_EMIT(logger, DEBUG, logger.enable_debug(), __VA_ARGS__)
+
+#else
+
+#define LOG_DEBUG(logger, ...) SLOGGER_DISCARD(logger, __VA_ARGS__)
+
+#endif
+
+#if SLOGGER_MIN_LEVEL <= SLOGGER_LEVEL_INFO
+
+#define LOG_INFO(logger, ...)                                                  \
+    SLOGGER_EMIT(logger, INFO, logger.enable_info(), __VA_ARGS__)
+
+#define LOG_INFO_ONCE(logger, ...)                                             \
     do                                                                         \
     {                                                                          \
-        static uint32_t counter;                                               \
-        if (counter++ > 10000)                                                  \
+        SLOGGER_SITE(INFO, __VA_ARGS__);                                       \
+        static bool init_once;                                                 \
+        if (!init_once && SLOGGER_ENABLED(logger.enable_info()))               \
         {                                                                      \
-            logger.info_msg(__LINE__, logging::strip_prefix(__FILE__),        \
-                std::format(__VA_ARGS__));                                     \
-            counter = 0;                                                       \
+            SLOGGER_LOG_AT(logger, slogger_site, __VA_ARGS__);                 \
+            init_once = true;                                                  \
         }                                                                      \
     } while (0)
 
+/** at most per_second messages from this call site with bursts of burst,
+ * the number of refused messages is logged when they are allowed again
+ */
+#define LOG_INFO_RATE(logger, per_second, burst, ...)                          \
+    SLOGGER_EMIT_RATE(logger, INFO, per_second, burst, __VA_ARGS__)
+
+#define LOG_INFO_SLOW(logger, ...)                                             \
+    SLOGGER_EMIT_RATE(logger, INFO, logging::SLOW_LOG_PER_SECOND,              \
+        logging::SLOW_LOG_BURST, __VA_ARGS__)
+
+#define LOG_INFO_VERY_SLOW(logger, ...)                                        \
+    SLOGGER_EMIT_RATE(logger, INFO, logging::VERY_SLOW_LOG_PER_SECOND,         \
+        logging::VERY_SLOW_LOG_BURST, __VA_ARGS__)
+
+#else
+
+#define LOG_INFO(logger, ...) SLOGGER_DISCARD(logger, __VA_ARGS__)
+#define LOG_INFO_ONCE(logger, ...) SLOGGER_DISCARD(logger, __VA_ARGS__)
+#define LOG_INFO_RATE(logger, per_second, burst, ...)                          \
+    SLOGGER_DISCARD(logger, __VA_ARGS__)
+#define LOG_INFO_SLOW(logger, ...) SLOGGER_DISCARD(logger, __VA_ARGS__)
+#define LOG_INFO_VERY_SLOW(logger, ...) SLOGGER_DISCARD(logger, __VA_ARGS__)
+
+#endif
+
+#if SLOGGER_MIN_LEVEL <= SLOGGER_LEVEL_ERROR
+
+#define LOG_ERROR(logger, ...) SLOGGER_EMIT(logger, ERROR, true, __VA_ARGS__)
 
-#define LOG_ERROR_VERY_SLOW(logger, ...)                                            \
+#define LOG_ERROR_ONCE(logger, ...)                                            \
     do                                                                         \
     {                                                                          \
-        static uint32_t counter;                                               \
-        if (counter++ > 10000)                                                  \
+        SLOGGER_SITE(ERROR, __VA_ARGS__);                                      \
+        static bool init_once;                                                 \
+        if (!init_once && SLOGGER_ENABLED(true))                               \
         {                                                                      \
-            logger.error_msg(__LINE__, logging::strip_prefix(__FILE__),        \
-                std::format(__VA_ARGS__));                                     \
-            counter = 0;                                                       \
+            SLOGGER_LOG_AT(logger, slogger_site, __VA_ARGS__);                 \
+            init_once = true;                                                  \
         }                                                                      \
     } while (0)
 
+/** at most per_second messages from this call site with bursts of burst,
+ * the number of refused messages is logged when they are allowed again
+ */
+#define LOG_ERROR_RATE(logger, per_second, burst, ...)                         \
+    SLOGGER_EMIT_RATE(logger, ERROR, per_second, burst, __VA_ARGS__)
+
+#define LOG_ERROR_SLOW(logger, ...)                                            \
+    SLOGGER_EMIT_RATE(logger, ERROR, logging::SLOW_LOG_PER_SECOND,             \
+        logging::SLOW_LOG_BURST, __VA_ARGS__)
+
+#define LOG_ERROR_VERY_SLOW(logger, ...)                                       \
+    SLOGGER_EMIT_RATE(logger, ERROR, logging::VERY_SLOW_LOG_PER_SECOND,        \
+        logging::VERY_SLOW_LOG_BURST, __VA_ARGS__)
+
+#else
+
+#define LOG_ERROR(logger, ...) SLOGGER_DISCARD(logger, __VA_ARGS__)
+#define LOG_ERROR_ONCE(logger, ...) SLOGGER_DISCARD(logger, __VA_ARGS__)
+#define LOG_ERROR_RATE(logger, per_second, burst, ...)                         \
+    SLOGGER_DISCARD(logger, __VA_ARGS__)
+#define LOG_ERROR_SLOW(logger, ...) SLOGGER_DISCARD(logger, __VA_ARGS__)
+#define LOG_ERROR_VERY_SLOW(logger, ...) SLOGGER_DISCARD(logger, __VA_ARGS__)
+
+#endif
+
 } // namespace logging
\ No newline at end of file
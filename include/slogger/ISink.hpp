@@ -0,0 +1,93 @@
+#pragma once
+
+/**
+ * @file ISink.hpp
+ * @brief Destination of the records a logger writes out.
+ */
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+#include "LogSite.hpp"
+
+
+namespace logging
+{
+/** one record on its way to a sink, only valid during the write() call */
+struct SinkRecord
+{
+    uint32_t line;
+    const char* file;
+    Level level;
+    std::string_view msg;
+
+    /** wall clock time since 1970 */
+    std::chrono::nanoseconds time;
+
+    uint32_t site_id = NO_LOG_SITE;
+
+    /** msg holds the arguments captured for the format string of site_id
+     * (see DeferredArgs), only passed to sinks whose wants_args() is true
+     */
+    bool args = false;
+
+    /** the record as append_text_line() makes it, when a FanOutSink has
+     * already formatted it for another sink
+     */
+    std::string_view text = {};
+};
+
+/** Sinks are only called by the one thread writing the output (or with
+ * the logger's write lock held), they need no locking of their own.
+ */
+class ISink
+{
+public:
+    virtual ~ISink() = default;
+
+    virtual void write(const SinkRecord& rec) = 0;
+
+    /** called after every batch of writes and when idle, e.g. to flush
+     * buffered records that are getting old
+     * @param now wall clock time since 1970
+     */
+    virtual void poll(std::chrono::nanoseconds /*now*/) {}
+
+    /** hands everything buffered to the OS */
+    virtual void flush() {}
+
+    /** true if the sink stores captured arguments as they are, they are
+     * formatted before reaching the other sinks
+     */
+    virtual bool wants_args() const
+    {
+        return false;
+    }
+
+    /** true if the sink writes records with append_text_line(), it then
+     * gets SinkRecord::text when that is at hand
+     */
+    virtual bool writes_text() const
+    {
+        return false;
+    }
+};
+
+/** @returns "DEBUG", "INFO" or "ERROR" */
+const char* level_name(Level level);
+
+/** appends rec as "file:line: [HH:MM:SS.nnnnnnnnn] LEVEL - msg\n", or
+ * rec.text when that is set
+ */
+void append_text_line(std::string& out, const SinkRecord& rec);
+
+/** finds the lowest and highest numbered files "<path>.NNNNNN" of an earlier
+ * run, as RotatingFileSink and MmapSink name them
+ * @returns false if there are none
+ */
+bool find_numbered_files(
+    const std::string& path, uint32_t& lowest, uint32_t& highest);
+
+} // namespace logging
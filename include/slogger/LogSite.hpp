@@ -0,0 +1,143 @@
+#pragma once
+
+/**
+ * @file LogSite.hpp
+ * @brief Per call site metadata of the LOG_ macros.
+ *
+ * Every LOG_ macro expansion owns a statically initialized LogSite holding
+ * the (stripped) file, line, level and format string. On first use the site
+ * is registered and gets a 32 bit id, after that log records only need to
+ * carry the id: the consumer looks the metadata up with find_log_site().
+ *
+ * Sites can be switched on or off at runtime, by file or file:line pattern,
+ * with enable_log_sites()/disable_log_sites(). A site that is not switched
+ * follows its logger's enable_debug()/enable_info().
+ */
+
+#include <atomic>
+#include <cstdint>
+#include <string_view>
+
+
+namespace logging
+{
+// Where to log to, common to impls.
+enum class Level
+{
+    DEBUG,
+    INFO,
+    ERROR
+};
+
+/** id of a site that has not been registered yet */
+static constexpr uint32_t UNREGISTERED_LOG_SITE = UINT32_MAX;
+
+/** id of an entry that does not come from a registered site, also given to
+ * sites when the registry is full
+ */
+static constexpr uint32_t NO_LOG_SITE = UINT32_MAX - 1;
+
+/** the registry holds at most this many sites */
+static constexpr uint32_t MAX_LOG_SITES = 64 * 1024;
+
+/** @returns path starting at its "src/" or "include/" part, if any */
+constexpr const char* strip_prefix(const char* path)
+{
+    const std::string_view p(path);
+    if (const auto pos = p.find("src/"); pos != std::string_view::npos)
+    {
+        return path + pos;
+    }
+    if (const auto pos = p.find("include/"); pos != std::string_view::npos)
+    {
+        return path + pos;
+    }
+    return path;
+}
+
+struct LogSite;
+
+/** thread-safe, a site is only ever registered once.
+ * @returns the site's id, NO_LOG_SITE if the registry is full
+ */
+uint32_t register_log_site(LogSite& site);
+
+/** lock-free.
+ * @returns the site registered under id, nullptr if there is none
+ */
+const LogSite* find_log_site(uint32_t id);
+
+/** @returns number of registered sites, ids are 0 .. count - 1 */
+uint32_t count_log_sites();
+
+/** runtime switch of a single site */
+enum class SiteState : uint8_t
+{
+    // not registered yet, the first check registers the site
+    UNREGISTERED,
+    // follows the logger's enable_debug()/enable_info()
+    DEFAULT,
+    ENABLED,
+    DISABLED
+};
+
+/** Switches all sites matching pattern, including sites that register
+ * later on. The pattern is matched against the site's file, or against
+ * "file:line" if the pattern contains a ':'. '*' matches any sequence of
+ * characters (including '/'), '?' matches a single one,
+ * e.g. "*rtp*.cpp" or "src/Logger.cpp:90".
+ * Later calls take precedence over earlier ones.
+ * @returns number of registered sites that matched
+ */
+uint32_t enable_log_sites(std::string_view pattern);
+uint32_t disable_log_sites(std::string_view pattern);
+
+/** forgets all patterns, every site follows its logger again */
+void reset_log_sites();
+
+/** @returns true if pattern matches the site, see enable_log_sites() */
+bool log_site_matches(std::string_view pattern, const LogSite& site);
+
+
+struct LogSite
+{
+    const char* file;
+    uint32_t line;
+    Level level;
+    std::string_view fmt;
+
+    std::atomic<uint32_t> id { UNREGISTERED_LOG_SITE };
+    std::atomic<SiteState> state { SiteState::UNREGISTERED };
+
+    /** @returns the site's id, registers the site on first use */
+    uint32_t get_id()
+    {
+        const auto v = id.load(std::memory_order_acquire);
+        if (v != UNREGISTERED_LOG_SITE) [[likely]]
+        {
+            return v;
+        }
+        return register_log_site(*this);
+    }
+
+    /** the LOG_ macros' check, a relaxed load once the site is registered.
+     * @param by_default called for sites that are not switched, returns
+     * whether the logger has the site's level enabled
+     */
+    template<typename F> bool enabled(F&& by_default)
+    {
+        auto s = state.load(std::memory_order_relaxed);
+        if (s == SiteState::UNREGISTERED) [[unlikely]]
+        {
+            register_log_site(*this);
+            s = state.load(std::memory_order_relaxed);
+        }
+        if (s == SiteState::DEFAULT) [[likely]]
+        {
+            return by_default();
+        }
+        return s == SiteState::ENABLED;
+    }
+};
+
+} // namespace logging
@@ -0,0 +1,47 @@
+#pragma once
+
+/**
+ * @file Lz.hpp
+ * @brief Small LZ77 block codec for log text, in the spirit of LZ4: fast
+ * rather than tight, no entropy coding and no dependencies.
+ *
+ * A block is a sequence of (literals, match) pairs, each starting with a
+ * token byte: the high nibble is the number of literals, the low nibble the
+ * match length minus MIN_MATCH. A nibble of 15 is followed by bytes adding
+ * to it, 255 meaning another byte follows. Then come the literals, then the
+ * match offset as 2 bytes little endian. The last pair of a block may stop
+ * after its literals.
+ */
+
+#include <cstddef>
+#include <cstdint>
+
+
+namespace logging
+{
+namespace lz
+{
+    static constexpr size_t MIN_MATCH = 4;
+
+    /** matches reach at most this far back */
+    static constexpr size_t MAX_OFFSET = 65535;
+
+    /** @returns the size compress() needs for the output in the worst case,
+     * when nothing matches
+     */
+    constexpr size_t max_compressed_size(size_t size)
+    {
+        return size + size / 255 + 16;
+    }
+
+    /** @param dst at least max_compressed_size(size) bytes
+     * @returns the number of bytes written to dst
+     */
+    size_t compress(const char* src, size_t size, char* dst);
+
+    /** @param size the exact decompressed size
+     * @returns false if src is corrupt or does not decompress to size bytes
+     */
+    bool decompress(const char* src, size_t src_size, char* dst, size_t size);
+} // namespace lz
+} // namespace logging
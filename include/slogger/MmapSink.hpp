@@ -0,0 +1,131 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+#include "Error.hpp"
+#include "ISink.hpp"
+
+
+namespace logging
+{
+/** when MmapSink asks the kernel to write the mapping back */
+enum class MsyncPolicy
+{
+    // leave it to the kernel's writeback
+    NONE,
+    // MS_ASYNC when a segment is full
+    ASYNC_ON_ROLL,
+    // MS_ASYNC of the new data on every poll() and flush()
+    ASYNC_ON_FLUSH,
+    // MS_SYNC when a segment is full, the drain thread waits for the disk
+    SYNC_ON_ROLL
+};
+
+struct MmapSinkConfig
+{
+    /** segments are named "<path>.000000", "<path>.000001", ...; a restart
+     * continues after the highest existing number
+     */
+    std::string path;
+
+    /** preallocated size of each segment */
+    uint64_t segment_size = 64 * 1024 * 1024;
+
+    MsyncPolicy msync = MsyncPolicy::ASYNC_ON_ROLL;
+
+    /** MADV_SEQUENTIAL on the mapping, and MADV_DONTNEED once a segment is
+     * done so its pages do not linger in our address space
+     */
+    bool madvise = true;
+};
+
+/** Writes text records into fallocate()d, mmap()ed file segments: a
+ * record is formatted once and copied into the mapping, there is no system
+ * call per record. A full segment is truncated to its used size and the
+ * next one is mapped.
+ * A segment that cannot be created (e.g. the disk is full) is removed again
+ * and retried by poll() every OPEN_RETRY_INTERVAL, records are dropped in
+ * the meantime.
+ */
+class MmapSink : public ISink
+{
+public:
+    static constexpr auto OPEN_RETRY_INTERVAL = std::chrono::seconds(1);
+
+    explicit MmapSink(const MmapSinkConfig& cfg);
+    ~MmapSink() override;
+
+    MmapSink(const MmapSink&) = delete;
+    MmapSink& operator=(const MmapSink&) = delete;
+
+    void write(const SinkRecord& rec) override;
+    void flush() override;
+    void poll(std::chrono::nanoseconds now) override;
+
+    bool writes_text() const override
+    {
+        return true;
+    }
+
+    /** OK, or why the current segment could not be created. Records are
+     * dropped until poll() manages to create it.
+     */
+    error::Error status() const
+    {
+        return m_status;
+    }
+
+    /** @returns name of segment index */
+    std::string segment_path(uint32_t index) const;
+
+    /** index of the segment being written */
+    uint32_t segment() const
+    {
+        return m_segment;
+    }
+
+    /** records dropped because no segment was mapped, or because they are
+     * larger than a segment
+     */
+    uint64_t dropped() const
+    {
+        return m_dropped;
+    }
+
+    /** bytes of the current segment handed to msync() */
+    uint64_t synced() const
+    {
+        return m_synced;
+    }
+
+private:
+    void open_segment();
+    void close_segment();
+
+    /** MS_ASYNC of what was written since the last call, if the policy is
+     * ASYNC_ON_FLUSH
+     */
+    void sync_written();
+
+    const MmapSinkConfig m_cfg;
+    error::Error m_status = error::Error::OK;
+
+    uint32_t m_segment = 0;
+    uint64_t m_dropped = 0;
+
+    // poll() time of the next attempt to create m_segment
+    std::chrono::nanoseconds m_retry_at { 0 };
+    int m_fd = -1;
+    char* m_map = nullptr;
+    uint64_t m_pos = 0;
+
+    // m_map up to here was handed to msync()
+    uint64_t m_synced = 0;
+
+    // formatting buffer, reused
+    std::string m_line;
+};
+
+} // namespace logging
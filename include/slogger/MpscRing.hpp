@@ -0,0 +1,135 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <optional>
+#include <utility>
+
+#include "Ring.hpp"
+
+
+/** Bounded multi-producer/single-consumer queue.
+ *
+ * Any number of threads may call add(), exactly one thread may call
+ * remove(). Every slot carries a sequence number telling whose turn it is:
+ * seq == pos means free for the producer claiming pos, seq == pos + 1 means
+ * filled for the consumer. Producers claim a position with a CAS on the
+ * shared write index, the consumer owns the read index and never retries.
+ *
+ * Same interface as Ring so either can back a Hard_RT_ThreadedLogger.
+ */
+template<typename T, uint32_t SIZE = 128>
+class MpscRing
+{
+    static_assert(SIZE >= 2 && (SIZE & (SIZE - 1)) == 0,
+        "MpscRing SIZE must be a power of two");
+
+public:
+    static constexpr uint32_t MASK = SIZE - 1;
+
+    MpscRing()
+    {
+        for (uint32_t i = 0; i < SIZE; i++)
+        {
+            m_ring[i].seq.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    /** consumer side.
+     * @returns the oldest published element or nullopt when the ring is
+     * empty or the next slot is claimed but still being written.
+     */
+    std::optional<T> remove()
+    {
+        const auto rp = m_read_pos.load(std::memory_order_relaxed);
+        auto& cell = m_ring[rp & MASK];
+        if (cell.seq.load(std::memory_order_acquire) != rp + 1)
+        {
+            return std::nullopt;
+        }
+        std::optional<T> elt(std::move(cell.data));
+        cell.seq.store(rp + SIZE, std::memory_order_release);
+        m_read_pos.store(rp + 1, std::memory_order_relaxed);
+        return elt;
+    }
+
+    /** producer side, callable from any thread.
+     * @returns false if the ring is full, the element is then dropped.
+     */
+    bool add(const T& elt)
+    {
+        bool was_empty;
+        return add(elt, was_empty);
+    }
+
+    /** producer side, like add(elt).
+     * @param was_empty set when the consumer had taken every element before
+     * this one, it may be waiting for a wake-up then. With an earlier slot
+     * still being written that slot's producer gets it instead.
+     */
+    bool add(const T& elt, bool& was_empty)
+    {
+        auto wp = m_write_pos.load(std::memory_order_relaxed);
+        Cell* cell;
+        for (;;)
+        {
+            cell = &m_ring[wp & MASK];
+            const auto seq = cell->seq.load(std::memory_order_acquire);
+            const auto diff = static_cast<int32_t>(seq - wp);
+            if (diff == 0)
+            {
+                if (m_write_pos.compare_exchange_weak(
+                        wp, wp + 1, std::memory_order_relaxed))
+                {
+                    break;
+                }
+            }
+            else if (diff < 0)
+            {
+                // slot still holds an element from the previous lap
+                return false;
+            }
+            else
+            {
+                wp = m_write_pos.load(std::memory_order_relaxed);
+            }
+        }
+        cell->data = elt;
+        cell->seq.store(wp + 1, std::memory_order_release);
+        was_empty = m_read_pos.load(std::memory_order_acquire) == wp;
+        return true;
+    }
+
+    /** approximate when called concurrently with add()/remove() */
+    bool empty() const
+    {
+        return size() == 0;
+    }
+
+    /** approximate when called concurrently with add()/remove(), includes
+     * claimed slots that are not published yet.
+     */
+    uint32_t size() const
+    {
+        const auto rp = m_read_pos.load(std::memory_order_acquire);
+        const auto wp = m_write_pos.load(std::memory_order_acquire);
+        return wp - rp;
+    }
+
+    static constexpr uint32_t capacity()
+    {
+        return SIZE;
+    }
+
+private:
+    struct Cell
+    {
+        std::atomic<uint32_t> seq;
+        T data {};
+    };
+
+    alignas(RING_CACHE_LINE_SIZE) std::atomic<uint32_t> m_write_pos { 0 };
+    alignas(RING_CACHE_LINE_SIZE) std::atomic<uint32_t> m_read_pos { 0 };
+
+    alignas(RING_CACHE_LINE_SIZE) Cell m_ring[SIZE];
+};
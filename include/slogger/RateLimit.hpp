@@ -0,0 +1,145 @@
+#pragma once
+
+/**
+ * @file RateLimit.hpp
+ * @brief Per call site rate limiting of the LOG_*_RATE and *_SLOW macros.
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+
+#include "ITimer.hpp"
+
+
+namespace logging
+{
+class ILogger;
+struct LogSite;
+
+/** rate of LOG_INFO_SLOW / LOG_ERROR_SLOW */
+static constexpr uint32_t SLOW_LOG_PER_SECOND = 10;
+static constexpr uint32_t SLOW_LOG_BURST = 50;
+
+/** rate of LOG_INFO_VERY_SLOW / LOG_ERROR_VERY_SLOW */
+static constexpr uint32_t VERY_SLOW_LOG_PER_SECOND = 1;
+static constexpr uint32_t VERY_SLOW_LOG_BURST = 5;
+
+/** timer the rate limited LOG_ macros use, a steady clock by default */
+time_utils::ITimer& rate_limit_timer();
+
+/** timer must outlive all logging, e.g. a mock in tests */
+void set_rate_limit_timer(time_utils::ITimer& timer);
+
+
+/** Lock-free token bucket: allows burst messages at once, refilled at
+ * per_second. Kept as a single "theoretical arrival time" so that taking a
+ * token is one CAS, messages that are refused are counted so the next one
+ * that passes can report them.
+ *
+ * A site that goes quiet after a flood would never report them, so the
+ * first refusal also puts the limiter on a list (see
+ * tracked_rate_limiters()) from which the consumer takes the count with
+ * take_suppressed() once the bucket has a token again.
+ */
+class RateLimiter
+{
+public:
+    constexpr RateLimiter(uint32_t per_second, uint32_t burst)
+        : m_interval_ns(NANOS_PER_SEC / std::max<uint32_t>(per_second, 1))
+        , m_burst_ns((std::max<uint32_t>(burst, 1) - 1) * m_interval_ns)
+    {
+    }
+
+    /** may be called from any thread.
+     * @param suppressed when a message is allowed: number of messages
+     * refused since the previous one that was allowed
+     * @returns true if the message may be logged
+     */
+    bool allow(const time_utils::ITimer& timer, uint32_t& suppressed)
+    {
+        const int64_t now = timer.get_time_ns().count();
+        auto tat = m_tat.load(std::memory_order_relaxed);
+        do
+        {
+            if (now < tat - m_burst_ns)
+            {
+                m_suppressed.fetch_add(1, std::memory_order_relaxed);
+                return false;
+            }
+        } while (!m_tat.compare_exchange_weak(tat,
+            std::max(tat, now) + m_interval_ns, std::memory_order_relaxed));
+
+        suppressed = m_suppressed.exchange(0, std::memory_order_relaxed);
+        return true;
+    }
+
+    /** called after allow() refused a message logged at site to logger,
+     * lists the limiter for the consumer on the first call
+     */
+    void track(const LogSite& site, const ILogger& logger)
+    {
+        if (!m_tracked.load(std::memory_order_relaxed)) [[unlikely]]
+        {
+            track_slow(site, logger);
+        }
+    }
+
+    /** consumer side, races with allow() are fine: each refused message is
+     * reported by one of them.
+     * @param now_ns time of the rate_limit_timer()
+     * @returns number of messages refused, 0 while still refusing
+     */
+    uint32_t take_suppressed(int64_t now_ns)
+    {
+        if (m_suppressed.load(std::memory_order_relaxed) == 0 ||
+            now_ns < m_tat.load(std::memory_order_relaxed) - m_burst_ns)
+        {
+            return 0;
+        }
+        return m_suppressed.exchange(0, std::memory_order_relaxed);
+    }
+
+    /** set by track() */
+    const LogSite* site() const
+    {
+        return m_site;
+    }
+
+    /** set by track(), only to be compared, the logger may be gone */
+    const ILogger* logger() const
+    {
+        return m_logger;
+    }
+
+    /** next on the list of tracked_rate_limiters() */
+    RateLimiter* next() const
+    {
+        return m_next;
+    }
+
+private:
+    void track_slow(const LogSite& site, const ILogger& logger);
+
+    static constexpr int64_t NANOS_PER_SEC = 1000000000;
+
+    const int64_t m_interval_ns;
+    const int64_t m_burst_ns;
+
+    // time at which the bucket is full again
+    std::atomic<int64_t> m_tat { 0 };
+    std::atomic<uint32_t> m_suppressed { 0 };
+
+    // written once before the limiter is published on the list
+    std::atomic<bool> m_tracked { false };
+    const LogSite* m_site = nullptr;
+    const ILogger* m_logger = nullptr;
+    RateLimiter* m_next = nullptr;
+};
+
+/** @returns the limiters that refused a message so far, linked by next().
+ * The list only grows, limiters are static.
+ */
+RateLimiter* tracked_rate_limiters();
+
+} // namespace logging
@@ -0,0 +1,225 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <optional>
+#include <string_view>
+
+#include "ByteRing.hpp"
+#include "ILogger.hpp"
+
+
+namespace logging
+{
+/** SPSC ring of serialized log records: a small header followed by the
+ * payload inline, written in place into a ByteRing.
+ * Unlike Ring<LogEntry> adding does not allocate and short messages only
+ * take the space they need. Capacity is in bytes.
+ *
+ * Records from a registered LOG_ macro site only carry the site id, the
+ * file, line, level and format string are looked up when removing. The
+ * payload is either the formatted message or the captured arguments, the
+ * latter are formatted by remove().
+ */
+template<uint32_t SIZE_BYTES = 16384>
+class LogRecordRing
+{
+public:
+    /** producer side, messages too large for one record are truncated.
+     * @returns false when the ring is full, the record is then dropped
+     */
+    bool add(uint32_t line, const char* file, Level level,
+        std::string_view msg, uint64_t ticks = now_ticks())
+    {
+        const TextHeader text { file, line, level };
+        return add_text(
+            RecordHeader { ticks, NO_LOG_SITE, Payload::TEXT_WITH_HEADER },
+            &text, sizeof(text), msg);
+    }
+
+    bool add(const LogEntry& elt)
+    {
+        return add(elt.line, elt.file, elt.level, elt.msg,
+            elt.ticks != 0 ? elt.ticks : now_ticks());
+    }
+
+    /** producer side, messages too large for one record are truncated.
+     * @returns false when the ring is full, the record is then dropped
+     */
+    bool add(LogSite& site, std::string_view msg)
+    {
+        const auto ticks = now_ticks();
+        const auto id = site.get_id();
+        if (id == NO_LOG_SITE)
+        {
+            return add(site.line, site.file, site.level, msg, ticks);
+        }
+        return add_text(
+            RecordHeader { ticks, id, Payload::TEXT }, nullptr, 0, msg);
+    }
+
+    /** producer side: captures the arguments, formatting happens in
+     * remove(). Arguments too large for one record are formatted now.
+     * @returns false when the ring is full, the record is then dropped
+     */
+    bool add(LogSite& site, const DeferredArgs& args)
+    {
+        const auto ticks = now_ticks();
+        const auto id = site.get_id();
+        if (id == NO_LOG_SITE ||
+            HEADER_SIZE + args.size > ByteRing<SIZE_BYTES>::MAX_RECORD_SIZE)
+        {
+            return add(site, args.format(args.fmt, args.args));
+        }
+        auto* p = m_ring.reserve(HEADER_SIZE + args.size);
+        if (p == nullptr)
+        {
+            return false;
+        }
+        const RecordHeader hdr { ticks, id, Payload::ARGS };
+        std::memcpy(p, &hdr, HEADER_SIZE);
+        args.encode(p + HEADER_SIZE, args.args);
+        m_was_empty = m_ring.commit(HEADER_SIZE + args.size);
+        return true;
+    }
+
+    /** producer side, like the add() overloads above.
+     * @param was_empty set when the consumer had taken every record before
+     * this one, it may be waiting for a wake-up then
+     */
+    bool add(uint32_t line, const char* file, Level level,
+        std::string_view msg, bool& was_empty)
+    {
+        const bool ok = add(line, file, level, msg);
+        was_empty = m_was_empty;
+        return ok;
+    }
+
+    bool add(const LogEntry& elt, bool& was_empty)
+    {
+        const bool ok = add(elt);
+        was_empty = m_was_empty;
+        return ok;
+    }
+
+    bool add(LogSite& site, std::string_view msg, bool& was_empty)
+    {
+        const bool ok = add(site, msg);
+        was_empty = m_was_empty;
+        return ok;
+    }
+
+    bool add(LogSite& site, const DeferredArgs& args, bool& was_empty)
+    {
+        const bool ok = add(site, args);
+        was_empty = m_was_empty;
+        return ok;
+    }
+
+    /** consumer side
+     * @param format_args false leaves captured arguments unformatted,
+     * LogEntry::args is then set
+     */
+    std::optional<LogEntry> remove(bool format_args = true)
+    {
+        const auto rec = m_ring.peek();
+        if (rec.empty())
+        {
+            return std::nullopt;
+        }
+        RecordHeader hdr;
+        std::memcpy(&hdr, rec.data(), HEADER_SIZE);
+        auto payload = rec.subspan(HEADER_SIZE);
+
+        std::optional<LogEntry> elt;
+        if (hdr.payload == Payload::TEXT_WITH_HEADER)
+        {
+            TextHeader text;
+            std::memcpy(&text, payload.data(), sizeof(text));
+            elt.emplace(LogEntry { text.line, text.file, text.level,
+                to_string(payload.subspan(sizeof(text))), NO_LOG_SITE, false,
+                hdr.ticks });
+        }
+        else if (const auto* site = find_log_site(hdr.site_id))
+        {
+            const bool args = hdr.payload == Payload::ARGS;
+            elt.emplace(LogEntry { site->line, site->file, site->level,
+                args && format_args ? format_deferred(site->fmt, payload)
+                                    : to_string(payload),
+                hdr.site_id, args && !format_args, hdr.ticks });
+        }
+        else
+        {
+            elt.emplace(LogEntry { 0, "<unknown log site>", Level::ERROR,
+                std::string(), hdr.site_id, false, hdr.ticks });
+        }
+        m_ring.release();
+        return elt;
+    }
+
+    /** approximate when called concurrently */
+    bool empty() const
+    {
+        return m_ring.empty();
+    }
+
+private:
+    enum class Payload : uint8_t
+    {
+        // formatted message
+        TEXT,
+        // captured arguments for the site's format string
+        ARGS,
+        // TextHeader followed by the formatted message, no site
+        TEXT_WITH_HEADER
+    };
+
+    struct RecordHeader
+    {
+        uint64_t ticks;
+        uint32_t site_id;
+        Payload payload;
+    };
+    static constexpr uint32_t HEADER_SIZE = sizeof(RecordHeader);
+
+    struct TextHeader
+    {
+        const char* file;
+        uint32_t line;
+        Level level;
+    };
+
+    static std::string to_string(std::span<const std::byte> bytes)
+    {
+        return std::string(
+            reinterpret_cast<const char*>(bytes.data()), bytes.size());
+    }
+
+    bool add_text(const RecordHeader& hdr, const void* extra,
+        uint32_t extra_size, std::string_view msg)
+    {
+        const auto len = std::min<size_t>(msg.size(),
+            ByteRing<SIZE_BYTES>::MAX_RECORD_SIZE - HEADER_SIZE - extra_size);
+        auto* p = m_ring.reserve(HEADER_SIZE + extra_size + len);
+        if (p == nullptr)
+        {
+            return false;
+        }
+        std::memcpy(p, &hdr, HEADER_SIZE);
+        if (extra_size != 0)
+        {
+            std::memcpy(p + HEADER_SIZE, extra, extra_size);
+        }
+        std::memcpy(p + HEADER_SIZE + extra_size, msg.data(), len);
+        m_was_empty = m_ring.commit(HEADER_SIZE + extra_size + len);
+        return true;
+    }
+
+    ByteRing<SIZE_BYTES> m_ring;
+
+    // producer private, what the last commit() returned
+    bool m_was_empty = false;
+};
+
+} // namespace logging
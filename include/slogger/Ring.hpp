@@ -1,36 +1,129 @@
 #pragma once
 
-#include <optional>
 #include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <utility>
+
+
+/** size of a cache line, used to keep the producer and consumer indices
+ * from false sharing.
+ */
+static constexpr std::size_t RING_CACHE_LINE_SIZE = 64;
 
 
+/** Bounded single-producer/single-consumer queue.
+ *
+ * Exactly one thread may call add() and exactly one (other) thread may call
+ * remove(). An element is stored before its index is published with a
+ * release store, the opposite side picks it up with an acquire load, so the
+ * consumer never sees a half written element.
+ * Each side keeps a cached copy of the other side's index so that the shared
+ * cache line is only touched when the ring looks full (producer) or empty
+ * (consumer).
+ */
 template<typename T, uint32_t SIZE = 128>
 class Ring
 {
+    static_assert(SIZE >= 2 && (SIZE & (SIZE - 1)) == 0,
+        "Ring SIZE must be a power of two");
+
 public:
+    static constexpr uint32_t MASK = SIZE - 1;
+
+    /** consumer side.
+     * @returns the oldest element or nullopt when the ring is empty
+     */
     std::optional<T> remove()
     {
-        if (read_pos == write_pos)
+        const auto rp = m_consumer.pos.load(std::memory_order_relaxed);
+        if (rp == m_consumer.cached_other_pos)
         {
-            return std::nullopt;
+            m_consumer.cached_other_pos =
+                m_producer.pos.load(std::memory_order_acquire);
+            if (rp == m_consumer.cached_other_pos)
+            {
+                return std::nullopt;
+            }
         }
-        const auto rp = read_pos;
-        T elt = m_ring[rp];
-        read_pos = (rp + 1) % SIZE;
+        std::optional<T> elt(std::move(m_ring[rp & MASK]));
+        m_consumer.pos.store(rp + 1, std::memory_order_release);
         return elt;
     }
 
-    void add(const T& elt)
+    /** producer side.
+     * @returns false if the ring is full, the element is then dropped: a
+     * realtime producer must never wait for the consumer.
+     */
+    bool add(const T& elt)
+    {
+        bool was_empty;
+        return add(elt, was_empty);
+    }
+
+    /** producer side, like add(elt).
+     * @param was_empty set when the consumer had taken every element before
+     * this one, it may be waiting for a wake-up then
+     */
+    bool add(const T& elt, bool& was_empty)
     {
-        // don't care if we overwrite sth, log should fill slowly
-        const auto wp = write_pos;
-        write_pos = (wp + 1) % SIZE;
-        m_ring[write_pos] = elt;
+        const auto wp = m_producer.pos.load(std::memory_order_relaxed);
+        if (wp - m_producer.cached_other_pos == SIZE)
+        {
+            m_producer.cached_other_pos =
+                m_consumer.pos.load(std::memory_order_acquire);
+            if (wp - m_producer.cached_other_pos == SIZE)
+            {
+                return false;
+            }
+        }
+        m_ring[wp & MASK] = elt;
+        m_producer.pos.store(wp + 1, std::memory_order_release);
+        // after publishing: a consumer that takes the previous element
+        // afterwards sees this one too
+        if (wp != m_producer.cached_other_pos)
+        {
+            m_producer.cached_other_pos =
+                m_consumer.pos.load(std::memory_order_acquire);
+        }
+        was_empty = wp == m_producer.cached_other_pos;
+        return true;
+    }
+
+    /** approximate when called concurrently with add()/remove() */
+    bool empty() const
+    {
+        return size() == 0;
+    }
+
+    /** approximate when called concurrently with add()/remove() */
+    uint32_t size() const
+    {
+        const auto rp = m_consumer.pos.load(std::memory_order_acquire);
+        const auto wp = m_producer.pos.load(std::memory_order_acquire);
+        return wp - rp;
+    }
+
+    static constexpr uint32_t capacity()
+    {
+        return SIZE;
     }
 
 private:
-    uint32_t read_pos = 0;
-    uint32_t write_pos = 0;
-    T m_ring[SIZE];
-};
+    /** indices run freely and are masked on access, unsigned wrap around
+     * keeps (write - read) correct.
+     */
+    struct alignas(RING_CACHE_LINE_SIZE) Index
+    {
+        std::atomic<uint32_t> pos { 0 };
 
+        // owned by the same side as pos, copy of the other side's pos
+        uint32_t cached_other_pos = 0;
+    };
+
+    Index m_producer;
+    Index m_consumer;
+
+    alignas(RING_CACHE_LINE_SIZE) T m_ring[SIZE] {};
+};
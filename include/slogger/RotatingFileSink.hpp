@@ -0,0 +1,153 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Error.hpp"
+#include "FdSink.hpp"
+
+
+namespace logging
+{
+struct RotatingFileConfig
+{
+    /** files are named "<path>.000000", "<path>.000001", ...; a restart
+     * continues after the highest existing number that is not empty
+     */
+    std::string path;
+
+    /** start a new file once the current one has this many bytes, 0 for no
+     * size limit
+     */
+    uint64_t max_bytes = 0;
+
+    /** start a new file at every multiple of interval since 1970, e.g.
+     * every hour on the hour, 0 for no time limit
+     */
+    std::chrono::nanoseconds interval { 0 };
+
+    /** number of files kept, older ones are deleted. 0 keeps all. */
+    uint32_t retention = 0;
+
+    /** buffering of each file */
+    FdSinkConfig sink;
+};
+
+/** File sink that starts a new file by size and/or by time.
+ *
+ * The writing thread never waits for the file system's metadata: a helper
+ * thread opens the next file and creates its sink ahead of time, and closes
+ * the previous one and deletes files beyond the retention count after a
+ * rotation. Rotating is then swapping two pointers; the helper is woken by
+ * the next poll(), after the batch. Should the next file not be ready yet,
+ * writing continues in the current one and rotating is retried.
+ *
+ * The files are written by FdSink, or by what the factory creates, e.g. a
+ * BinarySink per file.
+ */
+class RotatingFileSink : public ISink
+{
+public:
+    /** makes the sink writing a file, it owns fd. Called by the helper
+     * thread too.
+     */
+    using Factory =
+        std::function<std::unique_ptr<FdSink>(int fd, const FdSinkConfig& cfg)>;
+
+    /** opens the first file right away, see status() */
+    explicit RotatingFileSink(
+        const RotatingFileConfig& cfg, Factory factory = {});
+    ~RotatingFileSink() override;
+
+    RotatingFileSink(const RotatingFileSink&) = delete;
+    RotatingFileSink& operator=(const RotatingFileSink&) = delete;
+
+    void write(const SinkRecord& rec) override;
+    void poll(std::chrono::nanoseconds now) override;
+    void flush() override;
+    bool wants_args() const override;
+    bool writes_text() const override;
+
+    /** OK, or why the last file could not be opened. Records are dropped
+     * while there is no file at all.
+     */
+    error::Error status() const;
+
+    /** @returns name of file number index */
+    std::string file_path(uint32_t index) const;
+
+    /** number of the file being written */
+    uint32_t file_index() const
+    {
+        return m_index;
+    }
+
+    /** true once the helper has opened the next file */
+    bool next_file_ready() const;
+
+    /** number of new files started */
+    uint64_t rotations() const
+    {
+        return m_rotations;
+    }
+
+    /** number of times a rotation was due but the next file was not ready
+     */
+    uint64_t late_rotations() const
+    {
+        return m_late_rotations;
+    }
+
+private:
+    /** @returns true if rec should go into a new file */
+    bool rotation_due(const SinkRecord& rec) const;
+    void rotate(std::chrono::nanoseconds now);
+    void schedule_rotation(std::chrono::nanoseconds now);
+    void wake_helper();
+
+    /** helper thread: opens, closes and deletes files */
+    void run();
+
+    /** @returns fd, or -1 and sets m_status */
+    int open_file(uint32_t index);
+
+    const RotatingFileConfig m_cfg;
+    const Factory m_factory;
+
+    // only used by the writing thread
+    std::unique_ptr<FdSink> m_current;
+    std::chrono::nanoseconds m_next_rotation { 0 };
+    uint64_t m_rotations = 0;
+    uint64_t m_late_rotations = 0;
+    bool m_wake_helper = false;
+
+    // written by the writing thread with m_mutex held
+    uint32_t m_index = 0;
+
+    // guards the hand over between the writing thread and the helper
+    mutable std::mutex m_mutex;
+    std::condition_variable m_cond;
+    bool m_stop = false;
+    error::Error m_status = error::Error::OK;
+
+    // made by the helper for file m_index + 1
+    std::unique_ptr<FdSink> m_next;
+    bool m_open_failed = false;
+
+    // files to close by the helper
+    std::vector<std::unique_ptr<FdSink>> m_retired;
+
+    // lowest numbered file not deleted yet, helper only
+    uint32_t m_oldest = 0;
+
+    std::thread m_thread;
+};
+
+} // namespace logging
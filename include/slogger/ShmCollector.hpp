@@ -0,0 +1,145 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include <sys/types.h>
+
+#include "Error.hpp"
+#include "ISink.hpp"
+#include "ShmLog.hpp"
+
+
+namespace logging
+{
+struct ShmCollectorConfig
+{
+    /** records are held back this long, waiting for older ones from rings
+     * that have nothing to read at the moment
+     */
+    std::chrono::nanoseconds reorder_window = std::chrono::milliseconds(100);
+
+    /** a ring that is not closed is taken for abandoned, read and removed,
+     * when its producer did not poll() it for this long
+     */
+    std::chrono::nanoseconds producer_timeout = shm_log::PRODUCER_TIMEOUT;
+};
+
+/** Reads the shared memory rings of ShmSinks in other processes, merges
+ * their records by time and writes them to one sink. Captured arguments
+ * are formatted here. This is what slogger-collector runs.
+ *
+ * Each ring is in time order, so a record is written once every ring has
+ * a later one pending, or when it is older than the reorder window.
+ * Rings are removed once their process closed them, or stopped polling
+ * them for producer_timeout, and everything was read. A ring recreated
+ * under the same name meanwhile is left alone.
+ */
+class ShmCollector
+{
+public:
+    explicit ShmCollector(
+        std::unique_ptr<ISink> sink, const ShmCollectorConfig& cfg = {});
+
+    /** writes what is still pending */
+    ~ShmCollector();
+
+    ShmCollector(const ShmCollector&) = delete;
+    ShmCollector& operator=(const ShmCollector&) = delete;
+
+    /** attaches the ring "/slogger.<name>".
+     * @returns NOT_READY if its producer is still setting it up
+     */
+    error::Error attach(const std::string& name);
+
+    /** attaches all rings in /dev/shm not attached yet
+     * @returns number of rings attached
+     */
+    uint32_t attach_all();
+
+    /** reads all rings and writes the records that are due, in time order
+     * @param now wall clock time since 1970
+     * @returns number of records written
+     */
+    uint32_t poll(std::chrono::nanoseconds now);
+
+    /** writes every pending record, in time order */
+    void flush();
+
+    /** number of rings attached */
+    size_t rings() const
+    {
+        return m_sources.size();
+    }
+
+    /** number of records written */
+    uint64_t records() const
+    {
+        return m_records;
+    }
+
+    /** records the producers dropped because their ring was full */
+    uint64_t dropped() const;
+
+private:
+    struct Site
+    {
+        uint32_t line;
+        Level level;
+        std::string file;
+        std::string fmt;
+    };
+
+    struct Pending
+    {
+        std::chrono::nanoseconds time;
+        uint32_t line;
+        Level level;
+        const char* file;
+        std::string msg;
+    };
+
+    struct Source
+    {
+        std::string name;
+        shm_log::Region* region;
+        // identity of the object attached, the name may be reused
+        dev_t dev;
+        ino_t ino;
+
+        std::unordered_map<uint32_t, Site> sites;
+        // files of records not logged through a LOG_ site
+        std::unordered_set<std::string> files;
+
+        std::deque<Pending> pending;
+    };
+
+    /** moves everything published in src's ring to src.pending */
+    void read(Source& src);
+
+    /** writes records due at now, all of them if now is zero
+     * @returns number written
+     */
+    uint32_t merge(std::chrono::nanoseconds now);
+
+    /** unmaps src's ring, and removes it unless the name now belongs to a
+     * new one
+     */
+    void detach(Source& src);
+
+    std::unique_ptr<ISink> m_sink;
+    const ShmCollectorConfig m_cfg;
+
+    std::vector<std::unique_ptr<Source>> m_sources;
+    uint64_t m_records = 0;
+    // dropped by rings already detached
+    uint64_t m_dropped = 0;
+};
+
+} // namespace logging
@@ -0,0 +1,110 @@
+#pragma once
+
+/**
+ * @file ShmLog.hpp
+ * @brief Layout of the shared memory rings ShmSink publishes records into
+ * and slogger-collector reads from.
+ *
+ * A ring is a POSIX shared memory object named "/slogger.<name>", i.e.
+ * the file /dev/shm/slogger.<name>, holding a Region: a small header and a
+ * ByteRing. The writing process is the ring's only producer and the
+ * collector its only consumer, records are published with ByteRing's
+ * release/acquire protocol, which works across processes as the atomics
+ * are lock-free.
+ *
+ * Each ring record starts with a RecordHeader, followed by:
+ *  - SITE: the file, then the format string of the LOG_ site site_id.
+ *    Sent before the first record of that site.
+ *  - TEXT: the file when site_id is NO_LOG_SITE, then the message.
+ *  - ARGS: the arguments captured by DeferredArgs, formatted by the
+ *    collector with the site's format string.
+ */
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+#include "ByteRing.hpp"
+#include "LogSite.hpp"
+
+
+namespace logging
+{
+namespace shm_log
+{
+    static constexpr std::string_view MAGIC { "SLOGSHM2", 8 };
+
+    /** prefix of the shared memory object names */
+    static constexpr std::string_view PREFIX = "slogger.";
+
+    /** where shm_open() objects show up as files */
+    static constexpr std::string_view SHM_DIR = "/dev/shm";
+
+    static constexpr uint32_t RING_SIZE = 1024 * 1024;
+
+    /** a ring that is not closed belongs to a live producer as long as its
+     * heartbeat is not older than this
+     */
+    static constexpr std::chrono::nanoseconds PRODUCER_TIMEOUT =
+        std::chrono::seconds(30);
+
+    using RecordRing = ByteRing<RING_SIZE>;
+
+    enum class Kind : uint8_t
+    {
+        SITE = 1,
+        TEXT = 2,
+        ARGS = 3
+    };
+
+    struct RecordHeader
+    {
+        // wall clock time since 1970
+        int64_t time;
+        uint32_t site_id;
+        uint32_t line;
+        Level level;
+        uint16_t file_len;
+        Kind kind;
+    };
+
+    struct Header
+    {
+        char magic[8];
+        uint32_t ring_size;
+        int32_t pid;
+
+        // records dropped by the producer because the ring was full
+        std::atomic<uint64_t> dropped { 0 };
+
+        // wall clock time (ns since 1970) of the producer's last poll(),
+        // the collector takes a ring that is not kept alive for gone
+        std::atomic<int64_t> heartbeat { 0 };
+
+        // set by the producer when it is done, the collector then removes
+        // the ring once it has read everything
+        std::atomic<bool> closed { false };
+
+        // set last by the producer, after everything else is initialized
+        std::atomic<bool> ready { false };
+    };
+
+    struct Region
+    {
+        Header header;
+        RecordRing ring;
+    };
+
+    /** @returns the shm_open() name of the ring called name */
+    inline std::string object_name(std::string_view name)
+    {
+        return std::string("/") + std::string(PREFIX) + std::string(name);
+    }
+
+    /** "<program>.<pid>", unique per running process */
+    std::string default_name();
+} // namespace shm_log
+
+} // namespace logging
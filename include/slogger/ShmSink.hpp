@@ -0,0 +1,84 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "Error.hpp"
+#include "ISink.hpp"
+#include "ShmLog.hpp"
+
+
+namespace logging
+{
+/** Publishes records into a shared memory ring (see ShmLog.hpp) for
+ * slogger-collector, which formats and writes them: this process does no
+ * formatting and no file I/O for its log. Captured arguments are passed on
+ * as they are, call sites are described once per ring.
+ *
+ * Like the in-process rings it never waits: when the collector falls
+ * behind and the ring is full, records are dropped and counted.
+ */
+class ShmSink : public ISink
+{
+public:
+    /** creates the ring "/slogger.<name>". A ring left under that name is
+     * replaced when it was closed or its heartbeat is older than
+     * producer_timeout, otherwise it belongs to a live producer: it is kept
+     * and status() is BUSY.
+     * @param name e.g. shm_log::default_name()
+     */
+    explicit ShmSink(const std::string& name = shm_log::default_name(),
+        std::chrono::nanoseconds producer_timeout = shm_log::PRODUCER_TIMEOUT);
+
+    /** marks the ring closed, the collector removes it once drained */
+    ~ShmSink() override;
+
+    ShmSink(const ShmSink&) = delete;
+    ShmSink& operator=(const ShmSink&) = delete;
+
+    void write(const SinkRecord& rec) override;
+
+    /** keeps the ring alive, see ShmCollectorConfig::producer_timeout */
+    void poll(std::chrono::nanoseconds now) override;
+
+    bool wants_args() const override
+    {
+        return true;
+    }
+
+    bool writes_text() const override
+    {
+        return false;
+    }
+
+    /** OK, or why the ring could not be created, BUSY if a live producer
+     * uses the name. Records are then dropped.
+     */
+    error::Error status() const
+    {
+        return m_status;
+    }
+
+    /** number of records dropped because the ring was full */
+    uint64_t dropped() const;
+
+private:
+    /** @returns false when the ring is full */
+    bool publish(const shm_log::RecordHeader& hdr, std::string_view first,
+        std::string_view second);
+
+    /** sends site_id's SITE record unless done already
+     * @returns false if it could not be sent
+     */
+    bool describe_site(uint32_t site_id);
+
+    error::Error m_status = error::Error::OK;
+    shm_log::Region* m_region = nullptr;
+
+    // true for the site ids already described to the collector
+    std::vector<bool> m_sites_sent;
+};
+
+} // namespace logging
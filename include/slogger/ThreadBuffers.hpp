@@ -0,0 +1,125 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+#include "ILogger.hpp"
+#include "Ring.hpp"
+
+
+namespace logging
+{
+static constexpr uint32_t THREAD_BUFFER_SIZE = 256;
+
+/** SPSC buffer owned by one logging thread, drained by the polling thread.
+ */
+struct ThreadBuffer
+{
+    Ring<LogEntry, THREAD_BUFFER_SIZE> ring;
+
+    /** set by the owning thread when it exits, after its last add() */
+    std::atomic<bool> thread_exited { false };
+
+    /** only written before publication or by the draining thread */
+    ThreadBuffer* next = nullptr;
+};
+
+/** Lock-free registry of the per thread log buffers.
+ *
+ * A thread's first local_buffer() call allocates its buffer and pushes it
+ * at the head of an intrusive list with a CAS. Only the single draining
+ * thread walks the list and unlinks buffers, it frees a buffer once its
+ * thread has exited and everything in it has been drained.
+ */
+class ThreadBufferRegistry
+{
+public:
+    /** lives until the process exits, it is never destroyed */
+    static ThreadBufferRegistry& instance();
+
+    /** @returns the calling thread's buffer, created on first use */
+    ThreadBuffer& local_buffer();
+
+    /** consumer side: hands at most max entries to f, visiting the buffers
+     * one after another. Buffers of exited threads are reclaimed once empty.
+     * @returns the number of entries passed to f
+     */
+    template<typename F> uint32_t drain(uint32_t max, F&& f)
+    {
+        return drain(max, f, [] { return false; });
+    }
+
+    /** like drain(max, f), stops early when stop() returns true, it is
+     * called after each entry
+     */
+    template<typename F, typename S>
+    uint32_t drain(uint32_t max, F&& f, S&& stop)
+    {
+        uint32_t count = 0;
+        bool stopped = false;
+        ThreadBuffer* prev = nullptr;
+        ThreadBuffer* buf = m_head.load(std::memory_order_acquire);
+        while (buf != nullptr && !stopped)
+        {
+            // read the flag first: entries added before the exit are then
+            // guaranteed to be visible to the emptiness check below
+            const bool exited =
+                buf->thread_exited.load(std::memory_order_acquire);
+
+            while (count < max)
+            {
+                auto elt = buf->ring.remove();
+                if (!elt)
+                {
+                    break;
+                }
+                f(*elt);
+                count++;
+                if (stop())
+                {
+                    stopped = true;
+                    break;
+                }
+            }
+
+            ThreadBuffer* next = buf->next;
+            if (exited && buf->ring.empty() && unlink(prev, buf))
+            {
+                delete buf;
+            }
+            else
+            {
+                prev = buf;
+            }
+            buf = next;
+        }
+        return count;
+    }
+
+    /** approximate number of entries in all buffers, call from the
+     * draining thread
+     */
+    uint32_t pending() const
+    {
+        uint32_t count = 0;
+        for (auto* buf = m_head.load(std::memory_order_acquire);
+             buf != nullptr; buf = buf->next)
+        {
+            count += buf->ring.size();
+        }
+        return count;
+    }
+
+    /** number of buffers currently registered, call from the draining thread
+     */
+    uint32_t count_buffers() const;
+
+private:
+    ThreadBufferRegistry() = default;
+
+    bool unlink(ThreadBuffer* prev, ThreadBuffer* buf);
+
+    std::atomic<ThreadBuffer*> m_head { nullptr };
+};
+
+} // namespace logging
@@ -1,9 +1,17 @@
 #pragma once
 
+#include <array>
+#include <atomic>
+#include <cstddef>
 #include <cstdint>
+#include <optional>
+#include <span>
 #include <string>
 
+#include "DrainSignal.hpp"
 #include "ILogger.hpp"
+#include "MpscRing.hpp"
+#include "RecordRing.hpp"
 #include "Ring.hpp"
 
 
@@ -11,24 +19,211 @@ namespace logging
 {
 /** one thread can log while another can pull log entries from the log
  * This way we can delay log from a realtime task and print them in a soft-rt task.
+ * When the ring is full new entries are dropped, the logging thread never
+ * blocks.
+ *
+ * RING decides who may log: Ring<LogEntry> allows a single logging thread,
+ * MpscRing<LogEntry> allows any number of them. LogRecordRing stores the
+ * message bytes inline and does not allocate while logging, it also keeps
+ * deferred arguments unformatted until remove() is called.
+ *
+ * ERROR entries have a lane of their own, ERROR_RING, so that a burst of
+ * DEBUG/INFO cannot fill the space an ERROR needs:
+ * - DEBUG/INFO go to RING and are dropped when it is full, they never take
+ *   space from the ERROR lane.
+ * - ERROR goes to ERROR_RING and only if that is full to RING, it is
+ *   dropped only when both are full.
+ * remove() merges both lanes by time, entries still come out in the order
+ * they were logged.
  */
-class Hard_RT_ThreadedLogger : public ILogger
+template<typename RING, typename ERROR_RING = RING>
+class Basic_Hard_RT_ThreadedLogger : public ILogger
 {
 public:
-    Hard_RT_ThreadedLogger(bool debug, bool info)
+    Basic_Hard_RT_ThreadedLogger(bool debug, bool info)
     : ILogger(debug, info) {}
 
     void log(
         uint32_t line, const char* file, Level level, const std::string& msg) override
     {
-        m_ring.add(LogEntry { line, file, level, msg });
+        add(level, [&](auto& ring, bool& was_empty) {
+            if constexpr (requires {
+                              ring.add(line, file, level, msg, was_empty);
+                          })
+            {
+                return ring.add(line, file, level, msg, was_empty);
+            }
+            else
+            {
+                return ring.add(LogEntry { line, file, level, msg,
+                                    NO_LOG_SITE, false, now_ticks() },
+                    was_empty);
+            }
+        });
     }
 
-    std::optional<LogEntry> remove() override {
-        return m_ring.remove();
+    void log_site(LogSite& site, const std::string& msg) override
+    {
+        add(site.level, [&](auto& ring, bool& was_empty) {
+            if constexpr (requires { ring.add(site, msg, was_empty); })
+            {
+                return ring.add(site, msg, was_empty);
+            }
+            else
+            {
+                return ring.add(LogEntry { site.line, site.file, site.level,
+                                    msg, site.get_id(), false, now_ticks() },
+                    was_empty);
+            }
+        });
+    }
+
+    void log_deferred(LogSite& site, const DeferredArgs& args) override
+    {
+        if constexpr (requires { m_ring.add(site, args); } &&
+            requires { m_error_ring.add(site, args); })
+        {
+            add(site.level, [&](auto& ring, bool& was_empty) {
+                return ring.add(site, args, was_empty);
+            });
+        }
+        else
+        {
+            ILogger::log_deferred(site, args);
+        }
+    }
+
+    std::optional<LogEntry> remove() override
+    {
+        return remove_oldest(true);
+    }
+
+    std::optional<LogEntry> remove_unformatted() override
+    {
+        return remove_oldest(false);
     }
+
+    /** record rings cannot count their records, 1 if not empty */
+    uint32_t pending() const override
+    {
+        return pending(m_error_ring) + pending(m_ring) +
+            (m_error_head ? 1 : 0) + (m_head ? 1 : 0);
+    }
+
+    /** @returns number of entries of that level dropped because their lanes
+     * were full, may be called from any thread
+     */
+    uint64_t dropped(Level level) const
+    {
+        return m_dropped[static_cast<size_t>(level)].load(
+            std::memory_order_relaxed);
+    }
+
 private:
-    Ring<LogEntry> m_ring;
+    /** tries the level's lane, an ERROR may spill over into the other one */
+    template<typename ADD> void add(Level level, ADD&& add_to)
+    {
+        bool was_empty = false;
+        const bool ok = level == Level::ERROR
+            ? add_to(m_error_ring, was_empty) || add_to(m_ring, was_empty)
+            : add_to(m_ring, was_empty);
+        if (ok)
+        {
+            // a parked DrainThread can only be waiting for an empty ring
+            if (was_empty)
+            {
+                notify_drain();
+            }
+        }
+        else
+        {
+            m_dropped[static_cast<size_t>(level)].fetch_add(
+                1, std::memory_order_relaxed);
+        }
+    }
+
+    /** the lanes are merged by time, so entries come out in the order they
+     * were logged
+     */
+    std::optional<LogEntry> remove_oldest(bool format_args)
+    {
+        fill(m_head, m_ring, format_args);
+        fill(m_error_head, m_error_ring, format_args);
+        auto& head =
+            !m_head || (m_error_head && m_error_head->ticks < m_head->ticks)
+            ? m_error_head
+            : m_head;
+        auto elt = std::move(head);
+        head.reset();
+        if (elt && elt->args && format_args)
+        {
+            // taken out unformatted by an earlier remove_unformatted()
+            if (const auto* site = find_log_site(elt->site_id))
+            {
+                elt->msg = format_deferred(
+                    site->fmt, std::as_bytes(std::span(elt->msg)));
+            }
+            elt->args = false;
+        }
+        return elt;
+    }
+
+    template<typename R>
+    static void fill(std::optional<LogEntry>& head, R& ring, bool format_args)
+    {
+        if (head)
+        {
+            return;
+        }
+        if constexpr (requires { ring.remove(false); })
+        {
+            head = ring.remove(format_args);
+        }
+        else
+        {
+            head = ring.remove();
+        }
+    }
+
+    template<typename R> static uint32_t pending(const R& ring)
+    {
+        if constexpr (requires { ring.size(); })
+        {
+            return ring.size();
+        }
+        else
+        {
+            return ring.empty() ? 0 : 1;
+        }
+    }
+
+    RING m_ring;
+    ERROR_RING m_error_ring;
+
+    // consumer side: next entry of each lane, taken out to compare times
+    std::optional<LogEntry> m_head;
+    std::optional<LogEntry> m_error_head;
+
+    // written by the logging threads, indexed by Level
+    std::array<std::atomic<uint64_t>, 3> m_dropped {};
 };
 
-} // namespace logging
\ No newline at end of file
+/** number of entries the ERROR lane of the fixed-size rings holds */
+static constexpr uint32_t ERROR_LANE_SIZE = 32;
+
+/** single producer: only one thread may log into it */
+using Hard_RT_ThreadedLogger = Basic_Hard_RT_ThreadedLogger<Ring<LogEntry>,
+    Ring<LogEntry, ERROR_LANE_SIZE>>;
+
+/** multi producer: any number of threads may share it */
+using Hard_RT_MPSC_ThreadedLogger =
+    Basic_Hard_RT_ThreadedLogger<MpscRing<LogEntry>,
+        MpscRing<LogEntry, ERROR_LANE_SIZE>>;
+
+/** single producer, records serialized into a byte ring. ERROR messages
+ * longer than 2 KB are truncated by its smaller ERROR lane.
+ */
+using Hard_RT_RecordThreadedLogger =
+    Basic_Hard_RT_ThreadedLogger<LogRecordRing<>, LogRecordRing<4096>>;
+
+} // namespace logging
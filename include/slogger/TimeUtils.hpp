@@ -2,7 +2,10 @@
 
 #include <cassert>
 #include <chrono>
+#include <format>
 #include <functional>
+#include <optional>
+#include <string>
 
 #include "ITimer.hpp"
 
@@ -173,6 +176,10 @@ namespace tai
 } // namespace tai
 
 
+/** @returns "HH:MM:SS.nnnnnnnnn" (UTC) of a wall clock time since 1970 */
+std::string format_time_of_day(std::chrono::nanoseconds since_epoch);
+
+
 class Timeout
 {
 public:
@@ -203,4 +210,20 @@ private:
 };
 
 
-} // namespace time_utils
\ No newline at end of file
+} // namespace time_utils
+
+
+/** formats as the TAI timestamp string: seconds:nanoseconds */
+template <> struct std::formatter<time_utils::tai::nanoseconds>
+{
+    constexpr auto parse(std::format_parse_context& ctx)
+    {
+        return ctx.begin();
+    }
+
+    auto format(
+        const time_utils::tai::nanoseconds& ns, std::format_context& ctx) const
+    {
+        return std::format_to(ctx.out(), "{}:{}", ns.get_secs(), ns.get_nanos());
+    }
+};
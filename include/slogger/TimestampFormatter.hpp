@@ -0,0 +1,114 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <string>
+
+#include "TimeUtils.hpp"
+
+
+namespace time_utils
+{
+/** Renders the "HH:MM:SS.fffffffff" time of day of log records without
+ * gmtime() or std::format: the "HH:MM:SS." prefix is kept for the current
+ * second and when the second changes only the digits that changed are
+ * rewritten. The fraction is written as fixed-width digits.
+ *
+ * Wall clock times since 1970 (UTC) and TAI times (tai::nanoseconds) both
+ * have days of exactly 86400 seconds, so both work.
+ * Not thread-safe, meant to be kept by the thread that writes the output.
+ */
+class TimestampFormatter
+{
+public:
+    enum class Precision : uint8_t
+    {
+        MICROS = 6,
+        NANOS = 9
+    };
+
+    static constexpr size_t PREFIX_SIZE = 9;
+    static constexpr size_t MAX_SIZE = PREFIX_SIZE + 9;
+
+    explicit TimestampFormatter(Precision precision = Precision::NANOS)
+        : m_precision(precision)
+    {
+    }
+
+    /** number of chars format() writes */
+    size_t size() const
+    {
+        return PREFIX_SIZE + static_cast<size_t>(m_precision);
+    }
+
+    /** @param dst room for size() chars, no terminating 0 is written
+     * @returns size()
+     */
+    size_t format(char* dst, std::chrono::nanoseconds since_epoch)
+    {
+        auto second = since_epoch.count() / NANOS;
+        auto nanos = since_epoch.count() % NANOS;
+        if (nanos < 0)
+        {
+            second--;
+            nanos += NANOS;
+        }
+        if (second != m_second)
+        {
+            update_prefix(second);
+        }
+        std::memcpy(dst, m_prefix, PREFIX_SIZE);
+        if (m_precision == Precision::MICROS)
+        {
+            put_digits(dst + PREFIX_SIZE, nanos / 1000, 6);
+        }
+        else
+        {
+            put_digits(dst + PREFIX_SIZE, nanos, 9);
+        }
+        return size();
+    }
+
+    size_t format(char* dst, const tai::nanoseconds& since_epoch)
+    {
+        return format(dst,
+            std::chrono::nanoseconds(
+                static_cast<int64_t>(since_epoch.count())));
+    }
+
+    void append(std::string& out, std::chrono::nanoseconds since_epoch)
+    {
+        char buf[MAX_SIZE];
+        out.append(buf, format(buf, since_epoch));
+    }
+
+    void append(std::string& out, const tai::nanoseconds& since_epoch)
+    {
+        char buf[MAX_SIZE];
+        out.append(buf, format(buf, since_epoch));
+    }
+
+private:
+    static constexpr int64_t NANOS = 1'000'000'000;
+
+    /** writes value as exactly count decimal digits */
+    static void put_digits(char* dst, uint64_t value, int count)
+    {
+        for (int i = count - 1; i >= 0; i--)
+        {
+            dst[i] = static_cast<char>('0' + value % 10);
+            value /= 10;
+        }
+    }
+
+    void update_prefix(int64_t second);
+
+    Precision m_precision;
+    int64_t m_second = std::numeric_limits<int64_t>::min();
+    char m_prefix[PREFIX_SIZE] = {};
+};
+
+} // namespace time_utils
@@ -0,0 +1,131 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <ctime>
+#include <mutex>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+#include <slogger/ITimer.hpp>
+
+namespace time_utils
+{
+/** ITimer reading the CPU's time stamp counter, a few ns per read instead of
+ * a clock_gettime() call.
+ *
+ * The counter is calibrated once against CLOCK_MONOTONIC_RAW (see
+ * ClockRawTimer), get_time_ns() is on that time base. Log sites only store
+ * the raw ticks, the consumer converts them with to_ns() or to_wall_ns().
+ * Without an invariant TSC (or cntvct_el0 on aarch64) the ticks are
+ * CLOCK_MONOTONIC_RAW nanoseconds.
+ *
+ * Calibration measures the counter over CALIBRATION_TIME since the timer
+ * was created. It happens on the first conversion, or earlier with
+ * calibrate(), and only waits for what is left of that time. now_ticks()
+ * never waits for it.
+ */
+class TscTimer : public ITimer
+{
+public:
+    /** counter measured over at least this long */
+    static constexpr auto CALIBRATION_TIME = std::chrono::milliseconds(20);
+
+    /** update_wall_offset() does nothing more often than this */
+    static constexpr auto WALL_OFFSET_UPDATE_INTERVAL = std::chrono::seconds(1);
+
+    /** created on first use, calibrated on first conversion */
+    static const TscTimer& instance();
+
+    /** done by the conversions when needed, an application that does not
+     * want its first log line to wait can call it at startup
+     */
+    void calibrate() const;
+
+    /** recomputes the offset to_wall_ns() adds, so that it follows NTP
+     * adjustments of CLOCK_REALTIME. Cheap unless WALL_OFFSET_UPDATE_INTERVAL
+     * has passed, meant to be called by the consumer on every drain.
+     */
+    void update_wall_offset() const;
+
+    /** @returns the current tick count, cheap enough for every log call */
+    uint64_t now_ticks() const
+    {
+        if (m_use_counter) [[likely]]
+        {
+            return read_counter();
+        }
+        return raw_ns();
+    }
+
+    std::chrono::nanoseconds get_time_ns() const override
+    {
+        return to_ns(now_ticks());
+    }
+
+    /** @returns CLOCK_MONOTONIC_RAW time of ticks */
+    std::chrono::nanoseconds to_ns(uint64_t ticks) const;
+
+    /** @returns wall clock time (since 1970) of ticks */
+    std::chrono::nanoseconds to_wall_ns(uint64_t ticks) const
+    {
+        return to_ns(ticks) +
+            std::chrono::nanoseconds(
+                m_wall_offset_ns.load(std::memory_order_relaxed));
+    }
+
+    /** false when falling back to clock_gettime() */
+    bool uses_counter() const
+    {
+        return m_use_counter;
+    }
+
+    double ticks_per_ns() const;
+
+private:
+    TscTimer();
+
+    static uint64_t read_counter()
+    {
+#if defined(__x86_64__) || defined(__i386__)
+        return __rdtsc();
+#elif defined(__aarch64__)
+        uint64_t v;
+        asm volatile("mrs %0, cntvct_el0" : "=r"(v));
+        return v;
+#else
+        return raw_ns();
+#endif
+    }
+
+    static uint64_t raw_ns()
+    {
+        struct timespec now;
+        clock_gettime(CLOCK_MONOTONIC_RAW, &now);
+        return (uint64_t)now.tv_sec * UINT64_C(1000000000) +
+            (uint64_t)now.tv_nsec;
+    }
+
+    const bool m_use_counter;
+
+    // start of the calibration interval
+    const uint64_t m_start_ticks;
+    const uint64_t m_start_ns;
+
+    // set once by calibrate()
+    // ns = m_base_ns + ((ticks - m_base_ticks) * m_mult) >> MULT_SHIFT
+    static constexpr int MULT_SHIFT = 32;
+    mutable std::once_flag m_calibrated;
+    mutable uint64_t m_base_ticks = 0;
+    mutable uint64_t m_base_ns = 0;
+    mutable uint64_t m_mult = uint64_t(1) << MULT_SHIFT;
+
+    // CLOCK_REALTIME - CLOCK_MONOTONIC_RAW, and when that was taken
+    mutable std::atomic<int64_t> m_wall_offset_ns { 0 };
+    mutable std::atomic<uint64_t> m_wall_offset_time_ns { 0 };
+};
+
+} // namespace time_utils
@@ -0,0 +1,142 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "FdSink.hpp"
+
+
+namespace logging
+{
+struct UringSinkConfig
+{
+    /** buffer_size is also the size of each registered buffer */
+    FdSinkConfig sink;
+
+    /** writes submitted but not completed yet, each holds one buffer. When
+     * all buffers are in flight the writing thread waits for one.
+     */
+    uint32_t queue_depth = 8;
+};
+
+/** Writes text records like FdSink, but hands the batches to the kernel
+ * with io_uring instead of write(): a batch is copied into one of
+ * queue_depth buffers registered with the ring and submitted, the writing
+ * thread does not wait for storage unless all buffers are in flight.
+ * Completions are reaped in poll() and when a buffer is needed, the buffer
+ * is then reused.
+ *
+ * Writes to seekable files carry their own offset, so several can be in
+ * flight. Pipes, sockets and O_APPEND files have one write in flight at a
+ * time, the others are queued, to keep them in order.
+ *
+ * Uses the io_uring system calls directly. Where io_uring is not available
+ * (old kernel, seccomp), or submitting keeps failing, the batches are
+ * write()n like FdSink does. A write that fails to submit or completes with
+ * EAGAIN is retried by the next poll(), or write()n right away when its
+ * buffer is needed.
+ */
+class UringSink : public FdSink
+{
+public:
+    /** @param owned close fd on destruction */
+    UringSink(int fd, bool owned, const UringSinkConfig& cfg = {});
+
+    /** waits for the writes in flight */
+    ~UringSink() override;
+
+    void poll(std::chrono::nanoseconds now) override;
+
+    /** false when it fell back to write() */
+    bool uses_uring() const
+    {
+        return m_ring != nullptr;
+    }
+
+    /** waits until every submitted write has completed, writes that are
+     * held back are write()n
+     */
+    void wait_idle();
+
+    /** number of writes submitted, including resubmitted short writes */
+    uint64_t submitted() const
+    {
+        return m_submitted;
+    }
+
+    /** number of writes not completed yet */
+    uint32_t in_flight() const
+    {
+        return m_in_flight;
+    }
+
+    /** number of times the writing thread waited for a completion */
+    uint64_t waits() const
+    {
+        return m_waits;
+    }
+
+    /** number of writes that failed, their data is dropped */
+    uint64_t failed() const
+    {
+        return m_failed;
+    }
+
+protected:
+    void write_buffer(std::string& buf) override;
+
+private:
+    struct Ring;
+
+    struct Slot
+    {
+        std::unique_ptr<char[]> data;
+        uint32_t len = 0;
+        // bytes of data written so far
+        uint32_t done = 0;
+        uint64_t offset = 0;
+    };
+
+    bool setup(uint32_t entries);
+
+    /** takes the completed writes, resubmits short ones
+     * @param wait block for at least one completion
+     */
+    void reap(bool wait);
+
+    /** submits queued slots as far as ordering allows */
+    void submit_queued();
+
+    /** @returns false if the kernel did not take it */
+    bool submit(uint32_t slot);
+
+    /** write()s the queued slots, in order */
+    void write_queued();
+
+    /** stops using the ring once the writes in flight have completed */
+    void fall_back();
+
+    const uint32_t m_slot_size;
+    std::unique_ptr<Ring> m_ring;
+    bool m_fixed = false;
+
+    std::vector<Slot> m_slots;
+    std::vector<uint32_t> m_free;
+    // filled slots not submitted yet, in file order
+    std::vector<uint32_t> m_queued;
+    // set after EAGAIN or a failed submit, m_queued waits for poll()
+    bool m_hold_queued = false;
+    uint32_t m_submit_errors = 0;
+
+    // -1 for fds without a file position of their own
+    int64_t m_offset = -1;
+
+    uint32_t m_in_flight = 0;
+    uint64_t m_submitted = 0;
+    uint64_t m_waits = 0;
+    uint64_t m_failed = 0;
+};
+
+} // namespace logging
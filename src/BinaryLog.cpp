@@ -0,0 +1,176 @@
+#include <algorithm>
+#include <span>
+
+#include <slogger/BinaryLog.hpp>
+#include <slogger/DeferredFormat.hpp>
+#include <slogger/ISink.hpp>
+
+
+namespace logging
+{
+BinaryLogReader::BinaryLogReader(std::istream& in)
+    : m_in(in)
+{
+    char magic[binary_log::MAGIC.size()];
+    if (!m_in.read(magic, sizeof(magic)) ||
+        std::string_view(magic, sizeof(magic)) != binary_log::MAGIC)
+    {
+        fail();
+        return;
+    }
+    const int order = m_in.get();
+    if (order == static_cast<int>(binary_log::ByteOrder::LITTLE) ||
+        order == static_cast<int>(binary_log::ByteOrder::BIG))
+    {
+        if (order != static_cast<int>(binary_log::NATIVE_BYTE_ORDER))
+        {
+            m_status = error::Error::RANGE;
+        }
+        return;
+    }
+    fail();
+}
+
+bool BinaryLogReader::fail()
+{
+    m_status = error::Error::BAD_PPROTOCOL;
+    return false;
+}
+
+bool BinaryLogReader::read_varint(uint64_t& v)
+{
+    v = 0;
+    for (uint32_t shift = 0; shift < 64; shift += 7)
+    {
+        const int c = m_in.get();
+        if (c == std::istream::traits_type::eof())
+        {
+            return fail();
+        }
+        v |= static_cast<uint64_t>(c & 0x7f) << shift;
+        if ((c & 0x80) == 0)
+        {
+            return true;
+        }
+    }
+    return fail();
+}
+
+bool BinaryLogReader::read_bytes(std::string& out)
+{
+    uint64_t len = 0;
+    if (!read_varint(len))
+    {
+        return false;
+    }
+    // do not trust the length for the allocation, the file may be cut off
+    out.clear();
+    char buf[4096];
+    while (len > 0)
+    {
+        const auto n = std::min<uint64_t>(len, sizeof(buf));
+        if (!m_in.read(buf, n))
+        {
+            return fail();
+        }
+        out.append(buf, n);
+        len -= n;
+    }
+    return true;
+}
+
+bool BinaryLogReader::read_dict()
+{
+    uint64_t key = 0;
+    uint64_t line = 0;
+    uint64_t level = 0;
+    DictEntry e;
+    if (!read_varint(key) || !read_varint(line) || !read_varint(level) ||
+        !read_bytes(e.file) || !read_bytes(e.fmt))
+    {
+        return false;
+    }
+    // keys are handed out in order
+    if (key != m_dict.size() || level > static_cast<uint64_t>(Level::ERROR))
+    {
+        return fail();
+    }
+    e.line = static_cast<uint32_t>(line);
+    e.level = static_cast<Level>(level);
+    m_dict.push_back(std::move(e));
+    return true;
+}
+
+bool BinaryLogReader::next(DecodedRecord& rec)
+{
+    while (m_status == error::Error::OK)
+    {
+        const int type = m_in.get();
+        if (type == std::istream::traits_type::eof())
+        {
+            return false;
+        }
+        if (type == static_cast<int>(binary_log::EntryType::DICT))
+        {
+            if (!read_dict())
+            {
+                return false;
+            }
+            continue;
+        }
+        if (type != static_cast<int>(binary_log::EntryType::TEXT) &&
+            type != static_cast<int>(binary_log::EntryType::ARGS))
+        {
+            return fail();
+        }
+
+        uint64_t key = 0;
+        uint64_t delta = 0;
+        if (!read_varint(key) || !read_varint(delta) ||
+            !read_bytes(m_bytes))
+        {
+            return false;
+        }
+        if (key >= m_dict.size())
+        {
+            return fail();
+        }
+        const auto& e = m_dict[key];
+        m_time += binary_log::unzigzag(delta);
+
+        rec.line = e.line;
+        rec.file = e.file;
+        rec.level = e.level;
+        rec.time = std::chrono::nanoseconds(m_time);
+        if (type == static_cast<int>(binary_log::EntryType::ARGS))
+        {
+            rec.msg = format_deferred(e.fmt,
+                std::span(reinterpret_cast<const std::byte*>(m_bytes.data()),
+                    m_bytes.size()));
+        }
+        else
+        {
+            rec.msg.swap(m_bytes);
+        }
+        return true;
+    }
+    return false;
+}
+
+error::Error decode_binary_log(std::istream& in, std::ostream& out)
+{
+    BinaryLogReader reader(in);
+    DecodedRecord rec;
+    std::string line;
+    while (reader.next(rec))
+    {
+        line.clear();
+        append_text_line(line,
+            SinkRecord { rec.line, rec.file.c_str(), rec.level, rec.msg,
+                rec.time });
+        out << line;
+    }
+    return reader.status();
+}
+
+} // namespace logging
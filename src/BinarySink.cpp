@@ -0,0 +1,86 @@
+#include <slogger/BinarySink.hpp>
+
+
+namespace logging
+{
+namespace
+{
+    void put_bytes(std::string& out, std::string_view bytes)
+    {
+        binary_log::put_varint(out, bytes.size());
+        out.append(bytes);
+    }
+} // namespace
+
+
+BinarySink::BinarySink(int fd, bool owned, const FdSinkConfig& cfg)
+    : FdSink(fd, owned, cfg)
+{
+}
+
+uint64_t BinarySink::key_of(std::string& buf, const SinkRecord& rec)
+{
+    const LogSite* site = nullptr;
+    if (rec.site_id != NO_LOG_SITE)
+    {
+        if (rec.site_id < m_site_keys.size() && m_site_keys[rec.site_id] != 0)
+        {
+            return m_site_keys[rec.site_id] - 1;
+        }
+        site = find_log_site(rec.site_id);
+    }
+    const Location loc { rec.file, rec.line, rec.level };
+    if (site == nullptr)
+    {
+        if (const auto it = m_location_keys.find(loc);
+            it != m_location_keys.end())
+        {
+            return it->second;
+        }
+    }
+
+    const auto key = m_next_key++;
+    buf += static_cast<char>(binary_log::EntryType::DICT);
+    binary_log::put_varint(buf, key);
+    binary_log::put_varint(buf, rec.line);
+    binary_log::put_varint(buf, static_cast<uint8_t>(rec.level));
+    put_bytes(buf, rec.file);
+    put_bytes(buf, site != nullptr ? site->fmt : std::string_view());
+
+    if (site != nullptr)
+    {
+        if (rec.site_id >= m_site_keys.size())
+        {
+            m_site_keys.resize(rec.site_id + 1);
+        }
+        m_site_keys[rec.site_id] = key + 1;
+    }
+    else
+    {
+        m_location_keys.emplace(loc, key);
+    }
+    return key;
+}
+
+void BinarySink::append(std::string& buf, const SinkRecord& rec)
+{
+    if (!m_header_written)
+    {
+        buf.append(binary_log::MAGIC);
+        buf += static_cast<char>(binary_log::NATIVE_BYTE_ORDER);
+        m_header_written = true;
+    }
+    const auto key = key_of(buf, rec);
+    // without a format string in the dictionary the arguments are useless
+    const bool args = rec.args && rec.site_id < m_site_keys.size() &&
+        m_site_keys[rec.site_id] != 0;
+
+    buf += static_cast<char>(
+        args ? binary_log::EntryType::ARGS : binary_log::EntryType::TEXT);
+    binary_log::put_varint(buf, key);
+    binary_log::put_varint(buf, binary_log::zigzag(rec.time.count() - m_time));
+    m_time = rec.time.count();
+    put_bytes(buf, rec.msg);
+}
+
+} // namespace logging
@@ -0,0 +1,147 @@
+#include <algorithm>
+
+#include <slogger/CompressedFileSink.hpp>
+
+
+namespace logging
+{
+CompressedFileSink::CompressedFileSink(
+    int fd, bool owned, const CompressedFileConfig& cfg)
+    : FdSink(fd, owned, cfg.sink)
+    , m_cfg(cfg)
+{
+    write_all(compressed_log::MAGIC);
+    for (uint32_t i = 0; i < std::max<uint32_t>(m_cfg.workers, 1); i++)
+    {
+        m_threads.emplace_back([this] { run(); });
+    }
+}
+
+CompressedFileSink::~CompressedFileSink()
+{
+    flush();
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_work_cond.notify_all();
+    for (auto& t : m_threads)
+    {
+        t.join();
+    }
+
+    std::string index;
+    compressed_log::put_u32(index, 0);
+    compressed_log::put_u32(index, static_cast<uint32_t>(m_index.size()));
+    for (const auto& e : m_index)
+    {
+        compressed_log::put_u64(index, e.offset);
+        compressed_log::put_u32(index, e.raw_size);
+    }
+    compressed_log::put_u64(index, m_offset);
+    index.append(compressed_log::INDEX_MAGIC);
+    write_all(index);
+}
+
+uint64_t CompressedFileSink::blocks() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_next_write;
+}
+
+uint64_t CompressedFileSink::raw_bytes() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_raw_bytes;
+}
+
+uint64_t CompressedFileSink::stored_bytes() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_stored_bytes;
+}
+
+uint64_t CompressedFileSink::stalls() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_stalls;
+}
+
+void CompressedFileSink::write_buffer(std::string& buf)
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    if (m_pending >= m_cfg.max_pending_blocks)
+    {
+        m_stalls++;
+        m_space_cond.wait(
+            lock, [this] { return m_pending < m_cfg.max_pending_blocks; });
+    }
+    std::string next;
+    if (!m_free.empty())
+    {
+        next = std::move(m_free.back());
+        m_free.pop_back();
+    }
+    else
+    {
+        next.reserve(buf.capacity());
+    }
+    m_jobs.push_back(Job { m_next_seq++, std::move(buf) });
+    buf = std::move(next);
+    m_pending++;
+    lock.unlock();
+    m_work_cond.notify_one();
+}
+
+void CompressedFileSink::run()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (true)
+    {
+        m_work_cond.wait(lock, [this] { return m_stop || !m_jobs.empty(); });
+        if (m_jobs.empty())
+        {
+            // m_stop, and the blocks written by whoever is writing
+            return;
+        }
+        auto job = std::move(m_jobs.front());
+        m_jobs.erase(m_jobs.begin());
+        lock.unlock();
+
+        Block block { std::string(), static_cast<uint32_t>(job.raw.size()) };
+        compressed_log::append_block(block.data, job.raw);
+        job.raw.clear();
+
+        lock.lock();
+        m_raw_bytes += block.raw_size + compressed_log::BLOCK_HEADER_SIZE;
+        m_stored_bytes += block.data.size();
+        m_free.push_back(std::move(job.raw));
+        m_done.emplace(job.seq, std::move(block));
+        if (m_writing)
+        {
+            // the writing worker picks it up
+            continue;
+        }
+
+        m_writing = true;
+        for (auto it = m_done.find(m_next_write); it != m_done.end();
+             it = m_done.find(m_next_write))
+        {
+            auto done = std::move(it->second);
+            m_done.erase(it);
+            lock.unlock();
+
+            m_index.push_back(BlockIndexEntry { m_offset, done.raw_size });
+            write_all(done.data);
+            m_offset += done.data.size();
+
+            lock.lock();
+            m_next_write++;
+            m_pending--;
+            m_space_cond.notify_one();
+        }
+        m_writing = false;
+    }
+}
+
+} // namespace logging
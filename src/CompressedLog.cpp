@@ -0,0 +1,190 @@
+#include <algorithm>
+
+#include <slogger/CompressedLog.hpp>
+#include <slogger/Lz.hpp>
+
+
+namespace logging
+{
+namespace
+{
+    uint64_t get_le(const char* p, int bytes)
+    {
+        uint64_t v = 0;
+        for (int i = 0; i < bytes; i++)
+        {
+            v |= static_cast<uint64_t>(static_cast<unsigned char>(p[i]))
+                << (8 * i);
+        }
+        return v;
+    }
+
+    /** the largest block a reader accepts, against corrupt sizes */
+    constexpr uint32_t MAX_BLOCK_SIZE = 256 * 1024 * 1024;
+} // namespace
+
+
+namespace compressed_log
+{
+    void append_block(std::string& out, std::string_view raw)
+    {
+        const auto header = out.size();
+        out.resize(header + BLOCK_HEADER_SIZE +
+            lz::max_compressed_size(raw.size()));
+        const auto size = lz::compress(
+            raw.data(), raw.size(), out.data() + header + BLOCK_HEADER_SIZE);
+
+        const bool stored = size >= raw.size();
+        if (stored)
+        {
+            std::copy(raw.begin(), raw.end(),
+                out.begin() + header + BLOCK_HEADER_SIZE);
+        }
+        const auto stored_size = stored ? raw.size() : size;
+        std::string head;
+        put_u32(head, static_cast<uint32_t>(stored_size));
+        put_u32(head, static_cast<uint32_t>(raw.size()));
+        head += static_cast<char>(stored ? Codec::STORED : Codec::LZ);
+        std::copy(head.begin(), head.end(), out.begin() + header);
+        out.resize(header + BLOCK_HEADER_SIZE + stored_size);
+    }
+} // namespace compressed_log
+
+
+CompressedLogReader::CompressedLogReader(std::istream& in)
+    : m_in(in)
+{
+    char magic[compressed_log::MAGIC.size()];
+    if (!m_in.read(magic, sizeof(magic)) ||
+        std::string_view(magic, sizeof(magic)) != compressed_log::MAGIC)
+    {
+        fail();
+    }
+}
+
+bool CompressedLogReader::fail()
+{
+    m_status = error::Error::BAD_PPROTOCOL;
+    return false;
+}
+
+bool CompressedLogReader::next(std::string& block)
+{
+    if (m_status != error::Error::OK)
+    {
+        return false;
+    }
+    char header[compressed_log::BLOCK_HEADER_SIZE];
+    if (!m_in.read(header, 4))
+    {
+        // cut off after a complete block: no index, but nothing is lost
+        return m_in.gcount() == 0 ? false : fail();
+    }
+    const auto stored_size = static_cast<uint32_t>(get_le(header, 4));
+    if (stored_size == 0)
+    {
+        // the index follows
+        return false;
+    }
+    if (!m_in.read(header + 4, compressed_log::BLOCK_HEADER_SIZE - 4))
+    {
+        return fail();
+    }
+    const auto raw_size = static_cast<uint32_t>(get_le(header + 4, 4));
+    const auto codec = static_cast<compressed_log::Codec>(header[8]);
+    if (stored_size > MAX_BLOCK_SIZE || raw_size > MAX_BLOCK_SIZE)
+    {
+        return fail();
+    }
+
+    m_stored.resize(stored_size);
+    if (!m_in.read(m_stored.data(), stored_size))
+    {
+        return fail();
+    }
+    switch (codec)
+    {
+    case compressed_log::Codec::STORED:
+        if (stored_size != raw_size)
+        {
+            return fail();
+        }
+        block.swap(m_stored);
+        return true;
+    case compressed_log::Codec::LZ:
+        block.resize(raw_size);
+        if (!lz::decompress(
+                m_stored.data(), stored_size, block.data(), raw_size))
+        {
+            return fail();
+        }
+        return true;
+    }
+    return fail();
+}
+
+error::Error read_block_index(
+    std::istream& in, std::vector<BlockIndexEntry>& index)
+{
+    index.clear();
+    char magic[compressed_log::MAGIC.size()];
+    in.seekg(0);
+    if (!in.read(magic, sizeof(magic)) ||
+        std::string_view(magic, sizeof(magic)) != compressed_log::MAGIC)
+    {
+        return error::Error::BAD_PPROTOCOL;
+    }
+
+    char trailer[compressed_log::TRAILER_SIZE];
+    in.seekg(0, std::ios::end);
+    const auto file_size = static_cast<uint64_t>(in.tellg());
+    if (file_size < compressed_log::MAGIC.size() + compressed_log::TRAILER_SIZE)
+    {
+        return error::Error::NOT_READY;
+    }
+    in.seekg(file_size - compressed_log::TRAILER_SIZE);
+    if (!in.read(trailer, sizeof(trailer)) ||
+        std::string_view(trailer + 8, 8) != compressed_log::INDEX_MAGIC)
+    {
+        return error::Error::NOT_READY;
+    }
+
+    const auto offset = get_le(trailer, 8);
+    char head[8];
+    in.seekg(offset);
+    if (offset >= file_size || !in.read(head, sizeof(head)) ||
+        get_le(head, 4) != 0)
+    {
+        return error::Error::BAD_PPROTOCOL;
+    }
+    const auto count = get_le(head + 4, 4);
+    if (count * 12 + 8 + compressed_log::TRAILER_SIZE != file_size - offset)
+    {
+        return error::Error::BAD_PPROTOCOL;
+    }
+    index.resize(count);
+    for (auto& e : index)
+    {
+        char entry[12];
+        if (!in.read(entry, sizeof(entry)))
+        {
+            return error::Error::BAD_PPROTOCOL;
+        }
+        e.offset = get_le(entry, 8);
+        e.raw_size = static_cast<uint32_t>(get_le(entry + 8, 4));
+    }
+    return error::Error::OK;
+}
+
+error::Error decode_compressed_log(std::istream& in, std::ostream& out)
+{
+    CompressedLogReader reader(in);
+    std::string block;
+    while (reader.next(block))
+    {
+        out << block;
+    }
+    return reader.status();
+}
+
+} // namespace logging
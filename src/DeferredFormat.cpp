@@ -0,0 +1,283 @@
+#include <array>
+#include <cstring>
+#include <exception>
+#include <format>
+#include <iterator>
+#include <limits>
+#include <optional>
+#include <string>
+
+#include <slogger/DeferredFormat.hpp>
+
+
+namespace logging
+{
+namespace
+{
+    struct ArgView
+    {
+        ArgTag tag;
+        const std::byte* value;
+        uint32_t len;
+    };
+
+    template<typename V> V get(const std::byte* p)
+    {
+        V v;
+        std::memcpy(&v, p, sizeof(v));
+        return v;
+    }
+
+    /** @returns number of arguments found, or -1 if the bytes are corrupt */
+    int decode(std::span<const std::byte> args,
+        std::array<ArgView, MAX_DEFERRED_ARGS>& out)
+    {
+        size_t off = 0;
+        int count = 0;
+        while (off < args.size())
+        {
+            if (count == static_cast<int>(MAX_DEFERRED_ARGS))
+            {
+                return -1;
+            }
+            ArgView& a = out[count++];
+            a.tag = static_cast<ArgTag>(args[off++]);
+            switch (a.tag)
+            {
+            case ArgTag::BOOL:
+            case ArgTag::CHAR:
+                a.len = 1;
+                break;
+            case ArgTag::FLOAT:
+            case ArgTag::ERROR:
+                a.len = 4;
+                break;
+            case ArgTag::INT:
+            case ArgTag::UINT:
+            case ArgTag::DOUBLE:
+            case ArgTag::POINTER:
+            case ArgTag::TAI_NANOS:
+                a.len = 8;
+                break;
+            case ArgTag::STRING:
+                if (off + 4 > args.size())
+                {
+                    return -1;
+                }
+                a.len = get<uint32_t>(&args[off]);
+                off += 4;
+                break;
+            default:
+                return -1;
+            }
+            if (off + a.len > args.size())
+            {
+                return -1;
+            }
+            a.value = args.data() + off;
+            off += a.len;
+        }
+        return count;
+    }
+
+    template<typename V>
+    void format_value(std::string& out, std::string_view field, const V& v)
+    {
+        std::vformat_to(
+            std::back_inserter(out), field, std::make_format_args(v));
+    }
+
+    /** @param field a single replacement field with an empty arg-id,
+     * e.g. "{:>8}"
+     */
+    void format_arg(std::string& out, std::string_view field, const ArgView& a)
+    {
+        switch (a.tag)
+        {
+        case ArgTag::BOOL:
+            format_value(out, field, get<uint8_t>(a.value) != 0);
+            break;
+        case ArgTag::CHAR:
+            format_value(out, field, static_cast<char>(get<uint8_t>(a.value)));
+            break;
+        case ArgTag::INT:
+            format_value(out, field, get<int64_t>(a.value));
+            break;
+        case ArgTag::UINT:
+            format_value(out, field, get<uint64_t>(a.value));
+            break;
+        case ArgTag::FLOAT:
+            format_value(out, field, get<float>(a.value));
+            break;
+        case ArgTag::DOUBLE:
+            format_value(out, field, get<double>(a.value));
+            break;
+        case ArgTag::STRING:
+            format_value(out, field,
+                std::string_view(
+                    reinterpret_cast<const char*>(a.value), a.len));
+            break;
+        case ArgTag::POINTER:
+            format_value(out, field,
+                reinterpret_cast<const void*>(
+                    static_cast<uintptr_t>(get<uint64_t>(a.value))));
+            break;
+        case ArgTag::ERROR:
+            format_value(out, field,
+                static_cast<error::Error>(get<uint32_t>(a.value)));
+            break;
+        case ArgTag::TAI_NANOS:
+            format_value(out, field,
+                time_utils::tai::nanoseconds(get<uint64_t>(a.value)));
+            break;
+        }
+    }
+
+    /** @returns the value of a nested width/precision argument, range
+     * checked like std::format does
+     */
+    std::optional<uint64_t> integer_arg(const ArgView& a)
+    {
+        uint64_t v = 0;
+        switch (a.tag)
+        {
+        case ArgTag::INT:
+        {
+            const auto i = get<int64_t>(a.value);
+            if (i < 0)
+            {
+                throw std::format_error("negative width or precision");
+            }
+            v = static_cast<uint64_t>(i);
+            break;
+        }
+        case ArgTag::UINT:
+            v = get<uint64_t>(a.value);
+            break;
+        default:
+            return std::nullopt;
+        }
+        if (v > static_cast<uint64_t>(std::numeric_limits<int>::max()))
+        {
+            throw std::format_error("width or precision out of range");
+        }
+        return v;
+    }
+
+    /** parses an optional arg-id at fmt[i], manual or automatic numbering */
+    size_t parse_arg_id(
+        std::string_view fmt, size_t& i, size_t& next_auto_id)
+    {
+        if (i < fmt.size() && fmt[i] >= '0' && fmt[i] <= '9')
+        {
+            size_t id = 0;
+            while (i < fmt.size() && fmt[i] >= '0' && fmt[i] <= '9')
+            {
+                id = id * 10 + (fmt[i++] - '0');
+            }
+            return id;
+        }
+        return next_auto_id++;
+    }
+
+    void format_all(std::string& out, std::string_view fmt,
+        const std::array<ArgView, MAX_DEFERRED_ARGS>& args, size_t count)
+    {
+        // reused for every replacement field: "{:" + spec + "}"
+        std::string field;
+        size_t next_auto_id = 0;
+
+        size_t i = 0;
+        while (i < fmt.size())
+        {
+            const char ch = fmt[i++];
+            if (ch == '}')
+            {
+                // "}}" -> "}"
+                if (i < fmt.size() && fmt[i] == '}')
+                {
+                    i++;
+                }
+                out += '}';
+                continue;
+            }
+            if (ch != '{')
+            {
+                out += ch;
+                continue;
+            }
+            if (i < fmt.size() && fmt[i] == '{')
+            {
+                out += '{';
+                i++;
+                continue;
+            }
+
+            const auto id = parse_arg_id(fmt, i, next_auto_id);
+            field.clear();
+            field += '{';
+            if (i < fmt.size() && fmt[i] == ':')
+            {
+                field += fmt[i++];
+                while (i < fmt.size() && fmt[i] != '}')
+                {
+                    if (fmt[i] != '{')
+                    {
+                        field += fmt[i++];
+                        continue;
+                    }
+                    // nested dynamic width/precision: substitute its value
+                    i++;
+                    const auto nested = parse_arg_id(fmt, i, next_auto_id);
+                    if (i >= fmt.size() || fmt[i] != '}' || nested >= count)
+                    {
+                        throw std::format_error("bad nested replacement field");
+                    }
+                    i++;
+                    const auto v = integer_arg(args[nested]);
+                    if (!v)
+                    {
+                        throw std::format_error("width is not an integer");
+                    }
+                    field += std::to_string(*v);
+                }
+            }
+            if (i >= fmt.size())
+            {
+                throw std::format_error("unterminated replacement field");
+            }
+            field += fmt[i++];
+            if (id >= count)
+            {
+                throw std::format_error("argument index out of range");
+            }
+            format_arg(out, field, args[id]);
+        }
+    }
+} // namespace
+
+
+std::string format_deferred(
+    std::string_view fmt, std::span<const std::byte> args)
+{
+    std::array<ArgView, MAX_DEFERRED_ARGS> views;
+    const int count = decode(args, views);
+    if (count < 0)
+    {
+        return std::format("{} <corrupt log arguments>", fmt);
+    }
+
+    std::string out;
+    out.reserve(fmt.size() + args.size());
+    try
+    {
+        format_all(out, fmt, views, count);
+    }
+    catch (const std::exception& e)
+    {
+        out += std::format(" <format error: {}>", e.what());
+    }
+    return out;
+}
+
+} // namespace logging
@@ -0,0 +1,163 @@
+#include <cerrno>
+#include <climits>
+#include <ctime>
+#include <future>
+
+#include <linux/futex.h>
+#include <pthread.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <slogger/DrainThread.hpp>
+
+
+namespace logging
+{
+namespace
+{
+    void cpu_relax()
+    {
+#if defined(__x86_64__) || defined(__i386__)
+        __builtin_ia32_pause();
+#elif defined(__aarch64__)
+        asm volatile("yield");
+#endif
+    }
+
+    long futex(std::atomic<uint32_t>& word, int op, uint32_t val,
+        const struct timespec* timeout)
+    {
+        return syscall(SYS_futex, reinterpret_cast<uint32_t*>(&word), op, val,
+            timeout, nullptr, 0);
+    }
+} // namespace
+
+
+DrainSignal& DrainSignal::instance()
+{
+    static DrainSignal signal;
+    return signal;
+}
+
+uint32_t DrainSignal::prepare_park()
+{
+    const auto seq = m_seq.load(std::memory_order_relaxed);
+    m_parked.fetch_add(1, std::memory_order_relaxed);
+    // pairs with the fence in notify(): either the producer sees m_parked
+    // or the consumer's re-check of the rings sees the entry
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    return seq;
+}
+
+void DrainSignal::park(uint32_t seq, std::chrono::nanoseconds timeout)
+{
+    const auto secs = std::chrono::duration_cast<std::chrono::seconds>(timeout);
+    const struct timespec ts { static_cast<time_t>(secs.count()),
+        static_cast<long>((timeout - secs).count()) };
+    // returns right away if wake() bumped m_seq since prepare_park()
+    futex(m_seq, FUTEX_WAIT_PRIVATE, seq, &ts);
+    m_parked.fetch_sub(1, std::memory_order_relaxed);
+}
+
+void DrainSignal::cancel_park()
+{
+    m_parked.fetch_sub(1, std::memory_order_relaxed);
+}
+
+void DrainSignal::wake()
+{
+    if (m_parked.load() != 0)
+    {
+        // the waiters do not know which of them the entry is for
+        m_seq.fetch_add(1, std::memory_order_release);
+        futex(m_seq, FUTEX_WAKE_PRIVATE, INT_MAX, nullptr);
+    }
+}
+
+
+DrainThread::DrainThread(
+    std::function<uint32_t()> drain, const DrainThreadConfig& cfg)
+    : m_drain(std::move(drain))
+    , m_cfg(cfg)
+{
+    DrainSignal::instance().add_drain_thread(1);
+    std::promise<error::Error> setup;
+    auto setup_error = setup.get_future();
+    m_thread = std::thread([this, &setup] {
+        // before the first drain round
+        setup.set_value(apply_config());
+        run();
+    });
+    m_setup_error = setup_error.get();
+}
+
+error::Error DrainThread::apply_config()
+{
+    auto result = error::Error::OK;
+    const auto handle = pthread_self();
+    if (m_cfg.cpu >= 0)
+    {
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(m_cfg.cpu, &set);
+        if (const int err = pthread_setaffinity_np(handle, sizeof(set), &set))
+        {
+            result = error::errno_to_error(err);
+        }
+    }
+    if (m_cfg.policy != SCHED_OTHER || m_cfg.priority != 0)
+    {
+        struct sched_param param {};
+        param.sched_priority = m_cfg.priority;
+        if (const int err =
+                pthread_setschedparam(handle, m_cfg.policy, &param))
+        {
+            result = error::errno_to_error(err);
+        }
+    }
+    return result;
+}
+
+DrainThread::~DrainThread()
+{
+    m_stop.store(true);
+    DrainSignal::instance().wake();
+    m_thread.join();
+    DrainSignal::instance().add_drain_thread(-1);
+}
+
+void DrainThread::run()
+{
+    auto& signal = DrainSignal::instance();
+    uint32_t idle_rounds = 0;
+    while (!m_stop.load(std::memory_order_acquire))
+    {
+        if (m_drain() != 0)
+        {
+            idle_rounds = 0;
+            continue;
+        }
+        if (++idle_rounds < m_cfg.spin_rounds)
+        {
+            cpu_relax();
+            continue;
+        }
+
+        const auto seq = signal.prepare_park();
+        if (m_stop.load(std::memory_order_acquire) || m_drain() != 0)
+        {
+            signal.cancel_park();
+        }
+        else
+        {
+            signal.park(seq, m_cfg.max_park);
+        }
+        idle_rounds = 0;
+    }
+    // whatever was logged before the stop
+    while (m_drain() != 0)
+    {
+    }
+}
+
+} // namespace logging
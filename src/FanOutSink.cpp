@@ -0,0 +1,84 @@
+#include <span>
+
+#include <slogger/DeferredFormat.hpp>
+#include <slogger/FanOutSink.hpp>
+
+
+namespace logging
+{
+void FanOutSink::add(std::unique_ptr<ISink> sink, Level min_level)
+{
+    m_targets.push_back(Target { std::move(sink), min_level });
+}
+
+void FanOutSink::write(const SinkRecord& rec)
+{
+    // rec with the arguments formatted and the text line, made on demand
+    SinkRecord plain = rec;
+    bool have_msg = !rec.args;
+    bool have_text = !rec.text.empty();
+
+    for (const auto& t : m_targets)
+    {
+        if (rec.level < t.min_level)
+        {
+            continue;
+        }
+        if (rec.args && t.sink->wants_args())
+        {
+            t.sink->write(rec);
+            continue;
+        }
+        if (!have_msg)
+        {
+            const auto* site = find_log_site(rec.site_id);
+            m_msg = site != nullptr
+                ? format_deferred(site->fmt,
+                      std::as_bytes(std::span(rec.msg.data(), rec.msg.size())))
+                : std::string("<unknown log site>");
+            plain.msg = m_msg;
+            plain.args = false;
+            have_msg = true;
+            m_formatted_args++;
+        }
+        if (!have_text && t.sink->writes_text())
+        {
+            m_text.clear();
+            append_text_line(m_text, plain);
+            plain.text = m_text;
+            have_text = true;
+            m_formatted_lines++;
+        }
+        t.sink->write(plain);
+    }
+}
+
+void FanOutSink::poll(std::chrono::nanoseconds now)
+{
+    for (const auto& t : m_targets)
+    {
+        t.sink->poll(now);
+    }
+}
+
+void FanOutSink::flush()
+{
+    for (const auto& t : m_targets)
+    {
+        t.sink->flush();
+    }
+}
+
+bool FanOutSink::wants_args() const
+{
+    for (const auto& t : m_targets)
+    {
+        if (t.sink->wants_args())
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+} // namespace logging
@@ -0,0 +1,99 @@
+#include <cerrno>
+
+#include <unistd.h>
+
+#include <slogger/FdSink.hpp>
+
+
+namespace logging
+{
+FdSink::FdSink(int fd, bool owned, const FdSinkConfig& cfg)
+    : m_fd(fd)
+    , m_owned(owned)
+    , m_cfg(cfg)
+{
+    // a record is appended before checking the size, leave room for one
+    m_buf.reserve(m_cfg.buffer_size + 4096);
+}
+
+FdSink::~FdSink()
+{
+    flush();
+    if (m_owned)
+    {
+        close(m_fd);
+    }
+}
+
+void FdSink::write(const SinkRecord& rec)
+{
+    if (m_buf.empty())
+    {
+        m_oldest = rec.time;
+    }
+    const auto size = m_buf.size();
+    append(m_buf, rec);
+    m_bytes += m_buf.size() - size;
+    m_records++;
+
+    if (rec.level == Level::ERROR)
+    {
+        m_error_pending = true;
+    }
+    if (m_buf.size() >= m_cfg.buffer_size || m_cfg.max_latency.count() == 0)
+    {
+        flush();
+    }
+}
+
+void FdSink::append(std::string& buf, const SinkRecord& rec)
+{
+    append_text_line(buf, rec);
+}
+
+void FdSink::poll(std::chrono::nanoseconds now)
+{
+    if (!m_buf.empty() &&
+        (m_error_pending || now - m_oldest >= m_cfg.max_latency))
+    {
+        flush();
+    }
+}
+
+void FdSink::flush()
+{
+    if (!m_buf.empty())
+    {
+        write_buffer(m_buf);
+    }
+    m_buf.clear();
+    m_error_pending = false;
+}
+
+void FdSink::write_buffer(std::string& buf)
+{
+    write_all(buf);
+}
+
+bool FdSink::write_all(std::string_view data)
+{
+    size_t done = 0;
+    while (done < data.size())
+    {
+        const auto n = ::write(m_fd, data.data() + done, data.size() - done);
+        m_syscalls++;
+        if (n < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            // nowhere to report it, drop the batch
+            return false;
+        }
+        done += n;
+    }
+    return true;
+}
+
+} // namespace logging
@@ -0,0 +1,205 @@
+#include <array>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <slogger/LogSite.hpp>
+
+
+namespace logging
+{
+namespace
+{
+    static constexpr uint32_t SITES_PER_CHUNK = 1024;
+    static constexpr uint32_t MAX_CHUNKS = MAX_LOG_SITES / SITES_PER_CHUNK;
+
+    using Chunk = std::array<std::atomic<LogSite*>, SITES_PER_CHUNK>;
+
+    /** chunks are allocated on demand and never freed, so readers only need
+     * the acquire loads to find a published site.
+     */
+    struct Registry
+    {
+        std::mutex mutex;
+        std::atomic<uint32_t> count { 0 };
+        std::array<std::atomic<Chunk*>, MAX_CHUNKS> chunks {};
+
+        // in the order they were set, the last matching one wins
+        std::vector<std::pair<std::string, SiteState>> patterns;
+    };
+
+    Registry& registry()
+    {
+        static Registry r;
+        return r;
+    }
+
+    /** glob match, '*' matches any sequence and '?' any single character */
+    bool glob_match(std::string_view pattern, std::string_view text)
+    {
+        size_t p = 0;
+        size_t t = 0;
+        // where to resume after the last '*' if the rest does not match
+        size_t star = std::string_view::npos;
+        size_t star_text = 0;
+        while (t < text.size())
+        {
+            if (p < pattern.size() &&
+                (pattern[p] == '?' || pattern[p] == text[t]))
+            {
+                p++;
+                t++;
+            }
+            else if (p < pattern.size() && pattern[p] == '*')
+            {
+                star = p++;
+                star_text = t;
+            }
+            else if (star != std::string_view::npos)
+            {
+                p = star + 1;
+                t = ++star_text;
+            }
+            else
+            {
+                return false;
+            }
+        }
+        while (p < pattern.size() && pattern[p] == '*')
+        {
+            p++;
+        }
+        return p == pattern.size();
+    }
+
+    /** the site's state according to the patterns, called with the mutex
+     * held.
+     */
+    SiteState state_for(const Registry& r, const LogSite& site)
+    {
+        for (auto it = r.patterns.rbegin(); it != r.patterns.rend(); ++it)
+        {
+            if (log_site_matches(it->first, site))
+            {
+                return it->second;
+            }
+        }
+        return SiteState::DEFAULT;
+    }
+
+    template<typename F> void for_each_site(const Registry& r, F&& f)
+    {
+        const auto count = r.count.load(std::memory_order_relaxed);
+        for (uint32_t id = 0; id < count; id++)
+        {
+            auto* chunk =
+                r.chunks[id / SITES_PER_CHUNK].load(std::memory_order_relaxed);
+            f(*(*chunk)[id % SITES_PER_CHUNK].load(std::memory_order_relaxed));
+        }
+    }
+
+    uint32_t set_log_sites(std::string_view pattern, SiteState state)
+    {
+        auto& r = registry();
+        std::lock_guard<std::mutex> lock(r.mutex);
+        r.patterns.emplace_back(std::string(pattern), state);
+
+        uint32_t matched = 0;
+        for_each_site(r, [&](LogSite& site) {
+            if (log_site_matches(pattern, site))
+            {
+                site.state.store(state, std::memory_order_relaxed);
+                matched++;
+            }
+        });
+        return matched;
+    }
+} // namespace
+
+
+uint32_t register_log_site(LogSite& site)
+{
+    auto& r = registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+
+    // another thread may have registered it while we waited
+    const auto existing = site.id.load(std::memory_order_relaxed);
+    if (existing != UNREGISTERED_LOG_SITE)
+    {
+        return existing;
+    }
+
+    site.state.store(state_for(r, site), std::memory_order_relaxed);
+
+    const auto id = r.count.load(std::memory_order_relaxed);
+    if (id >= MAX_LOG_SITES)
+    {
+        site.id.store(NO_LOG_SITE, std::memory_order_release);
+        return NO_LOG_SITE;
+    }
+
+    auto& chunk = r.chunks[id / SITES_PER_CHUNK];
+    if (chunk.load(std::memory_order_relaxed) == nullptr)
+    {
+        chunk.store(new Chunk(), std::memory_order_release);
+    }
+    (*chunk.load(std::memory_order_relaxed))[id % SITES_PER_CHUNK].store(
+        &site, std::memory_order_release);
+    r.count.store(id + 1, std::memory_order_release);
+    site.id.store(id, std::memory_order_release);
+    return id;
+}
+
+const LogSite* find_log_site(uint32_t id)
+{
+    if (id >= MAX_LOG_SITES)
+    {
+        return nullptr;
+    }
+    const auto* chunk =
+        registry().chunks[id / SITES_PER_CHUNK].load(std::memory_order_acquire);
+    if (chunk == nullptr)
+    {
+        return nullptr;
+    }
+    return (*chunk)[id % SITES_PER_CHUNK].load(std::memory_order_acquire);
+}
+
+uint32_t count_log_sites()
+{
+    return registry().count.load(std::memory_order_acquire);
+}
+
+uint32_t enable_log_sites(std::string_view pattern)
+{
+    return set_log_sites(pattern, SiteState::ENABLED);
+}
+
+uint32_t disable_log_sites(std::string_view pattern)
+{
+    return set_log_sites(pattern, SiteState::DISABLED);
+}
+
+void reset_log_sites()
+{
+    auto& r = registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    r.patterns.clear();
+    for_each_site(r, [](LogSite& site) {
+        site.state.store(SiteState::DEFAULT, std::memory_order_relaxed);
+    });
+}
+
+bool log_site_matches(std::string_view pattern, const LogSite& site)
+{
+    const std::string_view file(site.file);
+    if (pattern.find(':') == std::string_view::npos)
+    {
+        return glob_match(pattern, file);
+    }
+    const auto with_line = std::string(file) + ':' + std::to_string(site.line);
+    return glob_match(pattern, with_line);
+}
+
+} // namespace logging
@@ -1,15 +1,25 @@
+#include <algorithm>
+#include <atomic>
 #include <cassert>
 #include <cstdint>
-#include <cstring>
-#include <ctime>
+#include <format>
 #include <stdarg.h>
 #include <stdio.h>
 #include <string>
+#include <string_view>
+#include <utility>
 
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <slogger/DefaultClockTimer.hpp>
 #include <slogger/Error.hpp>
+#include <slogger/FdSink.hpp>
 #include <slogger/Logger.hpp>
+#include <slogger/ThreadBuffers.hpp>
 
-static constexpr auto MAX_STEAL_LOGS_AT_A_TIME = 4;
+// per round of the drain thread, the sink is polled in between
+static constexpr auto DRAIN_THREAD_BUDGET = 256;
 
 
 namespace error
@@ -65,109 +75,270 @@ namespace logging
 {
 namespace
 {
-    int count_loggers = 0;
-}
+    /** the thread buffers are process wide, their entries do not say which
+     * logger they were meant for
+     */
+    std::atomic<int> count_buffer_loggers = 0;
+
+    void register_mode(LogMode mode, int delta)
+    {
+        if (mode == LogMode::THREAD_LOCAL_BUFFERS)
+        {
+            [[maybe_unused]] const int count =
+                count_buffer_loggers.fetch_add(delta) + delta;
+            assert(count <= 1);
+        }
+    }
+
+    time_utils::DefaultClockTimer steady_timer;
+} // namespace
 
 DirectConsoleLogger::DirectConsoleLogger(
-    bool debug, bool info, LogOutput output)
+    bool debug, bool info, LogOutput output, LogMode mode)
     : ILogger(debug, info)
-    , m_output(output)
+    , m_mode(mode)
+    , m_poll_timer(&steady_timer)
 {
-    count_loggers++;
-    assert(count_loggers == 1);
+    register_mode(mode, 1);
 
     switch (output)
     {
-    case LogOutput::CONSOLE:
-        m_f = stdout;
+    case LogOutput::CONSOLE: {
+        FdSinkConfig cfg;
+        if (mode == LogMode::DIRECT)
+        {
+            // nobody polls, lines must show up right away
+            cfg.max_latency = std::chrono::nanoseconds(0);
+        }
+        m_sink = std::make_unique<FdSink>(STDOUT_FILENO, false, cfg);
         break;
+    }
 
     case LogOutput::FILE_STREAM: {
         const char* filename = "/var/log/slogger.log";
-        m_f = fopen(filename, "w");
-        assert(m_f != nullptr);
+        const int fd =
+            open(filename, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+        assert(fd >= 0);
+        m_sink = std::make_unique<FdSink>(fd, true);
         LOG_INFO((*this), "logging to {}", filename);
         break;
     }
     }
 }
 
+DirectConsoleLogger::DirectConsoleLogger(
+    bool debug, bool info, std::unique_ptr<ISink> sink, LogMode mode)
+    : ILogger(debug, info)
+    , m_mode(mode)
+    , m_sink(std::move(sink))
+    , m_sink_args(m_sink->wants_args())
+    , m_poll_timer(&steady_timer)
+{
+    register_mode(mode, 1);
+}
+
 DirectConsoleLogger::~DirectConsoleLogger()
 {
-    count_loggers--;
+    register_mode(m_mode, -1);
+    stop_drain_thread();
 
-    switch (m_output)
+    // including the entries the scheduler has taken ahead or holds back
+    drain(UINT32_MAX);
+    m_scheduler.flush(
+        m_sink_args, [this](const LogEntry& elt) { write(elt); });
+
+    m_coalescer.flush(line_writer());
+    // flushes, and closes the file
+    m_sink.reset();
+}
+
+void DirectConsoleLogger::log(
+    uint32_t line, const char* file, Level level, const std::string& msg)
+{
+    switch (m_mode)
     {
-    case LogOutput::CONSOLE:
+    case LogMode::DIRECT:
+        write(line, file, level, msg, now_ticks());
         break;
-    case LogOutput::FILE_STREAM:
-        fclose(m_f);
+    case LogMode::THREAD_LOCAL_BUFFERS:
+    {
+        // dropped if the thread's buffer is full
+        bool was_empty = false;
+        if (ThreadBufferRegistry::instance().local_buffer().ring.add(
+                LogEntry { line, file, level, msg, NO_LOG_SITE, false,
+                    now_ticks() },
+                was_empty) &&
+            was_empty)
+        {
+            notify_drain();
+        }
         break;
     }
+    }
 }
 
-void DirectConsoleLogger::log(
-    uint32_t line, const char* file, Level level, const std::string& msg)
+void DirectConsoleLogger::log_site(LogSite& site, const std::string& msg)
 {
-    const char* level_str = "";
-    switch (level)
+    switch (m_mode)
     {
-    case Level::DEBUG:
-        level_str = "DEBUG";
-        break;
-    case Level::INFO:
-        level_str = "INFO";
+    case LogMode::DIRECT:
+        write(site.line, site.file, site.level, msg, now_ticks(),
+            site.get_id());
         break;
-    case Level::ERROR:
-        level_str = "ERROR";
+    case LogMode::THREAD_LOCAL_BUFFERS:
+    {
+        bool was_empty = false;
+        if (ThreadBufferRegistry::instance().local_buffer().ring.add(
+                LogEntry { site.line, site.file, site.level, msg,
+                    site.get_id(), false, now_ticks() },
+                was_empty) &&
+            was_empty)
+        {
+            notify_drain();
+        }
         break;
     }
+    }
+}
+
+void DirectConsoleLogger::log_deferred(LogSite& site, const DeferredArgs& args)
+{
+    const auto id = site.get_id();
+    if (!m_sink_args || m_mode != LogMode::DIRECT || id == NO_LOG_SITE)
+    {
+        ILogger::log_deferred(site, args);
+        return;
+    }
+    thread_local std::string captured;
+    captured.resize(args.size);
+    args.encode(reinterpret_cast<std::byte*>(captured.data()), args.args);
+    write(site.line, site.file, site.level, captured, now_ticks(), id, true);
+}
 
-    std::time_t time = std::time({});
-    char timeString[128];
-    std::strftime(
-        std::data(timeString), std::size(timeString), "%T", std::gmtime(&time));
+void DirectConsoleLogger::write(uint32_t line, const char* file, Level level,
+    std::string_view msg, uint64_t ticks, uint32_t site_id, bool args)
+{
+    // entries from before timestamps were captured get the time of writing
+    const auto time = time_utils::TscTimer::instance().to_wall_ns(
+        ticks != 0 ? ticks : now_ticks());
 
-    auto s = std::format(
-        "{}:{}: [{}] {} - {}\n", file, line, timeString, level_str, msg);
-    fprintf(m_f, "%s", s.c_str());
+    std::lock_guard<std::mutex> lock(m_write_mutex);
+    m_coalescer.add(
+        SinkRecord { line, file, level, msg, time, site_id, args },
+        line_writer());
+    if (m_mode == LogMode::DIRECT)
+    {
+        m_sink->poll(time);
+    }
+}
 
-    if (level == Level::ERROR)
+void DirectConsoleLogger::poll()
+{
+    if (m_drain_thread)
     {
-        fflush(m_f);
+        return;
     }
+    drain(m_poll_budget);
 }
 
+uint32_t DirectConsoleLogger::drain(uint32_t budget)
+{
+    return drain(budget, [] { return false; });
+}
 
-void DirectConsoleLogger::poll()
+PollResult DirectConsoleLogger::poll(std::chrono::microseconds budget)
 {
-    uint32_t count = 0;
-    for (const auto& v : m_poll_loggers)
+    if (m_drain_thread)
     {
-        while (auto elt = v->remove())
+        return {};
+    }
+    time_utils::Timeout timeout(*m_poll_timer, budget);
+    uint32_t until_check = POLL_TIME_CHECK_INTERVAL;
+    PollResult result;
+    result.written = drain(UINT32_MAX, [&] {
+        if (--until_check != 0)
         {
-            log(elt->line, elt->file, elt->level, elt->msg);
-            count++;
-            if (count > MAX_STEAL_LOGS_AT_A_TIME)
-            {
-                break;
-            }
+            return false;
         }
+        until_check = POLL_TIME_CHECK_INTERVAL;
+        return timeout.elapsed();
+    });
+    result.remaining = m_scheduler.pending();
+    if (m_mode == LogMode::THREAD_LOCAL_BUFFERS)
+    {
+        result.remaining += ThreadBufferRegistry::instance().pending();
     }
+    return result;
 }
 
-const char* strip_prefix(const char* path)
+template<typename S>
+uint32_t DirectConsoleLogger::drain(uint32_t budget, S&& stop)
 {
-    if (const char* src = strstr(path, "src/"))
+    const auto writer = [this](const LogEntry& elt) { write(elt); };
+    uint32_t count = 0;
+    bool stopped = false;
+    const auto remembering_stop = [&] { return stopped = stop(); };
+    if (m_mode == LogMode::THREAD_LOCAL_BUFFERS)
     {
-        return src;
+        // up to half, so busy loggers cannot starve the thread buffers
+        count = ThreadBufferRegistry::instance().drain(
+            std::min(budget, std::max(budget / 2, 1U)), writer,
+            remembering_stop);
     }
+    if (!stopped && budget > count)
+    {
+        count += m_scheduler.drain(
+            budget - count, m_sink_args, writer, remembering_stop);
+    }
+    report_suppressed();
+
+    const auto& tsc = time_utils::TscTimer::instance();
+    tsc.update_wall_offset();
+    const auto now = tsc.to_wall_ns(now_ticks());
+    std::lock_guard<std::mutex> lock(m_write_mutex);
+    m_coalescer.flush_expired(now, line_writer());
+    m_sink->poll(now);
+    return count;
+}
 
-    if (const char* src = strstr(path, "include/"))
+void DirectConsoleLogger::report_suppressed()
+{
+    auto* limiter = tracked_rate_limiters();
+    if (limiter == nullptr)
     {
-        return src;
+        return;
     }
+    const auto now = rate_limit_timer().get_time_ns().count();
+    for (; limiter != nullptr; limiter = limiter->next())
+    {
+        if (limiter->logger() != this &&
+            !m_scheduler.has_source(limiter->logger()))
+        {
+            continue;
+        }
+        if (const auto count = limiter->take_suppressed(now))
+        {
+            const auto& site = *limiter->site();
+            write(site.line, site.file, site.level,
+                std::format("{} messages suppressed", count), now_ticks());
+        }
+    }
+}
+
+error::Error DirectConsoleLogger::start_drain_thread(
+    const DrainThreadConfig& cfg)
+{
+    if (m_drain_thread)
+    {
+        return error::Error::BUSY;
+    }
+    m_drain_thread = std::make_unique<DrainThread>(
+        [this] { return drain(DRAIN_THREAD_BUDGET); }, cfg);
+    return m_drain_thread->setup_error();
+}
 
-    return path;
+void DirectConsoleLogger::stop_drain_thread()
+{
+    m_drain_thread.reset();
 }
 } // namespace logging
\ No newline at end of file
@@ -0,0 +1,182 @@
+#include <algorithm>
+#include <cstring>
+
+#include <slogger/Lz.hpp>
+
+
+namespace logging
+{
+namespace lz
+{
+    namespace
+    {
+        constexpr uint32_t HASH_BITS = 14;
+
+        uint32_t read32(const char* p)
+        {
+            uint32_t v;
+            std::memcpy(&v, p, sizeof(v));
+            return v;
+        }
+
+        uint32_t hash(uint32_t v)
+        {
+            return (v * 2654435761U) >> (32 - HASH_BITS);
+        }
+
+        char* put_length(char* op, size_t len)
+        {
+            while (len >= 255)
+            {
+                *op++ = static_cast<char>(255);
+                len -= 255;
+            }
+            *op++ = static_cast<char>(len);
+            return op;
+        }
+
+        char* put_sequence(char* op, const char* literals, size_t literal_len,
+            size_t offset, size_t match_len)
+        {
+            char* token = op++;
+            const size_t ml = match_len == 0 ? 0 : match_len - MIN_MATCH;
+            *token = static_cast<char>(
+                (std::min<size_t>(literal_len, 15) << 4) |
+                std::min<size_t>(ml, 15));
+            if (literal_len >= 15)
+            {
+                op = put_length(op, literal_len - 15);
+            }
+            std::memcpy(op, literals, literal_len);
+            op += literal_len;
+            if (match_len == 0)
+            {
+                return op;
+            }
+            *op++ = static_cast<char>(offset & 0xff);
+            *op++ = static_cast<char>(offset >> 8);
+            if (ml >= 15)
+            {
+                op = put_length(op, ml - 15);
+            }
+            return op;
+        }
+
+        /** @returns false if the length runs past end */
+        bool get_length(const unsigned char*& ip, const unsigned char* end,
+            size_t& len)
+        {
+            while (true)
+            {
+                if (ip == end)
+                {
+                    return false;
+                }
+                const auto b = *ip++;
+                len += b;
+                if (b != 255)
+                {
+                    return true;
+                }
+            }
+        }
+    } // namespace
+
+
+    size_t compress(const char* src, size_t size, char* dst)
+    {
+        uint32_t table[1U << HASH_BITS] = {};
+        char* op = dst;
+        size_t anchor = 0;
+        size_t ip = 0;
+        while (size >= MIN_MATCH && ip <= size - MIN_MATCH)
+        {
+            const auto seq = read32(src + ip);
+            const auto h = hash(seq);
+            const size_t ref = table[h];
+            table[h] = static_cast<uint32_t>(ip);
+
+            if (ref >= ip || ip - ref > MAX_OFFSET || read32(src + ref) != seq)
+            {
+                // skip faster through data that does not compress
+                ip += 1 + ((ip - anchor) >> 6);
+                continue;
+            }
+
+            size_t len = MIN_MATCH;
+            while (ip + len < size && src[ref + len] == src[ip + len])
+            {
+                len++;
+            }
+            op = put_sequence(op, src + anchor, ip - anchor, ip - ref, len);
+            ip += len;
+            anchor = ip;
+        }
+        if (anchor < size)
+        {
+            op = put_sequence(op, src + anchor, size - anchor, 0, 0);
+        }
+        return op - dst;
+    }
+
+    bool decompress(const char* src, size_t src_size, char* dst, size_t size)
+    {
+        auto ip = reinterpret_cast<const unsigned char*>(src);
+        const auto end = ip + src_size;
+        size_t op = 0;
+        while (ip < end)
+        {
+            const auto token = *ip++;
+            size_t literal_len = token >> 4;
+            if (literal_len == 15 && !get_length(ip, end, literal_len))
+            {
+                return false;
+            }
+            if (literal_len > static_cast<size_t>(end - ip) ||
+                literal_len > size - op)
+            {
+                return false;
+            }
+            std::memcpy(dst + op, ip, literal_len);
+            ip += literal_len;
+            op += literal_len;
+            if (ip == end)
+            {
+                break;
+            }
+
+            if (end - ip < 2)
+            {
+                return false;
+            }
+            const size_t offset = ip[0] | (ip[1] << 8);
+            ip += 2;
+            size_t match_len = token & 15;
+            if (match_len == 15 && !get_length(ip, end, match_len))
+            {
+                return false;
+            }
+            match_len += MIN_MATCH;
+            if (offset == 0 || offset > op || match_len > size - op)
+            {
+                return false;
+            }
+            const char* from = dst + op - offset;
+            if (offset >= match_len)
+            {
+                std::memcpy(dst + op, from, match_len);
+            }
+            else
+            {
+                // byte by byte: the match overlaps what it produces
+                for (size_t i = 0; i < match_len; i++)
+                {
+                    dst[op + i] = from[i];
+                }
+            }
+            op += match_len;
+        }
+        return op == size;
+    }
+} // namespace lz
+} // namespace logging
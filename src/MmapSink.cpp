@@ -0,0 +1,193 @@
+#include <cerrno>
+#include <cstring>
+#include <format>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <slogger/MmapSink.hpp>
+
+
+namespace logging
+{
+namespace
+{
+    uint64_t page_size()
+    {
+        static const uint64_t size = sysconf(_SC_PAGESIZE);
+        return size;
+    }
+} // namespace
+
+
+MmapSink::MmapSink(const MmapSinkConfig& cfg)
+    : m_cfg(cfg)
+{
+    m_line.reserve(4096);
+    uint32_t lowest = 0;
+    uint32_t highest = 0;
+    if (find_numbered_files(m_cfg.path, lowest, highest))
+    {
+        m_segment = highest + 1;
+    }
+    open_segment();
+}
+
+MmapSink::~MmapSink()
+{
+    close_segment();
+}
+
+std::string MmapSink::segment_path(uint32_t index) const
+{
+    return std::format("{}.{:06}", m_cfg.path, index);
+}
+
+void MmapSink::open_segment()
+{
+    auto path = segment_path(m_segment);
+    // never overwrite the segments of an earlier run
+    m_fd = open(path.c_str(), O_RDWR | O_CREAT | O_EXCL | O_CLOEXEC, 0644);
+    while (m_fd < 0 && errno == EEXIST)
+    {
+        path = segment_path(++m_segment);
+        m_fd = open(path.c_str(), O_RDWR | O_CREAT | O_EXCL | O_CLOEXEC, 0644);
+    }
+    if (m_fd < 0)
+    {
+        m_status = error::errno_to_error(errno);
+        return;
+    }
+    // reserve the blocks now, so the page faults never wait for allocation
+    if (const int err = posix_fallocate(m_fd, 0, m_cfg.segment_size))
+    {
+        m_status = error::errno_to_error(err);
+        close(m_fd);
+        m_fd = -1;
+        // no empty file per attempt, the retry creates it again
+        unlink(path.c_str());
+        return;
+    }
+    void* p = mmap(nullptr, m_cfg.segment_size, PROT_READ | PROT_WRITE,
+        MAP_SHARED, m_fd, 0);
+    if (p == MAP_FAILED)
+    {
+        m_status = error::errno_to_error(errno);
+        close(m_fd);
+        m_fd = -1;
+        unlink(path.c_str());
+        return;
+    }
+    m_map = static_cast<char*>(p);
+    if (m_cfg.madvise)
+    {
+        ::madvise(m_map, m_cfg.segment_size, MADV_SEQUENTIAL);
+    }
+    m_pos = 0;
+    m_synced = 0;
+    m_status = error::Error::OK;
+}
+
+void MmapSink::close_segment()
+{
+    if (m_map == nullptr)
+    {
+        return;
+    }
+    switch (m_cfg.msync)
+    {
+    case MsyncPolicy::NONE:
+        break;
+    case MsyncPolicy::ASYNC_ON_ROLL:
+    case MsyncPolicy::ASYNC_ON_FLUSH:
+        msync(m_map, m_pos, MS_ASYNC);
+        break;
+    case MsyncPolicy::SYNC_ON_ROLL:
+        msync(m_map, m_pos, MS_SYNC);
+        break;
+    }
+    if (m_cfg.madvise)
+    {
+        ::madvise(m_map, m_cfg.segment_size, MADV_DONTNEED);
+    }
+    munmap(m_map, m_cfg.segment_size);
+    m_map = nullptr;
+
+    // drop the preallocated tail
+    if (ftruncate(m_fd, m_pos) != 0)
+    {
+        m_status = error::errno_to_error(errno);
+    }
+    close(m_fd);
+    m_fd = -1;
+}
+
+void MmapSink::write(const SinkRecord& rec)
+{
+    m_line.clear();
+    append_text_line(m_line, rec);
+    if (m_line.size() > m_cfg.segment_size)
+    {
+        // would not fit into any segment
+        m_dropped++;
+        return;
+    }
+
+    if (m_map != nullptr && m_pos + m_line.size() > m_cfg.segment_size)
+    {
+        close_segment();
+        m_segment++;
+        open_segment();
+    }
+    if (m_map == nullptr)
+    {
+        // poll() retries creating the segment
+        m_dropped++;
+        return;
+    }
+
+    std::memcpy(m_map + m_pos, m_line.data(), m_line.size());
+    m_pos += m_line.size();
+}
+
+void MmapSink::poll(std::chrono::nanoseconds now)
+{
+    if (m_map != nullptr)
+    {
+        // the logger polls after every batch, it does not flush
+        sync_written();
+        return;
+    }
+    if (now < m_retry_at)
+    {
+        return;
+    }
+    open_segment();
+    if (m_map == nullptr)
+    {
+        m_retry_at = now + OPEN_RETRY_INTERVAL;
+    }
+}
+
+void MmapSink::flush()
+{
+    sync_written();
+}
+
+void MmapSink::sync_written()
+{
+    if (m_map == nullptr || m_cfg.msync != MsyncPolicy::ASYNC_ON_FLUSH)
+    {
+        return;
+    }
+    // msync wants a page aligned start
+    const auto from = m_synced & ~(page_size() - 1);
+    if (m_pos > from)
+    {
+        msync(m_map + from, m_pos - from, MS_ASYNC);
+        m_synced = m_pos;
+    }
+}
+
+} // namespace logging
@@ -0,0 +1,52 @@
+#include <atomic>
+
+#include <slogger/DefaultClockTimer.hpp>
+#include <slogger/RateLimit.hpp>
+
+
+namespace logging
+{
+namespace
+{
+    std::atomic<time_utils::ITimer*>& current_timer()
+    {
+        static time_utils::DefaultClockTimer default_timer;
+        static std::atomic<time_utils::ITimer*> timer { &default_timer };
+        return timer;
+    }
+
+    std::atomic<RateLimiter*> g_tracked_limiters { nullptr };
+} // namespace
+
+
+time_utils::ITimer& rate_limit_timer()
+{
+    return *current_timer().load(std::memory_order_acquire);
+}
+
+void set_rate_limit_timer(time_utils::ITimer& timer)
+{
+    current_timer().store(&timer, std::memory_order_release);
+}
+
+void RateLimiter::track_slow(const LogSite& site, const ILogger& logger)
+{
+    if (m_tracked.exchange(true, std::memory_order_relaxed))
+    {
+        return;
+    }
+    m_site = &site;
+    m_logger = &logger;
+    m_next = g_tracked_limiters.load(std::memory_order_relaxed);
+    while (!g_tracked_limiters.compare_exchange_weak(m_next, this,
+        std::memory_order_release, std::memory_order_relaxed))
+    {
+    }
+}
+
+RateLimiter* tracked_rate_limiters()
+{
+    return g_tracked_limiters.load(std::memory_order_acquire);
+}
+
+} // namespace logging
@@ -0,0 +1,263 @@
+#include <cerrno>
+#include <filesystem>
+#include <format>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <slogger/RotatingFileSink.hpp>
+
+
+namespace logging
+{
+namespace
+{
+    /** the helper also looks for work this often, in case poll() is not
+     * called
+     */
+    constexpr std::chrono::milliseconds HELPER_PERIOD { 100 };
+
+    bool is_empty_file(const std::string& path)
+    {
+        std::error_code ec;
+        return std::filesystem::file_size(path, ec) == 0 && !ec;
+    }
+} // namespace
+
+
+RotatingFileSink::RotatingFileSink(
+    const RotatingFileConfig& cfg, Factory factory)
+    : m_cfg(cfg)
+    , m_factory(factory ? std::move(factory)
+                        : [](int fd, const FdSinkConfig& sink_cfg) {
+                              return std::make_unique<FdSink>(
+                                  fd, true, sink_cfg);
+                          })
+{
+    uint32_t lowest = 0;
+    uint32_t highest = 0;
+    if (find_numbered_files(m_cfg.path, lowest, highest))
+    {
+        m_oldest = lowest;
+        m_index = highest + 1;
+        // remove the files a crashed run had opened but not written, the
+        // next one the helper had prepared in particular, and reuse their
+        // numbers
+        while (m_index > m_oldest && is_empty_file(file_path(m_index - 1)))
+        {
+            unlink(file_path(--m_index).c_str());
+        }
+    }
+    else
+    {
+        m_oldest = m_index;
+    }
+
+    const int fd = open_file(m_index);
+    if (fd >= 0)
+    {
+        m_current = m_factory(fd, m_cfg.sink);
+    }
+    m_thread = std::thread([this] { run(); });
+}
+
+RotatingFileSink::~RotatingFileSink()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_cond.notify_one();
+    m_thread.join();
+
+    m_current.reset();
+    m_retired.clear();
+    if (m_next)
+    {
+        // prepared but never written
+        m_next.reset();
+        unlink(file_path(m_index + 1).c_str());
+    }
+}
+
+std::string RotatingFileSink::file_path(uint32_t index) const
+{
+    return std::format("{}.{:06}", m_cfg.path, index);
+}
+
+error::Error RotatingFileSink::status() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_status;
+}
+
+bool RotatingFileSink::next_file_ready() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_next != nullptr;
+}
+
+int RotatingFileSink::open_file(uint32_t index)
+{
+    const auto path = file_path(index);
+    const int fd =
+        open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0)
+    {
+        const auto err = error::errno_to_error(errno);
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_status = err;
+    }
+    return fd;
+}
+
+bool RotatingFileSink::wants_args() const
+{
+    return m_current && m_current->wants_args();
+}
+
+bool RotatingFileSink::writes_text() const
+{
+    return m_current && m_current->writes_text();
+}
+
+bool RotatingFileSink::rotation_due(const SinkRecord& rec) const
+{
+    if (m_cfg.max_bytes != 0 && m_current->bytes() >= m_cfg.max_bytes)
+    {
+        return true;
+    }
+    return m_cfg.interval.count() != 0 && m_next_rotation.count() != 0 &&
+        rec.time >= m_next_rotation;
+}
+
+void RotatingFileSink::schedule_rotation(std::chrono::nanoseconds now)
+{
+    if (m_cfg.interval.count() != 0)
+    {
+        m_next_rotation = (now / m_cfg.interval + 1) * m_cfg.interval;
+    }
+}
+
+void RotatingFileSink::rotate(std::chrono::nanoseconds now)
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    if (!m_next)
+    {
+        m_late_rotations++;
+        if (m_open_failed)
+        {
+            // have the helper try again
+            m_open_failed = false;
+            m_wake_helper = true;
+        }
+        return;
+    }
+    if (m_current)
+    {
+        m_retired.push_back(std::move(m_current));
+    }
+    m_current = std::move(m_next);
+    m_index++;
+    lock.unlock();
+    // not right away: on a busy core the helper would run in our place
+    m_wake_helper = true;
+
+    m_rotations++;
+    schedule_rotation(now);
+}
+
+void RotatingFileSink::write(const SinkRecord& rec)
+{
+    if (!m_current || rotation_due(rec))
+    {
+        rotate(rec.time);
+        if (!m_current)
+        {
+            return;
+        }
+    }
+    if (m_next_rotation.count() == 0)
+    {
+        schedule_rotation(rec.time);
+    }
+    m_current->write(rec);
+}
+
+void RotatingFileSink::wake_helper()
+{
+    if (m_wake_helper)
+    {
+        m_wake_helper = false;
+        m_cond.notify_one();
+    }
+}
+
+void RotatingFileSink::poll(std::chrono::nanoseconds now)
+{
+    if (m_current)
+    {
+        m_current->poll(now);
+    }
+    wake_helper();
+}
+
+void RotatingFileSink::flush()
+{
+    if (m_current)
+    {
+        m_current->flush();
+    }
+    wake_helper();
+}
+
+void RotatingFileSink::run()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (true)
+    {
+        const bool open_next = !m_next && !m_open_failed && !m_stop;
+        const auto next_index = m_index + 1;
+        const auto current_index = m_index;
+        auto retired = std::move(m_retired);
+        m_retired.clear();
+        lock.unlock();
+
+        // flushes the rest and closes
+        retired.clear();
+
+        std::unique_ptr<FdSink> next;
+        if (open_next)
+        {
+            if (const int fd = open_file(next_index); fd >= 0)
+            {
+                next = m_factory(fd, m_cfg.sink);
+            }
+        }
+
+        if (m_cfg.retention != 0)
+        {
+            while (current_index - m_oldest >= m_cfg.retention)
+            {
+                unlink(file_path(m_oldest++).c_str());
+            }
+        }
+
+        lock.lock();
+        if (open_next)
+        {
+            m_open_failed = next == nullptr;
+            m_next = std::move(next);
+        }
+        if (m_stop)
+        {
+            return;
+        }
+        m_cond.wait_for(lock, HELPER_PERIOD, [this] {
+            return m_stop || !m_retired.empty() ||
+                (!m_next && !m_open_failed);
+        });
+    }
+}
+
+} // namespace logging
@@ -0,0 +1,271 @@
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <filesystem>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <slogger/DeferredFormat.hpp>
+#include <slogger/ShmCollector.hpp>
+
+
+namespace logging
+{
+ShmCollector::ShmCollector(
+    std::unique_ptr<ISink> sink, const ShmCollectorConfig& cfg)
+    : m_sink(std::move(sink))
+    , m_cfg(cfg)
+{
+}
+
+ShmCollector::~ShmCollector()
+{
+    flush();
+    for (auto& src : m_sources)
+    {
+        munmap(src->region, sizeof(shm_log::Region));
+    }
+}
+
+error::Error ShmCollector::attach(const std::string& name)
+{
+    for (const auto& src : m_sources)
+    {
+        if (src->name == name)
+        {
+            return error::Error::OK;
+        }
+    }
+    const auto object = shm_log::object_name(name);
+    const int fd = shm_open(object.c_str(), O_RDWR | O_CLOEXEC, 0);
+    if (fd < 0)
+    {
+        return error::errno_to_error(errno);
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 ||
+        static_cast<size_t>(st.st_size) < sizeof(shm_log::Region))
+    {
+        // ftruncate() not done yet, or not a ring
+        close(fd);
+        return error::Error::NOT_READY;
+    }
+    void* p = mmap(nullptr, sizeof(shm_log::Region), PROT_READ | PROT_WRITE,
+        MAP_SHARED, fd, 0);
+    close(fd);
+    if (p == MAP_FAILED)
+    {
+        return error::errno_to_error(errno);
+    }
+    auto* region = static_cast<shm_log::Region*>(p);
+    const auto& hdr = region->header;
+    if (!hdr.ready.load(std::memory_order_acquire))
+    {
+        munmap(p, sizeof(shm_log::Region));
+        return error::Error::NOT_READY;
+    }
+    if (std::memcmp(hdr.magic, shm_log::MAGIC.data(), sizeof(hdr.magic)) !=
+            0 ||
+        hdr.ring_size != shm_log::RING_SIZE)
+    {
+        munmap(p, sizeof(shm_log::Region));
+        return error::Error::BAD_PPROTOCOL;
+    }
+    auto src = std::make_unique<Source>();
+    src->name = name;
+    src->region = region;
+    src->dev = st.st_dev;
+    src->ino = st.st_ino;
+    m_sources.push_back(std::move(src));
+    return error::Error::OK;
+}
+
+uint32_t ShmCollector::attach_all()
+{
+    uint32_t count = 0;
+    std::error_code ec;
+    for (const auto& entry :
+        std::filesystem::directory_iterator(shm_log::SHM_DIR, ec))
+    {
+        const auto file = entry.path().filename().string();
+        if (file.starts_with(shm_log::PREFIX) &&
+            attach(file.substr(shm_log::PREFIX.size())) == error::Error::OK)
+        {
+            count++;
+        }
+    }
+    return count;
+}
+
+uint64_t ShmCollector::dropped() const
+{
+    auto dropped = m_dropped;
+    for (const auto& src : m_sources)
+    {
+        dropped += src->region->header.dropped.load(std::memory_order_relaxed);
+    }
+    return dropped;
+}
+
+void ShmCollector::read(Source& src)
+{
+    constexpr auto HEADER_SIZE = sizeof(shm_log::RecordHeader);
+    auto& ring = src.region->ring;
+    while (true)
+    {
+        const auto rec = ring.peek();
+        if (rec.size() < HEADER_SIZE)
+        {
+            if (!rec.empty())
+            {
+                ring.release();
+                continue;
+            }
+            return;
+        }
+        shm_log::RecordHeader hdr;
+        std::memcpy(&hdr, rec.data(), HEADER_SIZE);
+        const std::string_view body(
+            reinterpret_cast<const char*>(rec.data()) + HEADER_SIZE,
+            rec.size() - HEADER_SIZE);
+        const auto file = body.substr(0, hdr.file_len);
+        const auto payload = body.substr(file.size());
+
+        if (hdr.kind == shm_log::Kind::SITE)
+        {
+            src.sites[hdr.site_id] = Site { hdr.line, hdr.level,
+                std::string(file), std::string(payload) };
+        }
+        else if (hdr.site_id == NO_LOG_SITE)
+        {
+            const auto& name = *src.files.emplace(file).first;
+            src.pending.push_back(Pending { std::chrono::nanoseconds(hdr.time),
+                hdr.line, hdr.level, name.c_str(), std::string(payload) });
+        }
+        else if (const auto it = src.sites.find(hdr.site_id);
+                 it != src.sites.end())
+        {
+            const auto& site = it->second;
+            src.pending.push_back(Pending { std::chrono::nanoseconds(hdr.time),
+                site.line, site.level, site.file.c_str(),
+                hdr.kind == shm_log::Kind::ARGS
+                    ? format_deferred(site.fmt,
+                          std::as_bytes(std::span(payload)))
+                    : std::string(payload) });
+        }
+        else
+        {
+            // its SITE record was dropped
+            src.pending.push_back(Pending { std::chrono::nanoseconds(hdr.time),
+                0, Level::ERROR, "<unknown log site>", std::string() });
+        }
+        ring.release();
+    }
+}
+
+uint32_t ShmCollector::merge(std::chrono::nanoseconds now)
+{
+    uint32_t count = 0;
+    while (true)
+    {
+        Source* oldest = nullptr;
+        bool all_pending = true;
+        for (auto& src : m_sources)
+        {
+            if (src->pending.empty())
+            {
+                all_pending = false;
+            }
+            else if (oldest == nullptr ||
+                src->pending.front().time < oldest->pending.front().time)
+            {
+                oldest = src.get();
+            }
+        }
+        if (oldest == nullptr)
+        {
+            break;
+        }
+        const auto& rec = oldest->pending.front();
+        if (now.count() != 0 && !all_pending &&
+            rec.time > now - m_cfg.reorder_window)
+        {
+            break;
+        }
+        m_sink->write(
+            SinkRecord { rec.line, rec.file, rec.level, rec.msg, rec.time });
+        oldest->pending.pop_front();
+        count++;
+    }
+    m_records += count;
+    return count;
+}
+
+uint32_t ShmCollector::poll(std::chrono::nanoseconds now)
+{
+    for (auto& src : m_sources)
+    {
+        read(*src);
+    }
+    const auto count = merge(now);
+    m_sink->poll(now);
+
+    // closed is checked before reading, so nothing published before it is
+    // left in the ring
+    std::erase_if(m_sources, [&](const std::unique_ptr<Source>& src) {
+        const auto& hdr = src->region->header;
+        // a producer in another pid namespace cannot be checked with kill()
+        const auto heartbeat = std::chrono::nanoseconds(
+            hdr.heartbeat.load(std::memory_order_relaxed));
+        if (!hdr.closed.load(std::memory_order_acquire) &&
+            now - heartbeat <= m_cfg.producer_timeout)
+        {
+            return false;
+        }
+        read(*src);
+        if (!src->pending.empty())
+        {
+            return false;
+        }
+        detach(*src);
+        return true;
+    });
+    return count;
+}
+
+void ShmCollector::flush()
+{
+    for (auto& src : m_sources)
+    {
+        read(*src);
+    }
+    merge(std::chrono::nanoseconds(0));
+    m_sink->flush();
+}
+
+void ShmCollector::detach(Source& src)
+{
+    m_dropped += src.region->header.dropped.load(std::memory_order_relaxed);
+    munmap(src.region, sizeof(shm_log::Region));
+
+    // ShmSink replaces a ring of the same name, that one is not ours
+    const auto object = shm_log::object_name(src.name);
+    const int fd = shm_open(object.c_str(), O_RDONLY | O_CLOEXEC, 0);
+    if (fd < 0)
+    {
+        return;
+    }
+    struct stat st;
+    const bool same = fstat(fd, &st) == 0 && st.st_dev == src.dev &&
+        st.st_ino == src.ino;
+    close(fd);
+    if (same)
+    {
+        shm_unlink(object.c_str());
+    }
+}
+
+} // namespace logging
@@ -0,0 +1,221 @@
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <format>
+#include <fstream>
+#include <new>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <slogger/ShmSink.hpp>
+
+
+namespace logging
+{
+namespace shm_log
+{
+    std::string default_name()
+    {
+        std::string comm;
+        std::ifstream("/proc/self/comm") >> comm;
+        if (comm.empty())
+        {
+            comm = "process";
+        }
+        return std::format("{}.{}", comm, getpid());
+    }
+} // namespace shm_log
+
+namespace
+{
+    std::chrono::nanoseconds wall_clock()
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::system_clock::now().time_since_epoch());
+    }
+
+    /** @returns true if object is the ring of a live producer: neither
+     * closed nor without heartbeat for producer_timeout, the same rule the
+     * collector removes rings by
+     */
+    bool in_use(
+        const std::string& object, std::chrono::nanoseconds producer_timeout)
+    {
+        const int fd = shm_open(object.c_str(), O_RDONLY | O_CLOEXEC, 0);
+        if (fd < 0)
+        {
+            return false;
+        }
+        bool live = false;
+        struct stat st;
+        if (fstat(fd, &st) == 0 &&
+            static_cast<size_t>(st.st_size) >= sizeof(shm_log::Header))
+        {
+            void* p = mmap(nullptr, sizeof(shm_log::Header), PROT_READ,
+                MAP_SHARED, fd, 0);
+            if (p != MAP_FAILED)
+            {
+                const auto& hdr = *static_cast<const shm_log::Header*>(p);
+                const auto heartbeat = std::chrono::nanoseconds(
+                    hdr.heartbeat.load(std::memory_order_relaxed));
+                // a ring of another format is taken for stale
+                live = std::memcmp(hdr.magic, shm_log::MAGIC.data(),
+                           sizeof(hdr.magic)) == 0 &&
+                    !hdr.closed.load(std::memory_order_acquire) &&
+                    wall_clock() - heartbeat <= producer_timeout;
+                munmap(p, sizeof(shm_log::Header));
+            }
+        }
+        close(fd);
+        return live;
+    }
+} // namespace
+
+
+ShmSink::ShmSink(
+    const std::string& name, std::chrono::nanoseconds producer_timeout)
+{
+    const auto object = shm_log::object_name(name);
+    if (in_use(object, producer_timeout))
+    {
+        // unlinking it would cut its producer off from the collector
+        m_status = error::Error::BUSY;
+        return;
+    }
+    // a ring left behind by a process of the same name
+    shm_unlink(object.c_str());
+    const int fd =
+        shm_open(object.c_str(), O_RDWR | O_CREAT | O_EXCL | O_CLOEXEC, 0600);
+    if (fd < 0)
+    {
+        m_status = error::errno_to_error(errno);
+        return;
+    }
+    if (ftruncate(fd, sizeof(shm_log::Region)) != 0)
+    {
+        m_status = error::errno_to_error(errno);
+        close(fd);
+        shm_unlink(object.c_str());
+        return;
+    }
+    void* p = mmap(nullptr, sizeof(shm_log::Region), PROT_READ | PROT_WRITE,
+        MAP_SHARED | MAP_POPULATE, fd, 0);
+    close(fd);
+    if (p == MAP_FAILED)
+    {
+        m_status = error::errno_to_error(errno);
+        shm_unlink(object.c_str());
+        return;
+    }
+    m_region = new (p) shm_log::Region;
+    auto& hdr = m_region->header;
+    std::memcpy(hdr.magic, shm_log::MAGIC.data(), sizeof(hdr.magic));
+    hdr.ring_size = shm_log::RING_SIZE;
+    hdr.pid = getpid();
+    hdr.heartbeat.store(wall_clock().count(), std::memory_order_relaxed);
+    hdr.ready.store(true, std::memory_order_release);
+}
+
+ShmSink::~ShmSink()
+{
+    if (m_region != nullptr)
+    {
+        m_region->header.closed.store(true, std::memory_order_release);
+        munmap(m_region, sizeof(shm_log::Region));
+    }
+}
+
+uint64_t ShmSink::dropped() const
+{
+    return m_region != nullptr
+        ? m_region->header.dropped.load(std::memory_order_relaxed)
+        : 0;
+}
+
+void ShmSink::write(const SinkRecord& rec)
+{
+    if (m_region == nullptr)
+    {
+        return;
+    }
+    shm_log::RecordHeader hdr { rec.time.count(), rec.site_id, rec.line,
+        rec.level, 0, rec.args ? shm_log::Kind::ARGS : shm_log::Kind::TEXT };
+    std::string_view file;
+    if (rec.site_id == NO_LOG_SITE)
+    {
+        file = rec.file;
+        hdr.file_len = static_cast<uint16_t>(
+            std::min<size_t>(file.size(), UINT16_MAX));
+        file = file.substr(0, hdr.file_len);
+    }
+    if ((rec.site_id != NO_LOG_SITE && !describe_site(rec.site_id)) ||
+        !publish(hdr, file, rec.msg))
+    {
+        m_region->header.dropped.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void ShmSink::poll(std::chrono::nanoseconds now)
+{
+    if (m_region != nullptr)
+    {
+        m_region->header.heartbeat.store(
+            now.count(), std::memory_order_relaxed);
+    }
+}
+
+bool ShmSink::describe_site(uint32_t site_id)
+{
+    if (site_id < m_sites_sent.size() && m_sites_sent[site_id])
+    {
+        return true;
+    }
+    const auto* site = find_log_site(site_id);
+    if (site == nullptr)
+    {
+        return false;
+    }
+    const std::string_view file = site->file;
+    const shm_log::RecordHeader hdr { 0, site_id, site->line, site->level,
+        static_cast<uint16_t>(std::min<size_t>(file.size(), UINT16_MAX)),
+        shm_log::Kind::SITE };
+    if (!publish(hdr, file.substr(0, hdr.file_len), site->fmt))
+    {
+        return false;
+    }
+    if (site_id >= m_sites_sent.size())
+    {
+        m_sites_sent.resize(site_id + 1);
+    }
+    m_sites_sent[site_id] = true;
+    return true;
+}
+
+bool ShmSink::publish(const shm_log::RecordHeader& hdr,
+    std::string_view first, std::string_view second)
+{
+    constexpr auto HEADER_SIZE = sizeof(shm_log::RecordHeader);
+    constexpr auto MAX_SIZE = shm_log::RecordRing::MAX_RECORD_SIZE;
+    first = first.substr(0, MAX_SIZE - HEADER_SIZE);
+    // messages too large for one record are truncated
+    second = second.substr(0, MAX_SIZE - HEADER_SIZE - first.size());
+
+    auto& ring = m_region->ring;
+    const auto len =
+        static_cast<uint32_t>(HEADER_SIZE + first.size() + second.size());
+    auto* p = ring.reserve(len);
+    if (p == nullptr)
+    {
+        return false;
+    }
+    std::memcpy(p, &hdr, HEADER_SIZE);
+    std::memcpy(p + HEADER_SIZE, first.data(), first.size());
+    std::memcpy(p + HEADER_SIZE + first.size(), second.data(), second.size());
+    ring.commit(len);
+    return true;
+}
+
+} // namespace logging
@@ -0,0 +1,85 @@
+#include <algorithm>
+#include <charconv>
+#include <filesystem>
+
+#include <slogger/ISink.hpp>
+#include <slogger/TimestampFormatter.hpp>
+
+
+namespace logging
+{
+const char* level_name(Level level)
+{
+    switch (level)
+    {
+    case Level::DEBUG:
+        return "DEBUG";
+    case Level::INFO:
+        return "INFO";
+    case Level::ERROR:
+        return "ERROR";
+    }
+    return "";
+}
+
+void append_text_line(std::string& out, const SinkRecord& rec)
+{
+    if (!rec.text.empty())
+    {
+        out.append(rec.text);
+        return;
+    }
+    // one per writing thread, it caches the "HH:MM:SS." of the last record
+    thread_local time_utils::TimestampFormatter timestamp;
+    char line[16];
+    const auto line_len =
+        std::to_chars(line, line + sizeof(line), rec.line).ptr - line;
+
+    out.append(rec.file);
+    out += ':';
+    out.append(line, line_len);
+    out.append(": [");
+    timestamp.append(out, rec.time);
+    out.append("] ");
+    out.append(level_name(rec.level));
+    out.append(" - ");
+    out.append(rec.msg);
+    out += '\n';
+}
+
+bool find_numbered_files(
+    const std::string& path, uint32_t& lowest, uint32_t& highest)
+{
+    const std::filesystem::path p(path);
+    const auto prefix = p.filename().string() + ".";
+    auto dir = p.parent_path();
+    if (dir.empty())
+    {
+        dir = ".";
+    }
+
+    bool found = false;
+    std::error_code ec;
+    for (const auto& entry : std::filesystem::directory_iterator(dir, ec))
+    {
+        const auto name = entry.path().filename().string();
+        if (!name.starts_with(prefix))
+        {
+            continue;
+        }
+        const auto digits = std::string_view(name).substr(prefix.size());
+        uint32_t index = 0;
+        const auto [end, err] = std::from_chars(
+            digits.data(), digits.data() + digits.size(), index);
+        if (err != std::errc() || end != digits.data() + digits.size())
+        {
+            continue;
+        }
+        lowest = found ? std::min(lowest, index) : index;
+        highest = found ? std::max(highest, index) : index;
+        found = true;
+    }
+    return found;
+}
+
+} // namespace logging
@@ -0,0 +1,78 @@
+#include <slogger/ThreadBuffers.hpp>
+
+
+namespace logging
+{
+namespace
+{
+    /** marks the buffer as orphaned when its thread exits, the registry
+     * frees it after draining.
+     */
+    struct LocalBufferHolder
+    {
+        ThreadBuffer* buf = nullptr;
+
+        ~LocalBufferHolder()
+        {
+            if (buf != nullptr)
+            {
+                buf->thread_exited.store(true, std::memory_order_release);
+            }
+        }
+    };
+
+    thread_local LocalBufferHolder t_local_buffer;
+} // namespace
+
+
+ThreadBufferRegistry& ThreadBufferRegistry::instance()
+{
+    // never destroyed: detached threads, and the thread_local holders of
+    // threads exiting after main(), may still use their buffers
+    static auto* registry = new ThreadBufferRegistry();
+    return *registry;
+}
+
+ThreadBuffer& ThreadBufferRegistry::local_buffer()
+{
+    if (t_local_buffer.buf == nullptr)
+    {
+        auto* buf = new ThreadBuffer();
+        buf->next = m_head.load(std::memory_order_relaxed);
+        while (!m_head.compare_exchange_weak(buf->next, buf,
+            std::memory_order_release, std::memory_order_relaxed))
+        {
+        }
+        t_local_buffer.buf = buf;
+    }
+    return *t_local_buffer.buf;
+}
+
+bool ThreadBufferRegistry::unlink(ThreadBuffer* prev, ThreadBuffer* buf)
+{
+    if (prev != nullptr)
+    {
+        // producers only ever touch the head, the rest of the list is ours
+        prev->next = buf->next;
+        return true;
+    }
+
+    // buf is the head: a new thread may be pushing concurrently, if so we
+    // retry on a later drain when buf is no longer the head.
+    ThreadBuffer* expected = buf;
+    return m_head.compare_exchange_strong(expected, buf->next,
+        std::memory_order_acq_rel, std::memory_order_relaxed);
+}
+
+uint32_t ThreadBufferRegistry::count_buffers() const
+{
+    uint32_t count = 0;
+    for (auto* buf = m_head.load(std::memory_order_acquire); buf != nullptr;
+         buf = buf->next)
+    {
+        count++;
+    }
+    return count;
+}
+
+} // namespace logging
@@ -1,8 +1,10 @@
 #include <cctype>
 #include <stdarg.h>
 #include <chrono>
+#include <ctime>
 
 #include <slogger/TimeUtils.hpp>
+#include <slogger/TimestampFormatter.hpp>
 
 namespace time_utils
 {
@@ -42,4 +44,12 @@ namespace time_utils
         }
     }
 
+    std::string format_time_of_day(std::chrono::nanoseconds since_epoch)
+    {
+        TimestampFormatter formatter;
+        std::string out;
+        formatter.append(out, since_epoch);
+        return out;
+    }
+
 } // namespace StringUtils
@@ -0,0 +1,43 @@
+#include <cstdint>
+
+#include <slogger/TimestampFormatter.hpp>
+
+
+namespace time_utils
+{
+namespace
+{
+    void put_2digits(char* dst, int64_t value)
+    {
+        dst[0] = static_cast<char>('0' + value / 10);
+        dst[1] = static_cast<char>('0' + value % 10);
+    }
+} // namespace
+
+
+void TimestampFormatter::update_prefix(int64_t second)
+{
+    constexpr int64_t SECS_PER_DAY = 86400;
+    if (second > 0 && second == m_second + 1 && second % 60 != 0)
+    {
+        // same minute: only the seconds digits change
+        put_2digits(m_prefix + 6, second % 60);
+    }
+    else
+    {
+        auto of_day = second % SECS_PER_DAY;
+        if (of_day < 0)
+        {
+            of_day += SECS_PER_DAY;
+        }
+        put_2digits(m_prefix, of_day / 3600);
+        m_prefix[2] = ':';
+        put_2digits(m_prefix + 3, of_day / 60 % 60);
+        m_prefix[5] = ':';
+        put_2digits(m_prefix + 6, of_day % 60);
+        m_prefix[8] = '.';
+    }
+    m_second = second;
+}
+
+} // namespace time_utils
@@ -0,0 +1,119 @@
+#include <chrono>
+#include <thread>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <cpuid.h>
+#endif
+
+#include <slogger/TscTimer.hpp>
+
+namespace time_utils
+{
+namespace
+{
+    bool has_invariant_counter()
+    {
+#if defined(__x86_64__) || defined(__i386__)
+        unsigned eax, ebx, ecx, edx;
+        if (!__get_cpuid(0x80000007, &eax, &ebx, &ecx, &edx))
+        {
+            return false;
+        }
+        // "invariant TSC": constant rate in all P-, C- and T-states
+        return (edx & (1U << 8)) != 0;
+#elif defined(__aarch64__)
+        // the generic timer's virtual count always runs at a fixed rate
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    int64_t realtime_ns()
+    {
+        struct timespec now;
+        clock_gettime(CLOCK_REALTIME, &now);
+        return (int64_t)now.tv_sec * INT64_C(1000000000) + now.tv_nsec;
+    }
+} // namespace
+
+
+const TscTimer& TscTimer::instance()
+{
+    static const TscTimer timer;
+    return timer;
+}
+
+TscTimer::TscTimer()
+    : m_use_counter(has_invariant_counter())
+    , m_start_ticks(m_use_counter ? read_counter() : 0)
+    , m_start_ns(raw_ns())
+{
+    m_base_ticks = m_start_ticks;
+    m_base_ns = m_start_ns;
+    m_wall_offset_ns.store(realtime_ns() - int64_t(m_start_ns));
+    m_wall_offset_time_ns.store(m_start_ns);
+}
+
+void TscTimer::calibrate() const
+{
+    if (!m_use_counter)
+    {
+        return;
+    }
+    std::call_once(m_calibrated, [this] {
+        const auto elapsed = std::chrono::nanoseconds(raw_ns() - m_start_ns);
+        if (elapsed < CALIBRATION_TIME)
+        {
+            std::this_thread::sleep_for(CALIBRATION_TIME - elapsed);
+        }
+        const auto ticks1 = read_counter();
+        const auto ns1 = raw_ns();
+
+        // otherwise a tick stays a ns from the start
+        if (ticks1 > m_start_ticks && ns1 > m_start_ns)
+        {
+            m_mult = static_cast<uint64_t>(
+                (static_cast<unsigned __int128>(ns1 - m_start_ns)
+                    << MULT_SHIFT) /
+                (ticks1 - m_start_ticks));
+            m_base_ticks = ticks1;
+            m_base_ns = ns1;
+        }
+    });
+}
+
+void TscTimer::update_wall_offset() const
+{
+    const auto raw = raw_ns();
+    const auto last = m_wall_offset_time_ns.load(std::memory_order_relaxed);
+    if (raw - last < uint64_t(std::chrono::nanoseconds(
+                         WALL_OFFSET_UPDATE_INTERVAL).count()))
+    {
+        return;
+    }
+    m_wall_offset_time_ns.store(raw, std::memory_order_relaxed);
+    m_wall_offset_ns.store(
+        realtime_ns() - int64_t(raw_ns()), std::memory_order_relaxed);
+}
+
+std::chrono::nanoseconds TscTimer::to_ns(uint64_t ticks) const
+{
+    if (!m_use_counter)
+    {
+        return std::chrono::nanoseconds(ticks);
+    }
+    calibrate();
+    // ticks from before calibration end up slightly negative relative to it
+    const auto delta = static_cast<__int128>(ticks) - m_base_ticks;
+    return std::chrono::nanoseconds(static_cast<int64_t>(
+        m_base_ns + ((delta * static_cast<__int128>(m_mult)) >> MULT_SHIFT)));
+}
+
+double TscTimer::ticks_per_ns() const
+{
+    calibrate();
+    return double(uint64_t(1) << MULT_SHIFT) / double(m_mult);
+}
+
+} // namespace time_utils
@@ -0,0 +1,418 @@
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+
+#include <fcntl.h>
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include <slogger/UringSink.hpp>
+
+
+namespace logging
+{
+/** the mapped submission and completion queues */
+struct UringSink::Ring
+{
+    int fd = -1;
+
+    void* sq_map = MAP_FAILED;
+    size_t sq_map_size = 0;
+    void* cq_map = MAP_FAILED;
+    size_t cq_map_size = 0;
+    io_uring_sqe* sqes = static_cast<io_uring_sqe*>(MAP_FAILED);
+    size_t sqes_size = 0;
+
+    unsigned* sq_tail = nullptr;
+    unsigned sq_mask = 0;
+    unsigned* sq_array = nullptr;
+
+    unsigned* cq_head = nullptr;
+    unsigned* cq_tail = nullptr;
+    unsigned cq_mask = 0;
+    io_uring_cqe* cqes = nullptr;
+
+    ~Ring()
+    {
+        if (sqes != MAP_FAILED)
+        {
+            munmap(sqes, sqes_size);
+        }
+        if (cq_map != MAP_FAILED && cq_map != sq_map)
+        {
+            munmap(cq_map, cq_map_size);
+        }
+        if (sq_map != MAP_FAILED)
+        {
+            munmap(sq_map, sq_map_size);
+        }
+        if (fd >= 0)
+        {
+            close(fd);
+        }
+    }
+
+    int enter(unsigned to_submit, unsigned min_complete, unsigned flags)
+    {
+        return static_cast<int>(syscall(__NR_io_uring_enter, fd, to_submit,
+            min_complete, flags, nullptr, 0));
+    }
+};
+
+namespace
+{
+    template<typename T> T* at(void* base, uint32_t offset)
+    {
+        return reinterpret_cast<T*>(static_cast<char*>(base) + offset);
+    }
+
+    unsigned load_acquire(unsigned* p)
+    {
+        return std::atomic_ref<unsigned>(*p).load(std::memory_order_acquire);
+    }
+
+    void store_release(unsigned* p, unsigned v)
+    {
+        std::atomic_ref<unsigned>(*p).store(v, std::memory_order_release);
+    }
+
+    /** failed submissions in a row after which write() is used instead */
+    static constexpr uint32_t MAX_SUBMIT_ERRORS = 3;
+
+    bool pwrite_all(int fd, std::string_view data, uint64_t offset)
+    {
+        size_t done = 0;
+        while (done < data.size())
+        {
+            const auto n = ::pwrite(
+                fd, data.data() + done, data.size() - done, offset + done);
+            if (n < 0)
+            {
+                if (errno == EINTR)
+                {
+                    continue;
+                }
+                return false;
+            }
+            done += n;
+        }
+        return true;
+    }
+} // namespace
+
+
+UringSink::UringSink(int fd, bool owned, const UringSinkConfig& cfg)
+    : FdSink(fd, owned, cfg.sink)
+    , m_slot_size(std::max<uint32_t>(cfg.sink.buffer_size, 4096))
+{
+    const auto depth = std::max<uint32_t>(cfg.queue_depth, 1);
+    if (!setup(depth))
+    {
+        m_ring.reset();
+        return;
+    }
+
+    m_slots.resize(depth);
+    std::vector<iovec> iovs(depth);
+    for (uint32_t i = 0; i < depth; i++)
+    {
+        m_slots[i].data = std::make_unique<char[]>(m_slot_size);
+        iovs[i] = { m_slots[i].data.get(), m_slot_size };
+        m_free.push_back(depth - 1 - i);
+    }
+    // without registered buffers plain IORING_OP_WRITE still works
+    m_fixed = syscall(__NR_io_uring_register, m_ring->fd,
+                  IORING_REGISTER_BUFFERS, iovs.data(), depth) == 0;
+
+    const auto flags = fcntl(fd, F_GETFL);
+    const auto pos = lseek(fd, 0, SEEK_CUR);
+    if (pos >= 0 && flags >= 0 && (flags & O_APPEND) == 0)
+    {
+        m_offset = pos;
+    }
+}
+
+UringSink::~UringSink()
+{
+    flush();
+    wait_idle();
+    if (m_ring != nullptr && m_offset >= 0)
+    {
+        // leave the file position after the data, as write() would
+        lseek(fd(), m_offset, SEEK_SET);
+    }
+}
+
+bool UringSink::setup(uint32_t entries)
+{
+    io_uring_params params {};
+    const auto ring_fd = syscall(__NR_io_uring_setup, entries, &params);
+    if (ring_fd < 0)
+    {
+        return false;
+    }
+    m_ring = std::make_unique<Ring>();
+    auto& r = *m_ring;
+    r.fd = static_cast<int>(ring_fd);
+
+    r.sq_map_size = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    r.cq_map_size =
+        params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+    const bool single_map = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+    if (single_map)
+    {
+        r.sq_map_size = r.cq_map_size =
+            std::max(r.sq_map_size, r.cq_map_size);
+    }
+    r.sq_map = mmap(nullptr, r.sq_map_size, PROT_READ | PROT_WRITE,
+        MAP_SHARED | MAP_POPULATE, r.fd, IORING_OFF_SQ_RING);
+    if (r.sq_map == MAP_FAILED)
+    {
+        return false;
+    }
+    r.cq_map = single_map
+        ? r.sq_map
+        : mmap(nullptr, r.cq_map_size, PROT_READ | PROT_WRITE,
+              MAP_SHARED | MAP_POPULATE, r.fd, IORING_OFF_CQ_RING);
+    if (r.cq_map == MAP_FAILED)
+    {
+        return false;
+    }
+    r.sqes_size = params.sq_entries * sizeof(io_uring_sqe);
+    r.sqes = static_cast<io_uring_sqe*>(
+        mmap(nullptr, r.sqes_size, PROT_READ | PROT_WRITE,
+            MAP_SHARED | MAP_POPULATE, r.fd, IORING_OFF_SQES));
+    if (r.sqes == MAP_FAILED)
+    {
+        return false;
+    }
+
+    r.sq_tail = at<unsigned>(r.sq_map, params.sq_off.tail);
+    r.sq_mask = *at<unsigned>(r.sq_map, params.sq_off.ring_mask);
+    r.sq_array = at<unsigned>(r.sq_map, params.sq_off.array);
+    r.cq_head = at<unsigned>(r.cq_map, params.cq_off.head);
+    r.cq_tail = at<unsigned>(r.cq_map, params.cq_off.tail);
+    r.cq_mask = *at<unsigned>(r.cq_map, params.cq_off.ring_mask);
+    r.cqes = at<io_uring_cqe>(r.cq_map, params.cq_off.cqes);
+    return true;
+}
+
+void UringSink::poll(std::chrono::nanoseconds now)
+{
+    if (m_ring != nullptr)
+    {
+        if (m_in_flight != 0)
+        {
+            reap(false);
+        }
+        // writes held back after EAGAIN or a failed submit
+        m_hold_queued = false;
+        submit_queued();
+        if (m_submit_errors >= MAX_SUBMIT_ERRORS)
+        {
+            fall_back();
+        }
+    }
+    FdSink::poll(now);
+}
+
+void UringSink::wait_idle()
+{
+    while (m_ring != nullptr && (m_in_flight != 0 || !m_queued.empty()))
+    {
+        if (m_in_flight == 0)
+        {
+            // held back, nothing would complete
+            write_queued();
+            break;
+        }
+        reap(true);
+    }
+}
+
+void UringSink::write_buffer(std::string& buf)
+{
+    // a batch can be larger than a buffer when a long record ends it
+    size_t pos = 0;
+    while (pos < buf.size())
+    {
+        if (m_ring == nullptr)
+        {
+            // no io_uring, or it kept failing
+            write_all(std::string_view(buf).substr(pos));
+            return;
+        }
+        if (m_in_flight != 0)
+        {
+            reap(false);
+        }
+        while (m_free.empty())
+        {
+            if (m_in_flight == 0)
+            {
+                // the queued writes could not be submitted or hit EAGAIN,
+                // waiting would not free a buffer
+                write_queued();
+                break;
+            }
+            m_waits++;
+            reap(true);
+        }
+        const auto i = m_free.back();
+        m_free.pop_back();
+        auto& slot = m_slots[i];
+        slot.len = static_cast<uint32_t>(
+            std::min<size_t>(buf.size() - pos, m_slot_size));
+        slot.done = 0;
+        std::memcpy(slot.data.get(), buf.data() + pos, slot.len);
+        pos += slot.len;
+        if (m_offset >= 0)
+        {
+            slot.offset = m_offset;
+            m_offset += slot.len;
+        }
+        m_queued.push_back(i);
+        submit_queued();
+        if (m_submit_errors >= MAX_SUBMIT_ERRORS)
+        {
+            fall_back();
+        }
+    }
+}
+
+void UringSink::submit_queued()
+{
+    // without offsets a second write in flight could overtake the first
+    while (!m_hold_queued && !m_queued.empty() &&
+        (m_offset >= 0 || m_in_flight == 0))
+    {
+        if (!submit(m_queued.front()))
+        {
+            // tried again by poll(), or written when a buffer is needed
+            m_hold_queued = true;
+            m_submit_errors++;
+            return;
+        }
+        m_submit_errors = 0;
+        m_queued.erase(m_queued.begin());
+    }
+}
+
+bool UringSink::submit(uint32_t i)
+{
+    auto& r = *m_ring;
+    auto& slot = m_slots[i];
+
+    // the writing thread is the only submitter, the tail is ours
+    const auto tail = *r.sq_tail;
+    const auto index = tail & r.sq_mask;
+    auto& sqe = r.sqes[index];
+    std::memset(&sqe, 0, sizeof(sqe));
+    sqe.opcode = m_fixed ? IORING_OP_WRITE_FIXED : IORING_OP_WRITE;
+    sqe.fd = fd();
+    sqe.addr = reinterpret_cast<uint64_t>(slot.data.get() + slot.done);
+    sqe.len = slot.len - slot.done;
+    sqe.off = m_offset >= 0 ? slot.offset + slot.done : ~0ULL;
+    sqe.buf_index = static_cast<uint16_t>(i);
+    sqe.user_data = i;
+    r.sq_array[index] = index;
+    store_release(r.sq_tail, tail + 1);
+
+    int ret;
+    while ((ret = r.enter(1, 0, 0)) < 0 && errno == EINTR)
+    {
+    }
+    if (ret < 1)
+    {
+        // e.g. EAGAIN or ENOMEM: the kernel did not take the entry, without
+        // SQPOLL nobody else reads the tail, so take it back
+        store_release(r.sq_tail, tail);
+        return false;
+    }
+    m_in_flight++;
+    m_submitted++;
+    return true;
+}
+
+void UringSink::write_queued()
+{
+    for (const auto i : m_queued)
+    {
+        auto& slot = m_slots[i];
+        const std::string_view rest(
+            slot.data.get() + slot.done, slot.len - slot.done);
+        const bool ok = m_offset >= 0
+            ? pwrite_all(fd(), rest, slot.offset + slot.done)
+            : write_all(rest);
+        if (!ok)
+        {
+            m_failed++;
+        }
+        m_free.push_back(i);
+    }
+    m_queued.clear();
+    m_hold_queued = false;
+}
+
+void UringSink::fall_back()
+{
+    // nothing is submitted any more, the writes in flight still complete
+    m_hold_queued = true;
+    while (m_in_flight != 0)
+    {
+        reap(true);
+        m_hold_queued = true;
+    }
+    write_queued();
+    if (m_offset >= 0)
+    {
+        lseek(fd(), m_offset, SEEK_SET);
+    }
+    m_ring.reset();
+}
+
+void UringSink::reap(bool wait)
+{
+    auto& r = *m_ring;
+    if (wait)
+    {
+        r.enter(0, 1, IORING_ENTER_GETEVENTS);
+    }
+    auto head = *r.cq_head;
+    const auto tail = load_acquire(r.cq_tail);
+    for (; head != tail; head++)
+    {
+        const auto& cqe = r.cqes[head & r.cq_mask];
+        const auto i = static_cast<uint32_t>(cqe.user_data);
+        auto& slot = m_slots[i];
+        m_in_flight--;
+        if (cqe.res == -EAGAIN)
+        {
+            // e.g. a full non-blocking pipe: retrying right away would
+            // spin, the next poll() does
+            m_hold_queued = true;
+        }
+        if (cqe.res == -EINTR || cqe.res == -EAGAIN ||
+            (cqe.res > 0 && slot.done + cqe.res < slot.len))
+        {
+            // short write: the rest goes out before anything queued
+            slot.done += std::max(cqe.res, 0);
+            m_queued.insert(m_queued.begin(), i);
+            continue;
+        }
+        if (cqe.res < 0 || (cqe.res == 0 && slot.len != 0))
+        {
+            // nowhere to report it, drop the batch
+            m_failed++;
+        }
+        m_free.push_back(i);
+    }
+    store_release(r.cq_head, head);
+    submit_queued();
+}
+
+} // namespace logging
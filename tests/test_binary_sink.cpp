@@ -0,0 +1,198 @@
+#include <gtest/gtest.h>
+
+#include <slogger/BinaryLog.hpp>
+#include <slogger/BinarySink.hpp>
+#include <slogger/ThreadedLogger.hpp>
+
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+#include <unistd.h>
+
+using namespace std::chrono_literals;
+
+namespace Tests
+{
+
+class TestBinarySink : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        char tmpl[] = "/tmp/slogger_binary_XXXXXX";
+        fd = mkstemp(tmpl);
+        ASSERT_GE(fd, 0);
+        path = tmpl;
+    }
+
+    void TearDown() override
+    {
+        unlink(path.c_str());
+    }
+
+    std::string decoded()
+    {
+        std::ifstream in(path, std::ios::binary);
+        std::stringstream out;
+        status = logging::decode_binary_log(in, out);
+        return out.str();
+    }
+
+    std::string file_contents()
+    {
+        std::ifstream in(path, std::ios::binary);
+        std::stringstream ss;
+        ss << in.rdbuf();
+        return ss.str();
+    }
+
+    static std::string text_of(const logging::SinkRecord& rec)
+    {
+        std::string s;
+        logging::append_text_line(s, rec);
+        return s;
+    }
+
+    int fd = -1;
+    std::string path;
+    error::Error status = error::Error::UNKNOWN;
+};
+
+TEST_F(TestBinarySink, text_records_decode_to_the_text_layout)
+{
+    const logging::SinkRecord records[] = {
+        { 12, "src/a.cpp", logging::Level::INFO, "hello",
+            std::chrono::nanoseconds(1'700'000'000'123'456'789) },
+        { 13, "src/a.cpp", logging::Level::ERROR, "failed",
+            std::chrono::nanoseconds(1'700'000'000'123'456'999) },
+        // earlier than the previous one, merged sources are not ordered
+        { 12, "src/a.cpp", logging::Level::INFO, "again",
+            std::chrono::nanoseconds(1'700'000'000'000'000'000) },
+    };
+    std::string expected;
+    {
+        logging::BinarySink sink(fd, true);
+        for (const auto& rec : records)
+        {
+            sink.write(rec);
+            expected += text_of(rec);
+        }
+    }
+    ASSERT_EQ(decoded(), expected);
+    ASSERT_EQ(status, error::Error::OK);
+}
+
+TEST_F(TestBinarySink, captured_arguments_are_formatted_when_decoding)
+{
+    static constinit logging::LogSite site { "src/b.cpp", 20,
+        logging::Level::INFO, "received {} bytes from {}" };
+    const auto id = site.get_id();
+    ASSERT_NE(id, logging::NO_LOG_SITE);
+
+    const uint32_t bytes = 1234;
+    const char* from = "192.168.1.1";
+    const std::tuple<const uint32_t&, const char* const&> refs(bytes, from);
+    const auto d = logging::make_deferred_args(site.fmt, refs);
+    std::string captured(d.size, '\0');
+    d.encode(reinterpret_cast<std::byte*>(captured.data()), d.args);
+
+    const logging::SinkRecord rec { site.line, site.file, site.level,
+        captured, std::chrono::seconds(3600), id, true };
+    {
+        logging::BinarySink sink(fd, true);
+        sink.write(rec);
+        sink.write(rec);
+    }
+    ASSERT_EQ(decoded(),
+        "src/b.cpp:20: [01:00:00.000000000] INFO - received 1234 bytes from "
+        "192.168.1.1\n"
+        "src/b.cpp:20: [01:00:00.000000000] INFO - received 1234 bytes from "
+        "192.168.1.1\n");
+    ASSERT_EQ(status, error::Error::OK);
+}
+
+TEST_F(TestBinarySink, logger_passes_captured_arguments_through)
+{
+    logging::Hard_RT_RecordThreadedLogger producer(true, true);
+    static constinit logging::LogSite site { "src/c.cpp", 30,
+        logging::Level::ERROR, "x={} e={}" };
+    logging::log_deferred_at(producer, site, "x={} e={}", 5,
+        error::Error::RANGE);
+
+    auto e = producer.remove_unformatted();
+    ASSERT_TRUE(e.has_value());
+    ASSERT_TRUE(e->args);
+    ASSERT_EQ(e->site_id, site.id.load());
+    {
+        logging::BinarySink sink(fd, true);
+        sink.write(logging::SinkRecord { e->line, e->file, e->level, e->msg,
+            std::chrono::nanoseconds(0), e->site_id, e->args });
+    }
+    ASSERT_EQ(
+        decoded(), "src/c.cpp:30: [00:00:00.000000000] ERROR - x=5 e=RANGE\n");
+}
+
+TEST_F(TestBinarySink, smaller_than_text)
+{
+    const logging::SinkRecord rec { 12, "src/some/module/file.cpp",
+        logging::Level::INFO, "short", std::chrono::seconds(1) };
+    std::string text;
+    {
+        logging::BinarySink sink(fd, true);
+        for (uint32_t i = 0; i < 1000; i++)
+        {
+            sink.write(rec);
+            text += text_of(rec);
+        }
+    }
+    ASSERT_LT(file_contents().size() * 5, text.size());
+}
+
+TEST_F(TestBinarySink, corrupt_input_is_reported)
+{
+    ASSERT_EQ(write(fd, "not a log", 9), 9);
+    close(fd);
+    ASSERT_EQ(decoded(), "");
+    ASSERT_EQ(status, error::Error::BAD_PPROTOCOL);
+}
+
+TEST_F(TestBinarySink, other_byte_order_is_reported)
+{
+    {
+        logging::BinarySink sink(fd, true);
+        sink.write(logging::SinkRecord { 12, "src/a.cpp",
+            logging::Level::INFO, "hello", std::chrono::nanoseconds(0) });
+    }
+    auto contents = file_contents();
+    const auto pos = logging::binary_log::MAGIC.size();
+    ASSERT_EQ(contents[pos],
+        static_cast<char>(logging::binary_log::NATIVE_BYTE_ORDER));
+
+    contents[pos] = static_cast<char>(
+        logging::binary_log::NATIVE_BYTE_ORDER ==
+                logging::binary_log::ByteOrder::LITTLE
+            ? logging::binary_log::ByteOrder::BIG
+            : logging::binary_log::ByteOrder::LITTLE);
+    std::ofstream(path, std::ios::binary | std::ios::trunc) << contents;
+    ASSERT_EQ(decoded(), "");
+    ASSERT_EQ(status, error::Error::RANGE);
+}
+
+TEST_F(TestBinarySink, truncated_input_keeps_complete_records)
+{
+    const logging::SinkRecord rec { 12, "src/a.cpp", logging::Level::INFO,
+        "hello", std::chrono::nanoseconds(0) };
+    {
+        logging::BinarySink sink(fd, true);
+        sink.write(rec);
+        sink.write(rec);
+    }
+    const auto contents = file_contents();
+    ASSERT_EQ(truncate(path.c_str(), contents.size() - 2), 0);
+    ASSERT_EQ(decoded(), text_of(rec));
+    ASSERT_EQ(status, error::Error::BAD_PPROTOCOL);
+}
+
+} // namespace Tests
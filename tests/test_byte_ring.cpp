@@ -0,0 +1,175 @@
+#include <gtest/gtest.h>
+
+#include <slogger/ByteRing.hpp>
+#include <slogger/ThreadedLogger.hpp>
+
+#include <string>
+#include <string_view>
+#include <thread>
+
+namespace Tests
+{
+namespace
+{
+    template<uint32_t N> bool put(ByteRing<N>& ring, std::string_view s)
+    {
+        auto* p = ring.reserve(s.size());
+        if (p == nullptr)
+        {
+            return false;
+        }
+        std::memcpy(p, s.data(), s.size());
+        ring.commit(s.size());
+        return true;
+    }
+
+    template<uint32_t N> std::optional<std::string> get(ByteRing<N>& ring)
+    {
+        auto rec = ring.peek();
+        if (rec.empty())
+        {
+            return std::nullopt;
+        }
+        std::string s(reinterpret_cast<const char*>(rec.data()), rec.size());
+        ring.release();
+        return s;
+    }
+} // namespace
+
+TEST(TestByteRing, roundtrip_variable_sizes)
+{
+    ByteRing<256> ring;
+
+    ASSERT_TRUE(ring.empty());
+    ASSERT_TRUE(put(ring, "a"));
+    ASSERT_TRUE(put(ring, "hello world"));
+    ASSERT_EQ(get(ring), "a");
+    ASSERT_EQ(get(ring), "hello world");
+    ASSERT_EQ(get(ring), std::nullopt);
+}
+
+TEST(TestByteRing, commit_less_than_reserved)
+{
+    ByteRing<256> ring;
+
+    auto* p = ring.reserve(100);
+    ASSERT_NE(p, nullptr);
+    std::memcpy(p, "abc", 3);
+    ring.commit(3);
+    ASSERT_EQ(get(ring), "abc");
+}
+
+TEST(TestByteRing, full_ring_and_too_large_records_are_rejected)
+{
+    ByteRing<64> ring;
+
+    ASSERT_EQ(ring.reserve(ByteRing<64>::MAX_RECORD_SIZE + 1), nullptr);
+
+    // 4 records of 16 bytes (8 header + 8 payload) fill the ring
+    for (int i = 0; i < 4; i++)
+    {
+        ASSERT_TRUE(put(ring, "01234567"));
+    }
+    ASSERT_FALSE(put(ring, "x"));
+    ASSERT_EQ(get(ring), "01234567");
+    ASSERT_TRUE(put(ring, "x"));
+}
+
+TEST(TestByteRing, record_that_does_not_fit_the_tail_wraps)
+{
+    ByteRing<64> ring;
+
+    ASSERT_TRUE(put(ring, std::string(20, 'a'))); // 32 bytes
+    ASSERT_TRUE(put(ring, std::string(4, 'b')));  // 16 bytes
+    ASSERT_EQ(get(ring), std::string(20, 'a'));
+
+    // 16 bytes left at the tail, needs 24: padding + start at 0
+    ASSERT_TRUE(put(ring, std::string(12, 'c')));
+    ASSERT_EQ(get(ring), std::string(4, 'b'));
+    ASSERT_EQ(get(ring), std::string(12, 'c'));
+    ASSERT_TRUE(ring.empty());
+}
+
+TEST(TestByteRing, stress_spsc_variable_sizes)
+{
+    static constexpr uint32_t COUNT = 100000;
+    ByteRing<1024> ring;
+
+    std::thread producer([&]() {
+        for (uint32_t i = 0; i < COUNT; i++)
+        {
+            const std::string s(1 + (i % 100), char('a' + (i % 26)));
+            while (!put(ring, s))
+            {
+                std::this_thread::yield();
+            }
+        }
+    });
+
+    for (uint32_t i = 0; i < COUNT;)
+    {
+        auto s = get(ring);
+        if (!s)
+        {
+            std::this_thread::yield();
+            continue;
+        }
+        ASSERT_EQ(*s, std::string(1 + (i % 100), char('a' + (i % 26))));
+        i++;
+    }
+    producer.join();
+}
+
+TEST(TestByteRing, record_threaded_logger_roundtrip)
+{
+    logging::Hard_RT_RecordThreadedLogger logger(true, true);
+
+    logger.log(42, "src/foo.cpp", logging::Level::ERROR, "boom");
+    logger.log(43, "src/foo.cpp", logging::Level::INFO, "");
+
+    auto e = logger.remove();
+    ASSERT_TRUE(e.has_value());
+    ASSERT_EQ(e->line, 42U);
+    ASSERT_STREQ(e->file, "src/foo.cpp");
+    ASSERT_EQ(e->level, logging::Level::ERROR);
+    ASSERT_EQ(e->msg, "boom");
+
+    e = logger.remove();
+    ASSERT_TRUE(e.has_value());
+    ASSERT_EQ(e->line, 43U);
+    ASSERT_EQ(e->msg, "");
+    ASSERT_EQ(logger.remove(), std::nullopt);
+}
+
+TEST(TestByteRing, commit_tells_if_ring_was_empty)
+{
+    ByteRing<256> ring;
+
+    auto* p = ring.reserve(8);
+    ASSERT_NE(p, nullptr);
+    ASSERT_TRUE(ring.commit(8));
+    ASSERT_NE(ring.reserve(8), nullptr);
+    ASSERT_FALSE(ring.commit(8));
+    ASSERT_TRUE(get(ring).has_value());
+    ASSERT_TRUE(get(ring).has_value());
+
+    logging::LogRecordRing<256> records;
+    bool was_empty = false;
+    ASSERT_TRUE(records.add(1, "f", logging::Level::INFO, "a", was_empty));
+    ASSERT_TRUE(was_empty);
+    ASSERT_TRUE(records.add(1, "f", logging::Level::INFO, "b", was_empty));
+    ASSERT_FALSE(was_empty);
+}
+
+TEST(TestByteRing, record_ring_truncates_huge_messages)
+{
+    logging::LogRecordRing<256> ring;
+
+    ASSERT_TRUE(ring.add(1, "f", logging::Level::DEBUG, std::string(1000, 'x')));
+    auto e = ring.remove();
+    ASSERT_TRUE(e.has_value());
+    ASSERT_GT(e->msg.size(), 0U);
+    ASSERT_LT(e->msg.size(), 128U);
+}
+
+} // namespace Tests
@@ -0,0 +1,93 @@
+#include <gtest/gtest.h>
+
+#include <slogger/Coalescer.hpp>
+
+#include <string>
+#include <vector>
+
+namespace Tests
+{
+
+struct Written
+{
+    uint32_t line;
+    std::string msg;
+};
+
+class TestCoalescer : public ::testing::Test
+{
+protected:
+    auto writer()
+    {
+        return [this](uint32_t line, const char*, logging::Level,
+                   std::string_view msg, std::chrono::nanoseconds) {
+            written.push_back(Written { line, std::string(msg) });
+        };
+    }
+
+    void add(uint32_t line, const std::string& msg, uint64_t now_ms)
+    {
+        coalescer.add(line, "src/a.cpp", logging::Level::ERROR, msg,
+            std::chrono::milliseconds(now_ms), writer());
+    }
+
+    logging::Coalescer coalescer { std::chrono::seconds(1) };
+    std::vector<Written> written;
+};
+
+TEST_F(TestCoalescer, repeats_are_summarized)
+{
+    add(1, "failed", 0);
+    for (uint64_t i = 1; i <= 100; i++)
+    {
+        add(1, "failed", i);
+    }
+    ASSERT_EQ(written.size(), 1U);
+    ASSERT_EQ(coalescer.pending(), 100U);
+
+    add(2, "other", 200);
+    ASSERT_EQ(written.size(), 3U);
+    ASSERT_EQ(written[0].msg, "failed");
+    ASSERT_EQ(written[1].line, 1U);
+    ASSERT_EQ(written[1].msg,
+        "last message repeated 100 times, first 00:00:00.001000000 last "
+        "00:00:00.100000000");
+    ASSERT_EQ(written[2].msg, "other");
+    ASSERT_EQ(coalescer.pending(), 0U);
+}
+
+TEST_F(TestCoalescer, different_line_or_message_is_not_a_repeat)
+{
+    add(1, "a", 0);
+    add(2, "a", 0);
+    add(2, "b", 0);
+    add(1, "a", 0);
+    ASSERT_EQ(written.size(), 4U);
+    ASSERT_EQ(coalescer.pending(), 0U);
+}
+
+TEST_F(TestCoalescer, long_storms_are_summarized_every_window)
+{
+    add(1, "x", 0);
+    for (uint64_t ms = 10; ms <= 2500; ms += 10)
+    {
+        add(1, "x", ms);
+    }
+    // summaries after 1s and 2s of repeats, the rest is pending
+    ASSERT_EQ(written.size(), 3U);
+    ASSERT_EQ(coalescer.pending(), 50U);
+
+    coalescer.flush_expired(std::chrono::milliseconds(2500), writer());
+    ASSERT_EQ(written.size(), 3U);
+    coalescer.flush_expired(std::chrono::milliseconds(3010), writer());
+    ASSERT_EQ(written.size(), 4U);
+    ASSERT_EQ(coalescer.pending(), 0U);
+
+    // still the same message, counted again
+    add(1, "x", 3100);
+    ASSERT_EQ(written.size(), 4U);
+    coalescer.flush(writer());
+    ASSERT_EQ(written.size(), 5U);
+}
+
+} // namespace Tests
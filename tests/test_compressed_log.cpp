@@ -0,0 +1,206 @@
+#include <gtest/gtest.h>
+
+#include <slogger/CompressedFileSink.hpp>
+#include <slogger/CompressedLog.hpp>
+#include <slogger/Lz.hpp>
+
+#include <cstdlib>
+#include <fstream>
+#include <random>
+#include <sstream>
+#include <string>
+
+#include <unistd.h>
+
+using namespace std::chrono_literals;
+
+namespace Tests
+{
+namespace
+{
+    std::string roundtrip(const std::string& raw, size_t* compressed = nullptr)
+    {
+        std::string buf(logging::lz::max_compressed_size(raw.size()), '\0');
+        const auto n = logging::lz::compress(raw.data(), raw.size(), buf.data());
+        if (compressed != nullptr)
+        {
+            *compressed = n;
+        }
+        std::string out(raw.size(), '\0');
+        EXPECT_TRUE(
+            logging::lz::decompress(buf.data(), n, out.data(), out.size()));
+        return out;
+    }
+} // namespace
+
+TEST(TestLz, roundtrip)
+{
+    ASSERT_EQ(roundtrip(""), "");
+    ASSERT_EQ(roundtrip("a"), "a");
+    ASSERT_EQ(roundtrip("abcd"), "abcd");
+    // overlapping match: offset 1
+    ASSERT_EQ(roundtrip(std::string(1000, 'x')), std::string(1000, 'x'));
+
+    std::mt19937 rng(42);
+    std::string random(100000, '\0');
+    for (auto& c : random)
+    {
+        c = static_cast<char>(rng());
+    }
+    ASSERT_EQ(roundtrip(random), random);
+}
+
+TEST(TestLz, log_text_compresses)
+{
+    std::string text;
+    for (uint32_t i = 0; i < 2000; i++)
+    {
+        text += std::format("src/rtp/session.cpp:{}: [12:00:{:02}.{:09}] INFO "
+                            "- received {} bytes from 192.168.1.{}\n",
+            100 + i % 7, i % 60, i * 7919, 1000 + i % 300, i % 16);
+    }
+    size_t compressed = 0;
+    ASSERT_EQ(roundtrip(text, &compressed), text);
+    ASSERT_LT(compressed * 3, text.size());
+}
+
+TEST(TestLz, corrupt_input_is_rejected)
+{
+    const std::string raw(1000, 'x');
+    std::string buf(logging::lz::max_compressed_size(raw.size()), '\0');
+    const auto n = logging::lz::compress(raw.data(), raw.size(), buf.data());
+    std::string out(raw.size(), '\0');
+    // wrong size
+    ASSERT_FALSE(
+        logging::lz::decompress(buf.data(), n, out.data(), out.size() - 1));
+    // cut off
+    ASSERT_FALSE(
+        logging::lz::decompress(buf.data(), n - 1, out.data(), out.size()));
+    // offset before the start
+    const char bad[] = { 0x10, 'a', 0x05, 0x00 };
+    ASSERT_FALSE(logging::lz::decompress(bad, sizeof(bad), out.data(), 5));
+}
+
+
+class TestCompressedFileSink : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        char tmpl[] = "/tmp/slogger_lz_XXXXXX";
+        fd = mkstemp(tmpl);
+        ASSERT_GE(fd, 0);
+        path = tmpl;
+    }
+
+    void TearDown() override
+    {
+        unlink(path.c_str());
+    }
+
+    /** writes count records through a sink with small blocks
+     * @returns the text FdSink would have written
+     */
+    std::string write_records(uint32_t count)
+    {
+        logging::CompressedFileConfig cfg;
+        cfg.sink.buffer_size = 4096;
+        cfg.workers = 3;
+        cfg.max_pending_blocks = 2;
+        std::string text;
+        logging::CompressedFileSink sink(fd, true, cfg);
+        for (uint32_t i = 0; i < count; i++)
+        {
+            const auto msg = std::format("message number {}", i);
+            const logging::SinkRecord rec { 12, "src/a.cpp",
+                logging::Level::INFO, msg, std::chrono::milliseconds(i) };
+            logging::append_text_line(text, rec);
+            sink.write(rec);
+        }
+        return text;
+    }
+
+    std::string decoded()
+    {
+        std::ifstream in(path, std::ios::binary);
+        std::stringstream out;
+        status = logging::decode_compressed_log(in, out);
+        return out.str();
+    }
+
+    int fd = -1;
+    std::string path;
+    error::Error status = error::Error::UNKNOWN;
+};
+
+TEST_F(TestCompressedFileSink, blocks_are_written_in_order)
+{
+    const auto text = write_records(5000);
+    ASSERT_EQ(decoded(), text);
+    ASSERT_EQ(status, error::Error::OK);
+}
+
+TEST_F(TestCompressedFileSink, index_locates_the_blocks)
+{
+    const auto text = write_records(5000);
+
+    std::ifstream in(path, std::ios::binary);
+    std::vector<logging::BlockIndexEntry> index;
+    ASSERT_EQ(logging::read_block_index(in, index), error::Error::OK);
+    ASSERT_GT(index.size(), 10U);
+
+    in.clear();
+    in.seekg(0);
+    std::string all;
+    logging::CompressedLogReader reader(in);
+    std::string block;
+    uint64_t raw = 0;
+    for (const auto& e : index)
+    {
+        ASSERT_TRUE(reader.next(block));
+        ASSERT_EQ(block.size(), e.raw_size);
+        raw += e.raw_size;
+    }
+    ASSERT_FALSE(reader.next(block));
+    ASSERT_EQ(reader.status(), error::Error::OK);
+    ASSERT_EQ(raw, text.size());
+
+    // read the last block on its own
+    in.clear();
+    in.seekg(index.back().offset);
+    std::stringstream tail;
+    tail << logging::compressed_log::MAGIC << in.rdbuf();
+    logging::CompressedLogReader tail_reader(tail);
+    ASSERT_TRUE(tail_reader.next(block));
+    ASSERT_TRUE(text.ends_with(block));
+}
+
+TEST_F(TestCompressedFileSink, file_without_index_is_readable)
+{
+    const auto text = write_records(1000);
+
+    std::ifstream in(path, std::ios::binary);
+    std::vector<logging::BlockIndexEntry> index;
+    ASSERT_EQ(logging::read_block_index(in, index), error::Error::OK);
+    // as if the process died before writing the index
+    ASSERT_EQ(truncate(path.c_str(), index.back().offset), 0);
+
+    const auto partial = decoded();
+    ASSERT_EQ(status, error::Error::OK);
+    ASSERT_TRUE(text.starts_with(partial));
+    ASSERT_EQ(partial.size() + index.back().raw_size, text.size());
+
+    std::ifstream truncated(path, std::ios::binary);
+    ASSERT_EQ(logging::read_block_index(truncated, index),
+        error::Error::NOT_READY);
+}
+
+TEST_F(TestCompressedFileSink, not_a_compressed_log)
+{
+    ASSERT_EQ(write(fd, "plain text\n", 11), 11);
+    close(fd);
+    ASSERT_EQ(decoded(), "");
+    ASSERT_EQ(status, error::Error::BAD_PPROTOCOL);
+}
+
+} // namespace Tests
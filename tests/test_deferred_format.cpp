@@ -0,0 +1,191 @@
+#include <gtest/gtest.h>
+
+// exercise the LOG_ macros in their deferred variant
+#ifndef SLOGGER_DEFERRED_FORMAT
+#define SLOGGER_DEFERRED_FORMAT
+#endif
+
+#include <slogger/DeferredFormat.hpp>
+#include <slogger/ThreadedLogger.hpp>
+
+#include <string>
+#include <vector>
+
+namespace Tests
+{
+namespace
+{
+    struct Point
+    {
+        int x;
+        int y;
+    };
+
+    /** captures like the logger does, then formats the captured bytes */
+    template<typename... Args>
+    std::string deferred(std::format_string<Args...> fmt, Args&&... args)
+    {
+        const std::tuple<const std::remove_cvref_t<Args>&...> refs(args...);
+        const auto d = logging::make_deferred_args(fmt.get(), refs);
+        std::vector<std::byte> buf(d.size);
+        d.encode(buf.data(), d.args);
+        return logging::format_deferred(d.fmt, buf);
+    }
+} // namespace
+} // namespace Tests
+
+template <> struct std::formatter<Tests::Point>
+{
+    constexpr auto parse(std::format_parse_context& ctx)
+    {
+        return ctx.begin();
+    }
+
+    auto format(const Tests::Point& p, std::format_context& ctx) const
+    {
+        return std::format_to(ctx.out(), "({}, {})", p.x, p.y);
+    }
+};
+
+namespace Tests
+{
+
+TEST(TestDeferredFormat, same_output_as_std_format)
+{
+    const std::string s = "str";
+    const std::string_view sv = "view";
+    const int i = -42;
+    const uint64_t u = 1234567890123ULL;
+    const float f = 1.1f;
+    const double d = 2.5;
+    const void* p = &i;
+
+    ASSERT_EQ(deferred("no args"), "no args");
+    ASSERT_EQ(deferred("{} {} {} {}", i, u, f, d),
+        std::format("{} {} {} {}", i, u, f, d));
+    ASSERT_EQ(deferred("{} {} {} {}", s, sv, "lit", 'c'),
+        std::format("{} {} {} {}", s, sv, "lit", 'c'));
+    ASSERT_EQ(deferred("{} {}", true, p), std::format("{} {}", true, p));
+    ASSERT_EQ(deferred("{:>8}|{:<5x}|{:.3f}|{:+}", i, 255U, d, 7),
+        std::format("{:>8}|{:<5x}|{:.3f}|{:+}", i, 255U, d, 7));
+    ASSERT_EQ(deferred("{1} {0} {1}", i, s), std::format("{1} {0} {1}", i, s));
+    ASSERT_EQ(deferred("{{{}}} }}", i), std::format("{{{}}} }}", i));
+    ASSERT_EQ(deferred("[{:{}}] [{:.{}f}]", s, 6, d, 2),
+        std::format("[{:{}}] [{:.{}f}]", s, 6, d, 2));
+    ASSERT_EQ(deferred("{:d} {:#x}", static_cast<int8_t>(-3), uint8_t { 17 }),
+        std::format("{:d} {:#x}", static_cast<int8_t>(-3), uint8_t { 17 }));
+}
+
+TEST(TestDeferredFormat, bad_dynamic_width)
+{
+    const std::string s = "abc";
+    const int w = -1;
+
+    ASSERT_THROW(static_cast<void>(
+                     std::vformat("{:{}}", std::make_format_args(s, w))),
+        std::format_error);
+    ASSERT_NE(deferred("{:{}}", s, -1).find("format error"),
+        std::string::npos);
+    ASSERT_NE(deferred("{:.{}}", s, int64_t { -5 }).find("format error"),
+        std::string::npos);
+    ASSERT_NE(deferred("{:{}}", s, uint64_t { 1 } << 40).find("format error"),
+        std::string::npos);
+}
+
+TEST(TestDeferredFormat, wide_chars_are_not_captured_as_integers)
+{
+    static_assert(logging::is_deferrable_arg<char>);
+    static_assert(!logging::is_deferrable_arg<wchar_t>);
+    static_assert(!logging::is_deferrable_arg<char8_t>);
+    static_assert(!logging::is_deferrable_arg<char16_t>);
+    static_assert(!logging::is_deferrable_arg<char32_t>);
+    static_assert(!logging::are_deferrable_args<int, char32_t>);
+}
+
+TEST(TestDeferredFormat, library_types)
+{
+    const auto ns = time_utils::tai::nanoseconds(12, 345);
+
+    ASSERT_EQ(deferred("err={}", error::Error::BUSY), "err=BUSY");
+    ASSERT_EQ(deferred("t={}", ns), "t=12:345");
+}
+
+TEST(TestDeferredFormat, bad_input_does_not_throw)
+{
+    const std::byte garbage[] = { std::byte { 0xff }, std::byte { 1 } };
+
+    ASSERT_NE(logging::format_deferred("{}", garbage).find("corrupt"),
+        std::string::npos);
+    ASSERT_NE(logging::format_deferred("{}", {}).find("format error"),
+        std::string::npos);
+}
+
+TEST(TestDeferredFormat, record_logger_formats_on_remove)
+{
+    logging::Hard_RT_RecordThreadedLogger logger(true, true);
+
+    static constinit logging::LogSite site { "f.cpp", 10,
+        logging::Level::INFO, "{} {} {}" };
+
+    std::string s = "before";
+    logging::log_deferred_at(logger, site, "{} {} {}", s, 42, 0.5);
+    // the string was copied into the record
+    s = "after";
+
+    auto e = logger.remove();
+    ASSERT_TRUE(e.has_value());
+    ASSERT_EQ(e->line, 10U);
+    ASSERT_STREQ(e->file, "f.cpp");
+    ASSERT_EQ(e->level, logging::Level::INFO);
+    ASSERT_EQ(e->msg, "before 42 0.5");
+    ASSERT_EQ(e->site_id, site.id.load());
+}
+
+TEST(TestDeferredFormat, log_macros_capture_arguments)
+{
+    logging::Hard_RT_RecordThreadedLogger logger(true, true);
+
+    LOG_INFO(logger, "x={} e={}", 5, error::Error::RANGE);
+    LOG_ERROR(logger, "plain");
+
+    auto e = logger.remove();
+    ASSERT_TRUE(e.has_value());
+    ASSERT_EQ(e->msg, "x=5 e=RANGE");
+    ASSERT_EQ(e->level, logging::Level::INFO);
+    e = logger.remove();
+    ASSERT_TRUE(e.has_value());
+    ASSERT_EQ(e->level, logging::Level::ERROR);
+    ASSERT_EQ(e->msg, "plain");
+}
+
+TEST(TestDeferredFormat, other_types_are_formatted_right_away)
+{
+    static_assert(!logging::is_deferrable_arg<Point>);
+    logging::Hard_RT_RecordThreadedLogger logger(true, true);
+
+    LOG_ERROR(logger, "at {} n={}", Point { 1, 2 }, 3);
+
+    auto e = logger.remove();
+    ASSERT_TRUE(e.has_value());
+    ASSERT_EQ(e->msg, "at (1, 2) n=3");
+}
+
+TEST(TestDeferredFormat, huge_arguments_fall_back_to_text)
+{
+    logging::Hard_RT_ThreadedLogger fixed_logger(true, true);
+    logging::Basic_Hard_RT_ThreadedLogger<logging::LogRecordRing<256>> logger(
+        true, true);
+    const std::string big(1000, 'x');
+
+    LOG_INFO(logger, "{}", big);
+    LOG_INFO(fixed_logger, "{}", big);
+
+    auto e = logger.remove();
+    ASSERT_TRUE(e.has_value());
+    ASSERT_EQ(e->msg, big.substr(0, e->msg.size()));
+    e = fixed_logger.remove();
+    ASSERT_TRUE(e.has_value());
+    ASSERT_EQ(e->msg, big);
+}
+
+} // namespace Tests
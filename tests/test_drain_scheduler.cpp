@@ -0,0 +1,303 @@
+#include <gtest/gtest.h>
+
+#include "slogger_mocks.hpp"
+
+#include <slogger/DirectConsoleLogger.hpp>
+#include <slogger/DrainScheduler.hpp>
+#include <slogger/ThreadedLogger.hpp>
+
+#include <algorithm>
+#include <format>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace std::chrono_literals;
+
+namespace Tests
+{
+namespace
+{
+    using Logger = logging::Hard_RT_ThreadedLogger;
+
+    void fill(Logger& logger, const std::string& msg, uint32_t count,
+        logging::Level level = logging::Level::DEBUG)
+    {
+        for (uint32_t i = 0; i < count; i++)
+        {
+            logger.log(1, "src/a.cpp", level, msg);
+        }
+    }
+
+    /** keeps the messages it is given, each write advances clock if set */
+    class MessageSink : public logging::ISink
+    {
+    public:
+        explicit MessageSink(std::vector<std::string>& msgs,
+            std::chrono::nanoseconds* clock = nullptr)
+            : m_msgs(msgs)
+            , m_clock(clock)
+        {
+        }
+
+        void write(const logging::SinkRecord& rec) override
+        {
+            m_msgs.emplace_back(rec.msg);
+            if (m_clock != nullptr)
+            {
+                *m_clock += std::chrono::microseconds(5);
+            }
+        }
+
+    private:
+        std::vector<std::string>& m_msgs;
+        std::chrono::nanoseconds* m_clock;
+    };
+} // namespace
+
+class TestDrainScheduler : public ::testing::Test
+{
+protected:
+    uint32_t drain(uint32_t budget)
+    {
+        return scheduler.drain(budget, false,
+            [this](const logging::LogEntry& e) { written.push_back(e.msg); });
+    }
+
+    uint32_t flush()
+    {
+        return scheduler.flush(false,
+            [this](const logging::LogEntry& e) { written.push_back(e.msg); });
+    }
+
+    uint32_t count_of(const std::string& msg) const
+    {
+        return std::count(written.begin(), written.end(), msg);
+    }
+
+    logging::DrainScheduler scheduler;
+    std::vector<std::string> written;
+};
+
+TEST_F(TestDrainScheduler, a_busy_source_does_not_delay_the_others)
+{
+    auto busy = std::make_shared<Logger>(true, true);
+    auto quiet = std::make_shared<Logger>(true, true);
+    scheduler.add(busy);
+    scheduler.add(quiet);
+
+    fill(*busy, "busy", 100);
+    for (int poll = 0; poll < 10; poll++)
+    {
+        fill(*quiet, "quiet", 1);
+        written.clear();
+        ASSERT_EQ(drain(8), 8u);
+        // written within a round: at most a quantum of busy entries first
+        const auto pos = std::find(written.begin(), written.end(), "quiet");
+        ASSERT_NE(pos, written.end()) << poll;
+        ASSERT_LE(pos - written.begin(), logging::DEFAULT_DRAIN_QUANTUM);
+    }
+}
+
+TEST_F(TestDrainScheduler, the_budget_bounds_a_call_and_turns_carry_over)
+{
+    auto a = std::make_shared<Logger>(true, true);
+    auto b = std::make_shared<Logger>(true, true);
+    auto c = std::make_shared<Logger>(true, true);
+    scheduler.add(a);
+    scheduler.add(b);
+    scheduler.add(c);
+    fill(*a, "a", 50);
+    fill(*b, "b", 50);
+    fill(*c, "c", 50);
+
+    // each call is smaller than a round, c still gets its turn
+    ASSERT_EQ(drain(3), 3u);
+    ASSERT_EQ(drain(3), 3u);
+    ASSERT_EQ(drain(6), 6u);
+    ASSERT_EQ(count_of("a"), 4u);
+    ASSERT_EQ(count_of("b"), 4u);
+    ASSERT_EQ(count_of("c"), 4u);
+
+    ASSERT_EQ(drain(UINT32_MAX), 150u - 12u);
+    ASSERT_EQ(drain(UINT32_MAX), 0u);
+}
+
+TEST_F(TestDrainScheduler, quantum_sets_the_share)
+{
+    auto big = std::make_shared<Logger>(true, true);
+    auto small = std::make_shared<Logger>(true, true);
+    scheduler.add(big, 6);
+    scheduler.add(small, 2);
+    fill(*big, "big", 100);
+    fill(*small, "small", 100);
+
+    ASSERT_EQ(drain(40), 40u);
+    ASSERT_EQ(count_of("big"), 30u);
+    ASSERT_EQ(count_of("small"), 10u);
+}
+
+TEST_F(TestDrainScheduler, errors_go_ahead_of_other_sources)
+{
+    auto flood = std::make_shared<Logger>(true, true);
+    auto failing = std::make_shared<Logger>(true, true);
+    scheduler.add(flood);
+    scheduler.add(failing);
+
+    fill(*flood, "debug", 100);
+    fill(*failing, "error", 2, logging::Level::ERROR);
+    drain(2);
+    ASSERT_EQ(written, (std::vector<std::string> { "error", "error" }));
+
+    // an ERROR logged while the flood has its turn goes first as well
+    written.clear();
+    drain(1);
+    fill(*failing, "late error", 1, logging::Level::ERROR);
+    drain(1);
+    ASSERT_EQ(written, (std::vector<std::string> { "debug", "late error" }));
+}
+
+TEST_F(TestDrainScheduler, a_source_stays_in_order)
+{
+    auto logger = std::make_shared<Logger>(true, true);
+    scheduler.add(logger);
+    fill(*logger, "info", 1, logging::Level::INFO);
+    fill(*logger, "error", 1, logging::Level::ERROR);
+    drain(UINT32_MAX);
+    ASSERT_EQ(written, (std::vector<std::string> { "info", "error" }));
+}
+
+TEST_F(TestDrainScheduler, time_order_merges_the_sources)
+{
+    auto a = std::make_shared<Logger>(true, true);
+    auto b = std::make_shared<Logger>(true, true);
+    scheduler.add(a);
+    scheduler.add(b);
+    scheduler.set_reorder_window(std::chrono::hours(1));
+
+    fill(*a, "a1", 1);
+    fill(*b, "b1", 1);
+    fill(*a, "a2", 1);
+    fill(*a, "a3", 1);
+    fill(*b, "b2", 1);
+    fill(*a, "a4", 1);
+    ASSERT_EQ(drain(UINT32_MAX), 5u);
+    // a4 is held back: b may still have something older
+    ASSERT_EQ(written,
+        (std::vector<std::string> { "a1", "b1", "a2", "a3", "b2" }));
+
+    fill(*b, "b3", 1);
+    ASSERT_EQ(drain(UINT32_MAX), 1u);
+    ASSERT_EQ(written.back(), "a4");
+
+    ASSERT_EQ(flush(), 1u);
+    ASSERT_EQ(written.back(), "b3");
+}
+
+TEST_F(TestDrainScheduler, time_order_holds_back_for_the_window_only)
+{
+    auto a = std::make_shared<Logger>(true, true);
+    auto idle = std::make_shared<Logger>(true, true);
+    scheduler.add(a);
+    scheduler.add(idle);
+    scheduler.set_reorder_window(std::chrono::milliseconds(2));
+
+    fill(*a, "a", 3);
+    // unless the machine stalls for 2ms these are too recent
+    const auto early = drain(UINT32_MAX);
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    ASSERT_EQ(early + drain(UINT32_MAX), 3u);
+
+    // zero goes back to turns, nothing is held back
+    scheduler.set_reorder_window(std::chrono::nanoseconds(0));
+    fill(*a, "a", 3);
+    ASSERT_EQ(drain(UINT32_MAX), 3u);
+}
+
+TEST(TestDirectConsoleLoggerPoll, poll_writes_at_most_the_budget)
+{
+    std::vector<std::string> msgs;
+    logging::DirectConsoleLogger logger(
+        true, true, std::make_unique<MessageSink>(msgs));
+    auto a = std::make_shared<Logger>(true, true);
+    auto b = std::make_shared<Logger>(true, true);
+    logger.add(a);
+    logger.add(b, 1);
+    logger.set_poll_budget(5);
+    for (int i = 0; i < 10; i++)
+    {
+        a->log(1, "src/a.cpp", logging::Level::INFO, std::format("a{}", i));
+        b->log(1, "src/a.cpp", logging::Level::INFO, std::format("b{}", i));
+    }
+
+    logger.poll();
+    ASSERT_EQ(msgs,
+        (std::vector<std::string> { "a0", "a1", "a2", "a3", "b0" }));
+    logger.poll();
+    ASSERT_EQ(msgs.size(), 10u);
+}
+
+TEST(TestDirectConsoleLoggerPoll, small_budgets_are_kept_with_thread_buffers)
+{
+    std::vector<std::string> msgs;
+    logging::DirectConsoleLogger logger(true, true,
+        std::make_unique<MessageSink>(msgs),
+        logging::LogMode::THREAD_LOCAL_BUFFERS);
+    auto a = std::make_shared<Logger>(true, true);
+    logger.add(a);
+    for (int i = 0; i < 10; i++)
+    {
+        a->log(1, "src/a.cpp", logging::Level::INFO, std::format("a{}", i));
+        LOG_INFO(logger, "t{}", i);
+    }
+
+    logger.set_poll_budget(0);
+    logger.poll();
+    ASSERT_TRUE(msgs.empty());
+    logger.set_poll_budget(1);
+    logger.poll();
+    ASSERT_EQ(msgs, (std::vector<std::string> { "t0" }));
+    logger.set_poll_budget(4);
+    logger.poll();
+    ASSERT_EQ(msgs.size(), 5u);
+}
+
+TEST(TestDirectConsoleLoggerPoll, poll_stops_when_the_time_is_spent)
+{
+    std::chrono::nanoseconds now = 10s;
+    ::testing::StrictMock<time_utils::mocks::Timer> timer;
+    // the deadline, then once per POLL_TIME_CHECK_INTERVAL entries
+    EXPECT_CALL(timer, get_time_ns)
+        .Times(3)
+        .WillRepeatedly(::testing::Invoke([&] { return now; }));
+
+    std::vector<std::string> msgs;
+    logging::DirectConsoleLogger logger(
+        true, true, std::make_unique<MessageSink>(msgs, &now));
+    logger.set_poll_timer(timer);
+    auto a = std::make_shared<Logger>(true, true);
+    logger.add(a);
+    for (int i = 0; i < 100; i++)
+    {
+        // distinct, the coalescer would fold repeats
+        a->log(1, "src/a.cpp", logging::Level::INFO, std::format("a{}", i));
+    }
+
+    // 5us per entry: 40us after the first check, 80us after the second
+    const auto result = logger.poll(std::chrono::microseconds(50));
+    ASSERT_EQ(result.written, 2 * logging::POLL_TIME_CHECK_INTERVAL);
+    ASSERT_EQ(result.remaining, 100 - result.written);
+    ASSERT_EQ(msgs.size(), result.written);
+    ::testing::Mock::VerifyAndClearExpectations(&timer);
+
+    logger.set_poll_timer(timer);
+    ON_CALL(timer, get_time_ns)
+        .WillByDefault(::testing::Invoke([&] { return now; }));
+    EXPECT_CALL(timer, get_time_ns).Times(::testing::AnyNumber());
+    const auto rest = logger.poll(std::chrono::seconds(1));
+    ASSERT_EQ(rest.written, 100 - result.written);
+    ASSERT_EQ(rest.remaining, 0u);
+}
+
+} // namespace Tests
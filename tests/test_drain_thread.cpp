@@ -0,0 +1,214 @@
+#include <gtest/gtest.h>
+
+#include <slogger/DrainThread.hpp>
+#include <slogger/ThreadedLogger.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+using namespace std::chrono_literals;
+
+namespace Tests
+{
+
+static bool wait_for(const std::atomic<uint32_t>& value, uint32_t expected,
+    std::chrono::milliseconds timeout)
+{
+    const auto deadline = std::chrono::steady_clock::now() + timeout;
+    while (value.load() != expected)
+    {
+        if (std::chrono::steady_clock::now() > deadline)
+        {
+            return false;
+        }
+        std::this_thread::sleep_for(100us);
+    }
+    return true;
+}
+
+TEST(TestDrainThread, drains_all_producers)
+{
+    static constexpr uint32_t PRODUCERS = 4;
+    static constexpr uint32_t PER_PRODUCER = 2000;
+
+    logging::Hard_RT_MPSC_ThreadedLogger logger(true, true);
+    std::atomic<uint32_t> drained { 0 };
+    logging::DrainThreadConfig cfg;
+    cfg.spin_rounds = 10;
+    logging::DrainThread thread(
+        [&] {
+            uint32_t n = 0;
+            while (logger.remove())
+            {
+                n++;
+            }
+            drained += n;
+            return n;
+        },
+        cfg);
+    ASSERT_EQ(thread.setup_error(), error::Error::OK);
+
+    std::vector<std::thread> producers;
+    for (uint32_t p = 0; p < PRODUCERS; p++)
+    {
+        producers.emplace_back([&] {
+            for (uint32_t i = 0; i < PER_PRODUCER; i++)
+            {
+                logger.log(1, "src/a.cpp", logging::Level::INFO, "x");
+            }
+        });
+    }
+    for (auto& t : producers)
+    {
+        t.join();
+    }
+    // entries are dropped when the ring is full, all others get drained
+    std::this_thread::sleep_for(50ms);
+    ASSERT_GT(drained.load(), 0U);
+    ASSERT_FALSE(logger.remove());
+}
+
+TEST(TestDrainThread, parked_thread_is_woken_by_producer)
+{
+    logging::Hard_RT_ThreadedLogger logger(true, true);
+    std::atomic<uint32_t> drained { 0 };
+    logging::DrainThreadConfig cfg;
+    cfg.spin_rounds = 10;
+    // a wake-up within the test's timeout can only come from notify()
+    cfg.max_park = std::chrono::milliseconds(60000);
+    logging::DrainThread thread(
+        [&] {
+            uint32_t n = 0;
+            while (logger.remove())
+            {
+                n++;
+            }
+            drained += n;
+            return n;
+        },
+        cfg);
+
+    for (uint32_t i = 1; i <= 5; i++)
+    {
+        // give the thread time to spin out and park
+        std::this_thread::sleep_for(20ms);
+        logger.log(1, "src/a.cpp", logging::Level::INFO, "x");
+        ASSERT_TRUE(wait_for(drained, i, 5000ms));
+    }
+}
+
+TEST(TestDrainThread, record_logger_wakes_parked_thread)
+{
+    logging::Hard_RT_RecordThreadedLogger logger(true, true);
+    std::atomic<uint32_t> drained { 0 };
+    logging::DrainThreadConfig cfg;
+    cfg.spin_rounds = 10;
+    cfg.max_park = std::chrono::milliseconds(60000);
+    logging::DrainThread thread(
+        [&] {
+            uint32_t n = 0;
+            while (logger.remove())
+            {
+                n++;
+            }
+            drained += n;
+            return n;
+        },
+        cfg);
+
+    static constinit logging::LogSite site { "src/a.cpp", 1,
+        logging::Level::INFO, "{}" };
+    for (uint32_t i = 1; i <= 5; i++)
+    {
+        std::this_thread::sleep_for(20ms);
+        // only the first of a burst wakes the thread
+        logging::log_deferred_at(logger, site, "{}", i);
+        logging::log_deferred_at(logger, site, "{}", i);
+        ASSERT_TRUE(wait_for(drained, 2 * i, 5000ms));
+    }
+}
+
+TEST(TestDrainThread, two_parked_threads_are_woken)
+{
+    logging::Hard_RT_ThreadedLogger loggers[2] { { true, true },
+        { true, true } };
+    std::atomic<uint32_t> drained[2] { 0, 0 };
+    logging::DrainThreadConfig cfg;
+    cfg.spin_rounds = 10;
+    cfg.max_park = std::chrono::milliseconds(60000);
+    const auto drain = [&](int i) {
+        return [&, i] {
+            uint32_t n = 0;
+            while (loggers[i].remove())
+            {
+                n++;
+            }
+            drained[i] += n;
+            return n;
+        };
+    };
+    logging::DrainThread a(drain(0), cfg);
+    logging::DrainThread b(drain(1), cfg);
+
+    for (uint32_t i = 1; i <= 5; i++)
+    {
+        // both threads park, each logger's entry must reach its own thread
+        std::this_thread::sleep_for(20ms);
+        loggers[0].log(1, "src/a.cpp", logging::Level::INFO, "x");
+        ASSERT_TRUE(wait_for(drained[0], i, 5000ms));
+        std::this_thread::sleep_for(20ms);
+        loggers[1].log(1, "src/a.cpp", logging::Level::INFO, "x");
+        ASSERT_TRUE(wait_for(drained[1], i, 5000ms));
+    }
+}
+
+TEST(TestDrainThread, policy_is_set_before_the_first_drain)
+{
+    std::atomic<int> first_policy { -1 };
+    logging::DrainThreadConfig cfg;
+    // needs no privileges, unlike SCHED_FIFO
+    cfg.policy = SCHED_BATCH;
+    {
+        logging::DrainThread thread(
+            [&] {
+                int expected = -1;
+                first_policy.compare_exchange_strong(
+                    expected, sched_getscheduler(0));
+                return 0U;
+            },
+            cfg);
+        ASSERT_EQ(thread.setup_error(), error::Error::OK);
+    }
+    ASSERT_EQ(first_policy.load(), SCHED_BATCH);
+}
+
+TEST(TestDrainThread, stopping_drains_the_rest)
+{
+    logging::Hard_RT_ThreadedLogger logger(true, true);
+    std::atomic<uint32_t> drained { 0 };
+    {
+        logging::DrainThreadConfig cfg;
+        cfg.cpu = 0;
+        logging::DrainThread thread(
+            [&] {
+                uint32_t n = 0;
+                while (logger.remove())
+                {
+                    n++;
+                }
+                drained += n;
+                return n;
+            },
+            cfg);
+        ASSERT_EQ(thread.setup_error(), error::Error::OK);
+        for (int i = 0; i < 100; i++)
+        {
+            logger.log(1, "src/a.cpp", logging::Level::INFO, "x");
+        }
+    }
+    ASSERT_EQ(drained.load(), 100U);
+}
+
+} // namespace Tests
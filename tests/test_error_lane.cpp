@@ -0,0 +1,136 @@
+#include <optional>
+#include <string>
+
+#include <gtest/gtest.h>
+
+#include <slogger/ThreadedLogger.hpp>
+
+namespace Tests
+{
+
+using logging::Level;
+
+// 4 DEBUG/INFO entries, 2 reserved for ERROR
+using SmallLogger = logging::Basic_Hard_RT_ThreadedLogger<
+    Ring<logging::LogEntry, 4>, Ring<logging::LogEntry, 2>>;
+
+template<typename Logger> void flood_then_error(Logger& logger)
+{
+    for (int i = 0; i < 1000; i++)
+    {
+        logger.log(__LINE__, __FILE__, Level::DEBUG, std::to_string(i));
+    }
+    logger.log(__LINE__, __FILE__, Level::ERROR, "the one we need");
+    ASSERT_GT(logger.dropped(Level::DEBUG), 0U);
+    ASSERT_EQ(logger.dropped(Level::INFO), 0U);
+    ASSERT_EQ(logger.dropped(Level::ERROR), 0U);
+
+    // the DEBUG lane kept its oldest entries, the ERROR still comes last
+    auto elt = logger.remove();
+    ASSERT_TRUE(elt);
+    ASSERT_EQ(elt->msg, "0");
+    std::optional<logging::LogEntry> last;
+    while (auto next = logger.remove())
+    {
+        last = std::move(next);
+    }
+    ASSERT_TRUE(last);
+    ASSERT_EQ(last->level, Level::ERROR);
+    ASSERT_EQ(last->msg, "the one we need");
+}
+
+TEST(TestErrorLane, debug_flood_does_not_drop_error)
+{
+    logging::Hard_RT_ThreadedLogger logger(true, true);
+    flood_then_error(logger);
+}
+
+TEST(TestErrorLane, debug_flood_does_not_drop_error_mpsc)
+{
+    logging::Hard_RT_MPSC_ThreadedLogger logger(true, true);
+    flood_then_error(logger);
+}
+
+TEST(TestErrorLane, debug_flood_does_not_drop_error_record_ring)
+{
+    logging::Hard_RT_RecordThreadedLogger logger(true, true);
+    flood_then_error(logger);
+}
+
+TEST(TestErrorLane, counts_drops_per_level)
+{
+    SmallLogger logger(true, true);
+
+    for (int i = 0; i < 3; i++)
+    {
+        logger.log(__LINE__, __FILE__, Level::DEBUG, "debug");
+        logger.log(__LINE__, __FILE__, Level::INFO, "info");
+    }
+    ASSERT_EQ(logger.pending(), 4U);
+    ASSERT_EQ(logger.dropped(Level::DEBUG), 1U);
+    ASSERT_EQ(logger.dropped(Level::INFO), 1U);
+
+    // the ERROR lane stays reserved even though the other one is full
+    logger.log(__LINE__, __FILE__, Level::ERROR, "error 1");
+    logger.log(__LINE__, __FILE__, Level::ERROR, "error 2");
+    logger.log(__LINE__, __FILE__, Level::ERROR, "error 3");
+    ASSERT_EQ(logger.pending(), 6U);
+    ASSERT_EQ(logger.dropped(Level::ERROR), 1U);
+
+    for (const char* msg : { "debug", "info", "debug", "info", "error 1" })
+    {
+        ASSERT_EQ(logger.remove()->msg, msg);
+    }
+    ASSERT_EQ(logger.remove()->msg, "error 2");
+    ASSERT_FALSE(logger.remove());
+}
+
+TEST(TestErrorLane, error_spills_into_free_space)
+{
+    SmallLogger logger(true, true);
+
+    for (int i = 0; i < 5; i++)
+    {
+        logger.log(__LINE__, __FILE__, Level::ERROR, std::to_string(i));
+    }
+    ASSERT_EQ(logger.pending(), 5U);
+    ASSERT_EQ(logger.dropped(Level::ERROR), 0U);
+
+    // a DEBUG burst cannot take the ERROR lane back
+    logger.log(__LINE__, __FILE__, Level::DEBUG, "debug");
+    logger.log(__LINE__, __FILE__, Level::DEBUG, "debug");
+    ASSERT_EQ(logger.dropped(Level::DEBUG), 1U);
+
+    for (int i = 0; i < 5; i++)
+    {
+        auto elt = logger.remove();
+        ASSERT_TRUE(elt);
+        ASSERT_EQ(elt->msg, std::to_string(i));
+    }
+    ASSERT_EQ(logger.remove()->msg, "debug");
+    ASSERT_FALSE(logger.remove());
+}
+
+TEST(TestErrorLane, lanes_mix_formatted_and_unformatted_removal)
+{
+    logging::Hard_RT_RecordThreadedLogger logger(true, true);
+
+    static constinit logging::LogSite info { "f.cpp", 10, Level::INFO,
+        "info {}" };
+    static constinit logging::LogSite error { "f.cpp", 11, Level::ERROR,
+        "error {}" };
+    logging::log_deferred_at(logger, info, "info {}", 1);
+    logging::log_deferred_at(logger, error, "error {}", 2);
+
+    // the ERROR lane's head is already taken out, still unformatted
+    auto e = logger.remove_unformatted();
+    ASSERT_TRUE(e);
+    ASSERT_TRUE(e->args);
+    e = logger.remove();
+    ASSERT_TRUE(e);
+    ASSERT_FALSE(e->args);
+    ASSERT_EQ(e->msg, "error 2");
+    ASSERT_EQ(logger.pending(), 0U);
+}
+
+} // namespace Tests
@@ -0,0 +1,163 @@
+#include <gtest/gtest.h>
+
+#include <slogger/FanOutSink.hpp>
+#include <slogger/Logger.hpp>
+
+#include <memory>
+#include <string>
+#include <tuple>
+#include <vector>
+
+using namespace std::chrono_literals;
+
+namespace Tests
+{
+namespace
+{
+    struct Written
+    {
+        std::string msg;
+        bool args;
+        std::string text;
+    };
+
+    /** keeps what it is given, as text if it writes text */
+    class RecordingSink : public logging::ISink
+    {
+    public:
+        RecordingSink(bool args, bool text)
+            : m_args(args)
+            , m_text(text)
+        {
+        }
+
+        void write(const logging::SinkRecord& rec) override
+        {
+            std::string text;
+            if (m_text)
+            {
+                logging::append_text_line(text, rec);
+            }
+            written.push_back(
+                Written { std::string(rec.msg), rec.args, std::move(text) });
+        }
+
+        bool wants_args() const override
+        {
+            return m_args;
+        }
+
+        bool writes_text() const override
+        {
+            return m_text;
+        }
+
+        std::vector<Written> written;
+
+    private:
+        bool m_args;
+        bool m_text;
+    };
+
+    logging::SinkRecord record(logging::Level level, std::string_view msg)
+    {
+        return logging::SinkRecord { 7, "src/a.cpp", level, msg, 0ns };
+    }
+} // namespace
+
+class TestFanOutSink : public ::testing::Test
+{
+protected:
+    RecordingSink* add(bool args, bool text, logging::Level min_level)
+    {
+        auto sink = std::make_unique<RecordingSink>(args, text);
+        auto* p = sink.get();
+        fan_out.add(std::move(sink), min_level);
+        return p;
+    }
+
+    logging::FanOutSink fan_out;
+};
+
+TEST_F(TestFanOutSink, filters_by_level_per_sink)
+{
+    auto* console = add(false, true, logging::Level::ERROR);
+    auto* file = add(true, false, logging::Level::DEBUG);
+    auto* socket = add(false, true, logging::Level::INFO);
+
+    fan_out.write(record(logging::Level::DEBUG, "debug"));
+    fan_out.write(record(logging::Level::INFO, "info"));
+    fan_out.write(record(logging::Level::ERROR, "error"));
+
+    ASSERT_EQ(console->written.size(), 1U);
+    ASSERT_EQ(console->written[0].msg, "error");
+    ASSERT_EQ(file->written.size(), 3U);
+    ASSERT_EQ(socket->written.size(), 2U);
+    ASSERT_EQ(socket->written[0].msg, "info");
+}
+
+TEST_F(TestFanOutSink, text_line_is_made_once)
+{
+    auto* a = add(false, true, logging::Level::DEBUG);
+    auto* b = add(false, true, logging::Level::DEBUG);
+    fan_out.write(record(logging::Level::INFO, "hello"));
+
+    ASSERT_EQ(fan_out.formatted_lines(), 1U);
+    ASSERT_EQ(a->written[0].text,
+        "src/a.cpp:7: [00:00:00.000000000] INFO - hello\n");
+    ASSERT_EQ(b->written[0].text, a->written[0].text);
+}
+
+TEST_F(TestFanOutSink, nothing_is_formatted_for_filtered_records)
+{
+    add(false, true, logging::Level::ERROR);
+    fan_out.write(record(logging::Level::INFO, "hello"));
+    ASSERT_EQ(fan_out.formatted_lines(), 0U);
+}
+
+TEST_F(TestFanOutSink, arguments_are_formatted_once_for_the_text_sinks)
+{
+    static constinit logging::LogSite site { "src/b.cpp", 9,
+        logging::Level::INFO, "x={}" };
+    const auto id = site.get_id();
+    const int x = 42;
+    const std::tuple<const int&> refs(x);
+    const auto d = logging::make_deferred_args(site.fmt, refs);
+    std::string captured(d.size, '\0');
+    d.encode(reinterpret_cast<std::byte*>(captured.data()), d.args);
+
+    auto* binary = add(true, false, logging::Level::DEBUG);
+    auto* text1 = add(false, true, logging::Level::DEBUG);
+    auto* text2 = add(false, true, logging::Level::DEBUG);
+    ASSERT_TRUE(fan_out.wants_args());
+
+    fan_out.write(logging::SinkRecord { site.line, site.file, site.level,
+        captured, 0ns, id, true });
+
+    ASSERT_EQ(fan_out.formatted_args(), 1U);
+    ASSERT_TRUE(binary->written[0].args);
+    ASSERT_EQ(binary->written[0].msg, captured);
+    ASSERT_FALSE(text1->written[0].args);
+    ASSERT_EQ(text1->written[0].msg, "x=42");
+    ASSERT_EQ(text2->written[0].msg, "x=42");
+}
+
+TEST_F(TestFanOutSink, loggers_with_their_own_sinks)
+{
+    auto first = std::make_unique<RecordingSink>(false, true);
+    auto second = std::make_unique<RecordingSink>(false, true);
+    auto* first_sink = first.get();
+    auto* second_sink = second.get();
+    {
+        logging::DirectConsoleLogger a(true, true, std::move(first));
+        logging::DirectConsoleLogger b(true, true, std::move(second));
+        LOG_INFO(a, "to a");
+        LOG_ERROR(b, "to b");
+        ASSERT_EQ(first_sink->written.size(), 1U);
+        ASSERT_EQ(first_sink->written[0].msg, "to a");
+        ASSERT_EQ(second_sink->written.size(), 1U);
+        ASSERT_EQ(second_sink->written[0].msg, "to b");
+    }
+}
+
+} // namespace Tests
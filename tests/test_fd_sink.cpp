@@ -0,0 +1,124 @@
+#include <gtest/gtest.h>
+
+#include <slogger/FdSink.hpp>
+
+#include <cstdio>
+#include <string>
+
+#include <unistd.h>
+
+using namespace std::chrono_literals;
+
+namespace Tests
+{
+
+class TestFdSink : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        ASSERT_EQ(pipe(fds), 0);
+    }
+
+    void TearDown() override
+    {
+        close(fds[0]);
+        close(fds[1]);
+    }
+
+    std::string read_all()
+    {
+        std::string out;
+        char buf[4096];
+        while (true)
+        {
+            // the write end stays open, only read what is there
+            fd_set set;
+            FD_ZERO(&set);
+            FD_SET(fds[0], &set);
+            timeval tv {};
+            if (select(fds[0] + 1, &set, nullptr, nullptr, &tv) <= 0)
+            {
+                break;
+            }
+            const auto n = read(fds[0], buf, sizeof(buf));
+            if (n <= 0)
+            {
+                break;
+            }
+            out.append(buf, n);
+        }
+        return out;
+    }
+
+    static logging::SinkRecord record(
+        logging::Level level, std::chrono::nanoseconds time)
+    {
+        return logging::SinkRecord { 12, "src/a.cpp", level, "hello", time };
+    }
+
+    int fds[2];
+};
+
+TEST_F(TestFdSink, formats_the_text_layout)
+{
+    logging::FdSink sink(fds[1], false);
+    sink.write(record(logging::Level::INFO, 3723s + 5ns));
+    sink.flush();
+    ASSERT_EQ(read_all(), "src/a.cpp:12: [01:02:03.000000005] INFO - hello\n");
+}
+
+TEST_F(TestFdSink, batches_until_latency_or_size)
+{
+    logging::FdSinkConfig cfg;
+    cfg.buffer_size = 4096;
+    cfg.max_latency = 5ms;
+    logging::FdSink sink(fds[1], false, cfg);
+
+    for (int i = 0; i < 10; i++)
+    {
+        sink.write(record(logging::Level::INFO, 1s));
+    }
+    sink.poll(1s + 4ms);
+    ASSERT_EQ(sink.syscalls(), 0U);
+    ASSERT_EQ(read_all(), "");
+
+    sink.poll(1s + 5ms);
+    ASSERT_EQ(sink.syscalls(), 1U);
+    ASSERT_EQ(read_all().size(), 10 * 48U);
+
+    // filling the buffer writes it out without waiting for poll()
+    for (int i = 0; i < 100; i++)
+    {
+        sink.write(record(logging::Level::INFO, 2s));
+    }
+    ASSERT_EQ(sink.syscalls(), 2U);
+    ASSERT_EQ(sink.records(), 110U);
+    read_all();
+}
+
+TEST_F(TestFdSink, error_flushes_the_batch_at_poll)
+{
+    logging::FdSink sink(fds[1], false);
+    sink.write(record(logging::Level::INFO, 1s));
+    sink.write(record(logging::Level::ERROR, 1s));
+    sink.write(record(logging::Level::INFO, 1s));
+    ASSERT_EQ(sink.syscalls(), 0U);
+
+    sink.poll(1s);
+    ASSERT_EQ(sink.syscalls(), 1U);
+    ASSERT_EQ(read_all().size(), 48U + 49U + 48U);
+}
+
+TEST_F(TestFdSink, zero_latency_writes_every_record)
+{
+    logging::FdSinkConfig cfg;
+    cfg.max_latency = 0ns;
+    logging::FdSink sink(fds[1], false, cfg);
+    sink.write(record(logging::Level::INFO, 1s));
+    sink.write(record(logging::Level::INFO, 1s));
+    ASSERT_EQ(sink.syscalls(), 2U);
+    read_all();
+}
+
+} // namespace Tests
@@ -0,0 +1,147 @@
+#include <gtest/gtest.h>
+
+#include <slogger/ThreadedLogger.hpp>
+
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace Tests
+{
+
+static_assert(std::string_view(logging::strip_prefix("/home/x/src/a.cpp")) ==
+    "src/a.cpp");
+static_assert(std::string_view(logging::strip_prefix("/x/include/b.hpp")) ==
+    "include/b.hpp");
+static_assert(std::string_view(logging::strip_prefix("c.cpp")) == "c.cpp");
+
+TEST(TestLogSite, registered_once_with_stable_id)
+{
+    static constinit logging::LogSite site { "src/a.cpp", 12,
+        logging::Level::INFO, "hello {}" };
+
+    ASSERT_EQ(site.id.load(), logging::UNREGISTERED_LOG_SITE);
+    const auto id = site.get_id();
+    ASSERT_LT(id, logging::MAX_LOG_SITES);
+    ASSERT_EQ(site.get_id(), id);
+    ASSERT_GE(logging::count_log_sites(), id + 1);
+
+    const auto* found = logging::find_log_site(id);
+    ASSERT_EQ(found, &site);
+    ASSERT_EQ(found->line, 12U);
+    ASSERT_EQ(found->fmt, "hello {}");
+
+    ASSERT_EQ(logging::find_log_site(logging::NO_LOG_SITE), nullptr);
+}
+
+TEST(TestLogSite, concurrent_first_use_gets_one_id)
+{
+    static constinit logging::LogSite site { "src/b.cpp", 1,
+        logging::Level::DEBUG, "" };
+    const auto before = logging::count_log_sites();
+
+    std::vector<uint32_t> ids(8);
+    std::vector<std::thread> threads;
+    for (auto& id : ids)
+    {
+        threads.emplace_back([&id]() { id = site.get_id(); });
+    }
+    for (auto& t : threads)
+    {
+        t.join();
+    }
+    for (auto id : ids)
+    {
+        ASSERT_EQ(id, ids[0]);
+    }
+    ASSERT_EQ(logging::count_log_sites(), before + 1);
+}
+
+TEST(TestLogSite, records_only_carry_the_site_id)
+{
+    logging::Hard_RT_RecordThreadedLogger logger(true, true);
+
+    for (int i = 0; i < 2; i++)
+    {
+        LOG_INFO(logger, "pass {}", i);
+    }
+    logger.log(7, "src/other.cpp", logging::Level::ERROR, "no site");
+
+    auto e1 = logger.remove();
+    auto e2 = logger.remove();
+    auto e3 = logger.remove();
+    ASSERT_TRUE(e1 && e2 && e3);
+    ASSERT_EQ(e1->msg, "pass 0");
+    ASSERT_EQ(e2->msg, "pass 1");
+    ASSERT_EQ(e1->site_id, e2->site_id);
+    ASSERT_EQ(e1->level, logging::Level::INFO);
+    ASSERT_EQ(e1->line, e2->line);
+    ASSERT_EQ(e1->file, logging::find_log_site(e1->site_id)->file);
+
+    ASSERT_EQ(e3->site_id, logging::NO_LOG_SITE);
+    ASSERT_EQ(e3->line, 7U);
+    ASSERT_STREQ(e3->file, "src/other.cpp");
+    ASSERT_EQ(e3->msg, "no site");
+}
+
+TEST(TestLogSite, pattern_matching)
+{
+    static constinit logging::LogSite site { "src/rtp/session.cpp", 42,
+        logging::Level::DEBUG, "" };
+
+    ASSERT_TRUE(logging::log_site_matches("src/rtp/*.cpp", site));
+    ASSERT_TRUE(logging::log_site_matches("src/*", site));
+    ASSERT_TRUE(logging::log_site_matches("*session.cpp", site));
+    ASSERT_TRUE(logging::log_site_matches("src/rtp/s?ssion.cpp", site));
+    ASSERT_TRUE(logging::log_site_matches("src/rtp/session.cpp:42", site));
+    ASSERT_TRUE(logging::log_site_matches("*:4*", site));
+    ASSERT_FALSE(logging::log_site_matches("src/rtp/*.hpp", site));
+    ASSERT_FALSE(logging::log_site_matches("src/rtp/session.cpp:4", site));
+    ASSERT_FALSE(logging::log_site_matches("rtp/*", site));
+}
+
+static void log_debug(logging::ILogger& logger, int i)
+{
+    LOG_DEBUG(logger, "debug {}", i);
+}
+
+static void log_error(logging::ILogger& logger)
+{
+    LOG_ERROR(logger, "error");
+}
+
+TEST(TestLogSite, switched_at_runtime_by_pattern)
+{
+    logging::Hard_RT_ThreadedLogger logger(false, false);
+
+    // the pattern also applies to sites registered after it was set
+    logging::enable_log_sites("*/test_log_site.cpp");
+    log_debug(logger, 1);
+    auto elt = logger.remove();
+    ASSERT_TRUE(elt);
+    ASSERT_EQ(elt->msg, "debug 1");
+
+    const auto* site = logging::find_log_site(elt->site_id);
+    ASSERT_NE(site, nullptr);
+    const auto at_line =
+        std::string(site->file) + ":" + std::to_string(site->line);
+    ASSERT_EQ(logging::disable_log_sites(at_line), 1U);
+    log_debug(logger, 2);
+    ASSERT_FALSE(logger.remove());
+
+    ASSERT_GE(logging::disable_log_sites("*/test_log_site.cpp"), 1U);
+    log_error(logger);
+    ASSERT_FALSE(logger.remove());
+
+    logging::reset_log_sites();
+    log_debug(logger, 3);
+    ASSERT_FALSE(logger.remove());
+    log_error(logger);
+    ASSERT_TRUE(logger.remove());
+
+    logger.set_debug(true);
+    log_debug(logger, 4);
+    ASSERT_TRUE(logger.remove());
+}
+
+} // namespace Tests
@@ -0,0 +1,53 @@
+// this translation unit compiles out everything below ERROR
+#undef SLOGGER_MIN_LEVEL
+#define SLOGGER_MIN_LEVEL 2
+
+#include <gtest/gtest.h>
+
+#include <slogger/ThreadedLogger.hpp>
+
+namespace Tests
+{
+
+static_assert(SLOGGER_MIN_LEVEL == SLOGGER_LEVEL_ERROR);
+
+static int evaluated(int v, int& count)
+{
+    count++;
+    return v;
+}
+
+TEST(TestMinLevel, below_threshold_is_compiled_out)
+{
+    logging::Hard_RT_ThreadedLogger logger(true, true);
+    int count = 0;
+
+    LOG_DEBUG(logger, "debug {}", evaluated(1, count));
+    LOG_INFO(logger, "info {}", evaluated(2, count));
+    LOG_INFO_ONCE(logger, "info once {}", evaluated(3, count));
+    LOG_INFO_SLOW(logger, "info slow {}", evaluated(4, count));
+    LOG_INFO_VERY_SLOW(logger, "info very slow {}", evaluated(5, count));
+    ASSERT_EQ(count, 0);
+    ASSERT_FALSE(logger.remove());
+
+    LOG_ERROR(logger, "error {}", evaluated(6, count));
+    ASSERT_EQ(count, 1);
+    auto elt = logger.remove();
+    ASSERT_TRUE(elt);
+    ASSERT_EQ(elt->msg, "error 6");
+    ASSERT_EQ(elt->level, logging::Level::ERROR);
+}
+
+TEST(TestMinLevel, compiled_out_macro_is_a_single_statement)
+{
+    logging::Hard_RT_ThreadedLogger logger(true, true);
+    bool flag = false;
+
+    if (flag)
+        LOG_DEBUG(logger, "x");
+    else
+        LOG_ERROR(logger, "y");
+    ASSERT_TRUE(logger.remove());
+}
+
+} // namespace Tests
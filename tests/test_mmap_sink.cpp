@@ -0,0 +1,223 @@
+#include <gtest/gtest.h>
+
+#include <slogger/MmapSink.hpp>
+
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+using namespace std::chrono_literals;
+
+namespace Tests
+{
+
+class TestMmapSink : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        char tmpl[] = "/tmp/slogger_mmap_XXXXXX";
+        ASSERT_NE(mkdtemp(tmpl), nullptr);
+        dir = tmpl;
+    }
+
+    void TearDown() override
+    {
+        std::filesystem::remove_all(dir);
+    }
+
+    logging::MmapSinkConfig config(uint64_t segment_size)
+    {
+        logging::MmapSinkConfig cfg;
+        cfg.path = dir + "/log";
+        cfg.segment_size = segment_size;
+        return cfg;
+    }
+
+    static std::string read_file(const std::string& path)
+    {
+        std::ifstream in(path);
+        std::stringstream ss;
+        ss << in.rdbuf();
+        return ss.str();
+    }
+
+    // 48 bytes
+    static logging::SinkRecord record(std::string_view msg = "hello")
+    {
+        return logging::SinkRecord { 12, "src/a.cpp", logging::Level::INFO,
+            msg, std::chrono::nanoseconds(0) };
+    }
+
+    std::string dir;
+};
+
+TEST_F(TestMmapSink, test_segment_is_preallocated)
+{
+    logging::MmapSink sink(config(4096));
+    ASSERT_EQ(sink.status(), error::Error::OK);
+    sink.write(record());
+    EXPECT_EQ(std::filesystem::file_size(sink.segment_path(0)), 4096U);
+}
+
+TEST_F(TestMmapSink, test_truncated_to_used_size_on_close)
+{
+    const auto cfg = config(4096);
+    {
+        logging::MmapSink sink(cfg);
+        sink.write(record());
+        sink.write(record("world"));
+    }
+    EXPECT_EQ(read_file(cfg.path + ".000000"),
+        "src/a.cpp:12: [00:00:00.000000000] INFO - hello\n"
+        "src/a.cpp:12: [00:00:00.000000000] INFO - world\n");
+}
+
+TEST_F(TestMmapSink, test_rolls_to_next_segment_when_full)
+{
+    const auto cfg = config(100);
+    {
+        logging::MmapSink sink(cfg);
+        sink.write(record("a...."));
+        sink.write(record("b...."));
+        EXPECT_EQ(sink.segment(), 0U);
+        sink.write(record("c...."));
+        EXPECT_EQ(sink.segment(), 1U);
+
+        // the full segment no longer has the preallocated tail
+        EXPECT_EQ(std::filesystem::file_size(sink.segment_path(0)), 96U);
+    }
+    EXPECT_EQ(read_file(cfg.path + ".000000"),
+        "src/a.cpp:12: [00:00:00.000000000] INFO - a....\n"
+        "src/a.cpp:12: [00:00:00.000000000] INFO - b....\n");
+    EXPECT_EQ(read_file(cfg.path + ".000001"),
+        "src/a.cpp:12: [00:00:00.000000000] INFO - c....\n");
+}
+
+TEST_F(TestMmapSink, test_restart_continues_numbering)
+{
+    const auto cfg = config(4096);
+    {
+        logging::MmapSink sink(cfg);
+        sink.write(record("first"));
+    }
+    {
+        logging::MmapSink sink(cfg);
+        EXPECT_EQ(sink.segment(), 1U);
+        sink.write(record("second"));
+    }
+    EXPECT_EQ(read_file(cfg.path + ".000000"),
+        "src/a.cpp:12: [00:00:00.000000000] INFO - first\n");
+    EXPECT_EQ(read_file(cfg.path + ".000001"),
+        "src/a.cpp:12: [00:00:00.000000000] INFO - second\n");
+}
+
+TEST_F(TestMmapSink, test_existing_segment_is_not_overwritten)
+{
+    const auto cfg = config(100);
+    std::ofstream(cfg.path + ".000001") << "other";
+    {
+        logging::MmapSink sink(cfg);
+        // the scan starts after the highest number
+        EXPECT_EQ(sink.segment(), 2U);
+    }
+    std::filesystem::remove(cfg.path + ".000002");
+    std::filesystem::remove(cfg.path + ".000001");
+    {
+        logging::MmapSink sink(cfg);
+        EXPECT_EQ(sink.segment(), 0U);
+        sink.write(record("a...."));
+        sink.write(record("b...."));
+        // created by someone else meanwhile: skipped when rolling
+        std::ofstream(cfg.path + ".000001") << "other";
+        sink.write(record("c...."));
+        EXPECT_EQ(sink.segment(), 2U);
+    }
+    EXPECT_EQ(read_file(cfg.path + ".000001"), "other");
+    EXPECT_EQ(read_file(cfg.path + ".000002"),
+        "src/a.cpp:12: [00:00:00.000000000] INFO - c....\n");
+}
+
+TEST_F(TestMmapSink, test_record_larger_than_segment_is_dropped)
+{
+    const auto cfg = config(64);
+    {
+        logging::MmapSink sink(cfg);
+        sink.write(record(std::string(100, 'x')));
+        sink.write(record());
+        EXPECT_EQ(sink.segment(), 0U);
+        EXPECT_EQ(sink.dropped(), 1U);
+    }
+    EXPECT_EQ(read_file(cfg.path + ".000000"),
+        "src/a.cpp:12: [00:00:00.000000000] INFO - hello\n");
+}
+
+TEST_F(TestMmapSink, test_msync_on_flush)
+{
+    auto cfg = config(1 << 20);
+    cfg.msync = logging::MsyncPolicy::ASYNC_ON_FLUSH;
+    logging::MmapSink sink(cfg);
+    sink.write(record());
+    EXPECT_EQ(sink.synced(), 0U);
+    sink.flush();
+    EXPECT_EQ(sink.synced(), 48U);
+    sink.write(record());
+    // the logger only polls while running
+    sink.poll(1s);
+    EXPECT_EQ(sink.synced(), 96U);
+    EXPECT_EQ(read_file(cfg.path + ".000000").substr(0, 96),
+        "src/a.cpp:12: [00:00:00.000000000] INFO - hello\n"
+        "src/a.cpp:12: [00:00:00.000000000] INFO - hello\n");
+}
+
+TEST_F(TestMmapSink, test_no_msync_on_flush_by_default)
+{
+    logging::MmapSink sink(config(1 << 20));
+    sink.write(record());
+    sink.poll(1s);
+    sink.flush();
+    EXPECT_EQ(sink.synced(), 0U);
+}
+
+TEST_F(TestMmapSink, test_open_failure)
+{
+    logging::MmapSinkConfig cfg;
+    cfg.path = dir + "/missing/log";
+    logging::MmapSink sink(cfg);
+    EXPECT_NE(sink.status(), error::Error::OK);
+    sink.write(record());
+    sink.write(record());
+    EXPECT_EQ(sink.dropped(), 2U);
+    EXPECT_EQ(sink.segment(), 0U);
+
+    // retried by poll() at most every OPEN_RETRY_INTERVAL, same segment
+    std::filesystem::create_directory(dir + "/missing");
+    sink.poll(std::chrono::seconds(10));
+    EXPECT_EQ(sink.status(), error::Error::OK);
+    EXPECT_EQ(sink.segment(), 0U);
+    sink.write(record());
+    EXPECT_EQ(sink.dropped(), 2U);
+    EXPECT_TRUE(std::filesystem::exists(sink.segment_path(0)));
+}
+
+TEST_F(TestMmapSink, test_failed_segment_is_removed)
+{
+    // too large to preallocate
+    logging::MmapSink sink(config(uint64_t(1) << 62));
+    EXPECT_NE(sink.status(), error::Error::OK);
+    const auto status = sink.status();
+
+    sink.write(record());
+    sink.poll(std::chrono::seconds(10));
+    // not retried before OPEN_RETRY_INTERVAL has passed
+    sink.poll(std::chrono::seconds(10) + 1ms);
+    sink.write(record());
+    EXPECT_EQ(sink.status(), status);
+    EXPECT_EQ(sink.segment(), 0U);
+    EXPECT_EQ(sink.dropped(), 2U);
+    EXPECT_TRUE(std::filesystem::is_empty(dir));
+}
+
+} // namespace Tests
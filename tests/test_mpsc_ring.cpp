@@ -0,0 +1,119 @@
+#include <gtest/gtest.h>
+
+#include <slogger/MpscRing.hpp>
+
+#include <thread>
+#include <vector>
+
+namespace Tests
+{
+
+TEST(TestMpscRing, keeps_fifo_order)
+{
+    MpscRing<int, 8> ring;
+
+    ASSERT_TRUE(ring.empty());
+    ASSERT_TRUE(ring.add(1));
+    ASSERT_TRUE(ring.add(2));
+    ASSERT_EQ(ring.remove(), 1);
+    ASSERT_EQ(ring.remove(), 2);
+    ASSERT_EQ(ring.remove(), std::nullopt);
+}
+
+TEST(TestMpscRing, add_tells_if_ring_was_empty)
+{
+    MpscRing<int, 4> ring;
+    bool was_empty = false;
+
+    ASSERT_TRUE(ring.add(1, was_empty));
+    ASSERT_TRUE(was_empty);
+    ASSERT_TRUE(ring.add(2, was_empty));
+    ASSERT_FALSE(was_empty);
+    ASSERT_EQ(ring.remove(), 1);
+    ASSERT_EQ(ring.remove(), 2);
+    ASSERT_TRUE(ring.add(3, was_empty));
+    ASSERT_TRUE(was_empty);
+}
+
+TEST(TestMpscRing, full_ring_drops_new_elements)
+{
+    MpscRing<int, 4> ring;
+
+    for (int i = 0; i < 4; i++)
+    {
+        ASSERT_TRUE(ring.add(i));
+    }
+    ASSERT_FALSE(ring.add(42));
+    ASSERT_EQ(ring.remove(), 0);
+    ASSERT_TRUE(ring.add(4));
+    for (int i = 1; i <= 4; i++)
+    {
+        ASSERT_EQ(ring.remove(), i);
+    }
+    ASSERT_TRUE(ring.empty());
+}
+
+TEST(TestMpscRing, stress_many_producers)
+{
+    static constexpr uint32_t PRODUCERS = 8;
+    static constexpr uint32_t PER_PRODUCER = 20000;
+    struct Entry
+    {
+        uint32_t producer;
+        uint32_t seq;
+    };
+    MpscRing<Entry, 64> ring;
+
+    std::vector<std::thread> producers;
+    for (uint32_t p = 0; p < PRODUCERS; p++)
+    {
+        producers.emplace_back([&ring, p]() {
+            for (uint32_t i = 0; i < PER_PRODUCER; i++)
+            {
+                while (!ring.add(Entry { p, i }))
+                {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+
+    // per producer the order must be preserved. Keep draining after a
+    // mismatch so that the producers can finish, an ASSERT here would
+    // destroy joinable threads.
+    std::vector<uint32_t> next(PRODUCERS, 0);
+    uint32_t total = 0;
+    uint32_t mismatches = 0;
+    while (total < PRODUCERS * PER_PRODUCER)
+    {
+        auto e = ring.remove();
+        if (!e)
+        {
+            std::this_thread::yield();
+            continue;
+        }
+        total++;
+        if (e->producer >= PRODUCERS || e->seq != next[e->producer])
+        {
+            if (mismatches++ == 0)
+            {
+                ADD_FAILURE() << "first mismatch at entry " << total
+                              << ": producer " << e->producer << " seq "
+                              << e->seq;
+            }
+            if (e->producer >= PRODUCERS)
+            {
+                continue;
+            }
+        }
+        next[e->producer] = e->seq + 1;
+    }
+    for (auto& t : producers)
+    {
+        t.join();
+    }
+    ASSERT_EQ(mismatches, 0U);
+    ASSERT_EQ(ring.remove(), std::nullopt);
+}
+
+} // namespace Tests
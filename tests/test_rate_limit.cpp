@@ -0,0 +1,164 @@
+#include <gtest/gtest.h>
+
+#include "slogger_mocks.hpp"
+
+#include <slogger/DefaultClockTimer.hpp>
+#include <slogger/DirectConsoleLogger.hpp>
+#include <slogger/ThreadedLogger.hpp>
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace std::chrono_literals;
+using ::testing::Invoke;
+
+namespace Tests
+{
+
+TEST(TestRateLimit, burst_then_refill)
+{
+    ::testing::NiceMock<time_utils::mocks::Timer> timer;
+    std::chrono::nanoseconds now = 10s;
+    ON_CALL(timer, get_time_ns).WillByDefault(Invoke([&] { return now; }));
+
+    logging::RateLimiter limiter(2, 3);
+    uint32_t suppressed = 99;
+    for (int i = 0; i < 3; i++)
+    {
+        ASSERT_TRUE(limiter.allow(timer, suppressed));
+        ASSERT_EQ(suppressed, 0U);
+    }
+    ASSERT_FALSE(limiter.allow(timer, suppressed));
+    ASSERT_FALSE(limiter.allow(timer, suppressed));
+
+    // one token every 500ms
+    now += 499ms;
+    ASSERT_FALSE(limiter.allow(timer, suppressed));
+    now += 1ms;
+    ASSERT_TRUE(limiter.allow(timer, suppressed));
+    ASSERT_EQ(suppressed, 3U);
+    ASSERT_FALSE(limiter.allow(timer, suppressed));
+
+    // refills up to the burst only
+    now += 1h;
+    for (int i = 0; i < 3; i++)
+    {
+        ASSERT_TRUE(limiter.allow(timer, suppressed));
+    }
+    ASSERT_EQ(suppressed, 0U);
+    ASSERT_FALSE(limiter.allow(timer, suppressed));
+}
+
+TEST(TestRateLimit, concurrent_callers_share_the_bucket)
+{
+    ::testing::NiceMock<time_utils::mocks::Timer> timer;
+    ON_CALL(timer, get_time_ns).WillByDefault(Invoke([] { return 5s; }));
+
+    logging::RateLimiter limiter(1, 100);
+    std::atomic<int> allowed { 0 };
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; t++)
+    {
+        threads.emplace_back([&] {
+            uint32_t suppressed;
+            for (int i = 0; i < 1000; i++)
+            {
+                allowed += limiter.allow(timer, suppressed) ? 1 : 0;
+            }
+        });
+    }
+    for (auto& t : threads)
+    {
+        t.join();
+    }
+    ASSERT_EQ(allowed.load(), 100);
+}
+
+TEST(TestRateLimit, macro_reports_suppressed_messages)
+{
+    ::testing::NiceMock<time_utils::mocks::Timer> timer;
+    std::chrono::nanoseconds now = 1s;
+    ON_CALL(timer, get_time_ns).WillByDefault(Invoke([&] { return now; }));
+    logging::set_rate_limit_timer(timer);
+
+    logging::Hard_RT_ThreadedLogger logger(true, true);
+    auto log = [&](int i) { LOG_ERROR_RATE(logger, 1, 2, "error {}", i); };
+
+    for (int i = 0; i < 10; i++)
+    {
+        log(i);
+    }
+    ASSERT_EQ(logger.remove()->msg, "error 0");
+    ASSERT_EQ(logger.remove()->msg, "error 1");
+    ASSERT_FALSE(logger.remove());
+
+    now += 1s;
+    log(10);
+    auto summary = logger.remove();
+    ASSERT_TRUE(summary);
+    ASSERT_EQ(summary->msg, "8 messages suppressed");
+    ASSERT_EQ(summary->level, logging::Level::ERROR);
+    ASSERT_EQ(logger.remove()->msg, "error 10");
+
+    static time_utils::DefaultClockTimer steady;
+    logging::set_rate_limit_timer(steady);
+}
+
+TEST(TestRateLimit, quiet_site_is_reported_by_the_consumer)
+{
+    /** keeps the messages it is given */
+    class MessageSink : public logging::ISink
+    {
+    public:
+        explicit MessageSink(std::vector<std::string>& msgs)
+            : m_msgs(msgs)
+        {
+        }
+
+        void write(const logging::SinkRecord& rec) override
+        {
+            m_msgs.emplace_back(rec.msg);
+        }
+
+    private:
+        std::vector<std::string>& m_msgs;
+    };
+
+    ::testing::NiceMock<time_utils::mocks::Timer> timer;
+    std::chrono::nanoseconds now = 1s;
+    ON_CALL(timer, get_time_ns).WillByDefault(Invoke([&] { return now; }));
+    logging::set_rate_limit_timer(timer);
+
+    std::vector<std::string> msgs;
+    logging::DirectConsoleLogger consumer(
+        true, true, std::make_unique<MessageSink>(msgs));
+    auto logger = std::make_shared<logging::Hard_RT_ThreadedLogger>(true, true);
+    consumer.add(logger);
+
+    // a flood, then nothing more from that site
+    for (int i = 0; i < 10; i++)
+    {
+        LOG_INFO_RATE(*logger, 1, 2, "info {}", i);
+    }
+    consumer.poll();
+    ASSERT_EQ(msgs, (std::vector<std::string> { "info 0", "info 1" }));
+
+    // still refusing
+    now += 500ms;
+    consumer.poll();
+    ASSERT_EQ(msgs.size(), 2u);
+
+    now += 500ms;
+    consumer.poll();
+    ASSERT_EQ(msgs.back(), "8 messages suppressed");
+    consumer.poll();
+    ASSERT_EQ(msgs.size(), 3u);
+
+    static time_utils::DefaultClockTimer steady;
+    logging::set_rate_limit_timer(steady);
+}
+
+} // namespace Tests
@@ -0,0 +1,134 @@
+#include <gtest/gtest.h>
+
+#include <slogger/Ring.hpp>
+
+#include <string>
+#include <thread>
+
+namespace Tests
+{
+
+TEST(TestRing, empty_ring_returns_nothing)
+{
+    Ring<int, 8> ring;
+
+    ASSERT_TRUE(ring.empty());
+    ASSERT_EQ(ring.remove(), std::nullopt);
+}
+
+TEST(TestRing, keeps_fifo_order)
+{
+    Ring<int, 8> ring;
+
+    ASSERT_TRUE(ring.add(1));
+    ASSERT_TRUE(ring.add(2));
+    ASSERT_TRUE(ring.add(3));
+    ASSERT_EQ(ring.size(), 3U);
+
+    ASSERT_EQ(ring.remove(), 1);
+    ASSERT_EQ(ring.remove(), 2);
+    ASSERT_EQ(ring.remove(), 3);
+    ASSERT_EQ(ring.remove(), std::nullopt);
+}
+
+TEST(TestRing, full_ring_drops_new_elements)
+{
+    Ring<int, 4> ring;
+
+    for (int i = 0; i < 4; i++)
+    {
+        ASSERT_TRUE(ring.add(i));
+    }
+    ASSERT_FALSE(ring.add(42));
+
+    // the oldest entries must not have been overwritten
+    ASSERT_EQ(ring.remove(), 0);
+    ASSERT_TRUE(ring.add(4));
+    ASSERT_EQ(ring.remove(), 1);
+    ASSERT_EQ(ring.remove(), 2);
+    ASSERT_EQ(ring.remove(), 3);
+    ASSERT_EQ(ring.remove(), 4);
+}
+
+TEST(TestRing, wraps_around_many_times)
+{
+    Ring<uint32_t, 4> ring;
+
+    for (uint32_t i = 0; i < 1000; i++)
+    {
+        ASSERT_TRUE(ring.add(i));
+        ASSERT_EQ(ring.remove(), i);
+    }
+    ASSERT_TRUE(ring.empty());
+}
+
+TEST(TestRing, add_tells_if_ring_was_empty)
+{
+    Ring<int, 4> ring;
+    bool was_empty = false;
+
+    ASSERT_TRUE(ring.add(1, was_empty));
+    ASSERT_TRUE(was_empty);
+    ASSERT_TRUE(ring.add(2, was_empty));
+    ASSERT_FALSE(was_empty);
+    ASSERT_EQ(ring.remove(), 1);
+    ASSERT_TRUE(ring.add(3, was_empty));
+    ASSERT_FALSE(was_empty);
+    ASSERT_EQ(ring.remove(), 2);
+    ASSERT_EQ(ring.remove(), 3);
+    ASSERT_TRUE(ring.add(4, was_empty));
+    ASSERT_TRUE(was_empty);
+}
+
+TEST(TestRing, stress_spsc_no_loss_no_tearing)
+{
+    static constexpr uint32_t COUNT = 200000;
+    struct Entry
+    {
+        uint32_t seq;
+        std::string msg;
+    };
+    Ring<Entry, 64> ring;
+
+    std::thread producer([&]() {
+        for (uint32_t i = 0; i < COUNT; i++)
+        {
+            Entry e { i, std::string(1 + (i % 40), char('a' + (i % 26))) };
+            while (!ring.add(e))
+            {
+                std::this_thread::yield();
+            }
+        }
+    });
+
+    // keep draining after a mismatch so that the producer can finish, an
+    // ASSERT here would destroy the joinable thread
+    uint32_t expected = 0;
+    uint32_t mismatches = 0;
+    while (expected < COUNT)
+    {
+        auto e = ring.remove();
+        if (!e)
+        {
+            std::this_thread::yield();
+            continue;
+        }
+        if (e->seq != expected ||
+            e->msg !=
+                std::string(1 + (expected % 40), char('a' + (expected % 26))))
+        {
+            if (mismatches++ == 0)
+            {
+                ADD_FAILURE() << "first mismatch at " << expected
+                              << ", got seq " << e->seq;
+            }
+        }
+        expected++;
+    }
+    producer.join();
+
+    ASSERT_EQ(mismatches, 0U);
+    ASSERT_EQ(ring.remove(), std::nullopt);
+}
+
+} // namespace Tests
@@ -0,0 +1,217 @@
+#include <gtest/gtest.h>
+
+#include <slogger/BinaryLog.hpp>
+#include <slogger/BinarySink.hpp>
+#include <slogger/RotatingFileSink.hpp>
+
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+
+using namespace std::chrono_literals;
+
+namespace Tests
+{
+
+class TestRotatingFileSink : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        char tmpl[] = "/tmp/slogger_rotate_XXXXXX";
+        ASSERT_NE(mkdtemp(tmpl), nullptr);
+        dir = tmpl;
+        cfg.path = dir + "/app.log";
+        cfg.sink.max_latency = 0ns;
+    }
+
+    void TearDown() override
+    {
+        std::filesystem::remove_all(dir);
+    }
+
+    template<typename F> static bool wait_for(F&& done)
+    {
+        for (int i = 0; i < 5000 && !done(); i++)
+        {
+            std::this_thread::sleep_for(1ms);
+        }
+        return done();
+    }
+
+    static std::string read_file(const std::string& path)
+    {
+        std::ifstream in(path, std::ios::binary);
+        std::stringstream ss;
+        ss << in.rdbuf();
+        return ss.str();
+    }
+
+    // 48 bytes
+    static logging::SinkRecord record(
+        std::string_view msg, std::chrono::nanoseconds time = 0ns)
+    {
+        return logging::SinkRecord { 12, "src/a.cpp", logging::Level::INFO,
+            msg, time };
+    }
+
+    static std::string line(std::string_view msg, std::string_view time =
+                                                      "00:00:00.000000000")
+    {
+        return std::format("src/a.cpp:12: [{}] INFO - {}\n", time, msg);
+    }
+
+    std::string dir;
+    logging::RotatingFileConfig cfg;
+};
+
+TEST_F(TestRotatingFileSink, rotates_by_size)
+{
+    cfg.max_bytes = 100;
+    {
+        logging::RotatingFileSink sink(cfg);
+        ASSERT_EQ(sink.status(), error::Error::OK);
+        ASSERT_TRUE(wait_for([&] { return sink.next_file_ready(); }));
+        sink.write(record("1...."));
+        sink.write(record("2...."));
+        sink.write(record("3...."));
+        ASSERT_EQ(sink.file_index(), 0U);
+        sink.write(record("4...."));
+        ASSERT_EQ(sink.file_index(), 1U);
+        ASSERT_EQ(sink.rotations(), 1U);
+        ASSERT_EQ(sink.late_rotations(), 0U);
+    }
+    ASSERT_EQ(read_file(cfg.path + ".000000"),
+        line("1....") + line("2....") + line("3...."));
+    ASSERT_EQ(read_file(cfg.path + ".000001"), line("4...."));
+    // the prepared, unused file is removed
+    ASSERT_FALSE(std::filesystem::exists(cfg.path + ".000002"));
+}
+
+TEST_F(TestRotatingFileSink, rotates_by_time)
+{
+    cfg.interval = 1s;
+    {
+        logging::RotatingFileSink sink(cfg);
+        ASSERT_TRUE(wait_for([&] { return sink.next_file_ready(); }));
+        sink.write(record("a", 500ms));
+        sink.write(record("b", 999ms));
+        sink.write(record("c", 1200ms));
+        ASSERT_EQ(sink.file_index(), 1U);
+    }
+    ASSERT_EQ(read_file(cfg.path + ".000000"),
+        line("a", "00:00:00.500000000") + line("b", "00:00:00.999000000"));
+    ASSERT_EQ(read_file(cfg.path + ".000001"), line("c", "00:00:01.200000000"));
+}
+
+TEST_F(TestRotatingFileSink, keeps_writing_when_next_file_is_late)
+{
+    cfg.max_bytes = 1;
+    uint32_t files = 0;
+    {
+        logging::RotatingFileSink sink(cfg);
+        for (uint32_t i = 0; i < 100; i++)
+        {
+            sink.write(record("x"));
+        }
+        ASSERT_EQ(sink.rotations() + sink.late_rotations(), 99U);
+        files = sink.file_index() + 1;
+    }
+    // whether the helper kept up or not, no record is lost
+    std::string all;
+    for (uint32_t i = 0; i < files; i++)
+    {
+        all += read_file(std::format("{}.{:06}", cfg.path, i));
+    }
+    ASSERT_EQ(all.size(), 100 * line("x").size());
+}
+
+TEST_F(TestRotatingFileSink, deletes_files_beyond_retention)
+{
+    cfg.max_bytes = 1;
+    cfg.retention = 2;
+    logging::RotatingFileSink sink(cfg);
+    for (uint32_t i = 0; i < 4; i++)
+    {
+        ASSERT_TRUE(wait_for([&] { return sink.next_file_ready(); }));
+        sink.write(record("x"));
+        // wakes the helper
+        sink.poll(0ns);
+    }
+    ASSERT_EQ(sink.file_index(), 3U);
+    ASSERT_TRUE(wait_for([&] {
+        return !std::filesystem::exists(cfg.path + ".000001");
+    }));
+    ASSERT_FALSE(std::filesystem::exists(cfg.path + ".000000"));
+    ASSERT_TRUE(std::filesystem::exists(cfg.path + ".000002"));
+    ASSERT_TRUE(std::filesystem::exists(cfg.path + ".000003"));
+}
+
+TEST_F(TestRotatingFileSink, restart_continues_numbering)
+{
+    {
+        logging::RotatingFileSink sink(cfg);
+        sink.write(record("first run"));
+    }
+    {
+        logging::RotatingFileSink sink(cfg);
+        ASSERT_EQ(sink.file_index(), 1U);
+        sink.write(record("second run"));
+    }
+    ASSERT_EQ(read_file(cfg.path + ".000000"), line("first run"));
+    ASSERT_EQ(read_file(cfg.path + ".000001"), line("second run"));
+}
+
+TEST_F(TestRotatingFileSink, restart_takes_over_empty_files)
+{
+    // what a crash leaves: the current file and the prepared next one
+    std::ofstream(cfg.path + ".000000") << line("first run");
+    std::ofstream(cfg.path + ".000001");
+    std::ofstream(cfg.path + ".000002");
+    {
+        logging::RotatingFileSink sink(cfg);
+        ASSERT_EQ(sink.file_index(), 1U);
+        sink.write(record("second run"));
+    }
+    ASSERT_EQ(read_file(cfg.path + ".000001"), line("second run"));
+    ASSERT_FALSE(std::filesystem::exists(cfg.path + ".000002"));
+}
+
+TEST_F(TestRotatingFileSink, binary_files_decode_on_their_own)
+{
+    cfg.max_bytes = 1;
+    {
+        logging::RotatingFileSink sink(
+            cfg, [](int fd, const logging::FdSinkConfig& sink_cfg) {
+                return std::make_unique<logging::BinarySink>(
+                    fd, true, sink_cfg);
+            });
+        ASSERT_TRUE(sink.wants_args());
+        ASSERT_TRUE(wait_for([&] { return sink.next_file_ready(); }));
+        sink.write(record("a"));
+        sink.poll(0ns);
+        ASSERT_TRUE(wait_for([&] { return sink.next_file_ready(); }));
+        sink.write(record("b"));
+        ASSERT_EQ(sink.file_index(), 1U);
+    }
+    for (const auto& [index, msg] : { std::pair { 0, "a" }, { 1, "b" } })
+    {
+        std::ifstream in(std::format("{}.{:06}", cfg.path, index));
+        std::stringstream out;
+        ASSERT_EQ(logging::decode_binary_log(in, out), error::Error::OK);
+        ASSERT_EQ(out.str(), line(msg));
+    }
+}
+
+TEST_F(TestRotatingFileSink, open_failure)
+{
+    cfg.path = dir + "/missing/app.log";
+    logging::RotatingFileSink sink(cfg);
+    ASSERT_NE(sink.status(), error::Error::OK);
+    sink.write(record("dropped"));
+}
+
+} // namespace Tests
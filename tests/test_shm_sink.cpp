@@ -0,0 +1,251 @@
+#include <gtest/gtest.h>
+
+#include <slogger/DeferredFormat.hpp>
+#include <slogger/ShmCollector.hpp>
+#include <slogger/ShmSink.hpp>
+
+#include <algorithm>
+#include <filesystem>
+#include <format>
+#include <memory>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include <unistd.h>
+
+using namespace std::chrono_literals;
+
+namespace Tests
+{
+namespace
+{
+    /** keeps the text lines it is given */
+    class TextSink : public logging::ISink
+    {
+    public:
+        explicit TextSink(std::vector<std::string>& lines)
+            : m_lines(lines)
+        {
+        }
+
+        void write(const logging::SinkRecord& rec) override
+        {
+            std::string line;
+            logging::append_text_line(line, rec);
+            m_lines.push_back(std::move(line));
+        }
+
+    private:
+        std::vector<std::string>& m_lines;
+    };
+
+    logging::SinkRecord record(std::string_view msg, std::chrono::nanoseconds t)
+    {
+        return logging::SinkRecord { 7, "src/a.cpp", logging::Level::INFO, msg,
+            t };
+    }
+
+    std::string text_of(const logging::SinkRecord& rec)
+    {
+        std::string s;
+        logging::append_text_line(s, rec);
+        return s;
+    }
+
+    std::string ring_name(std::string_view tag)
+    {
+        return std::format("test.{}.{}", tag, getpid());
+    }
+
+    bool ring_exists(const std::string& name)
+    {
+        return std::filesystem::exists(std::string(logging::shm_log::SHM_DIR) +
+            "/" + std::string(logging::shm_log::PREFIX) + name);
+    }
+} // namespace
+
+class TestShmSink : public ::testing::Test
+{
+protected:
+    void TearDown() override
+    {
+        // removes the rings of the sinks gone by now
+        collector.flush();
+        collector.poll(10000s);
+    }
+
+    std::vector<std::string> lines;
+    logging::ShmCollector collector { std::make_unique<TextSink>(lines) };
+};
+
+TEST_F(TestShmSink, collector_writes_the_records_of_a_ring)
+{
+    const auto name = ring_name("text");
+    logging::ShmSink sink(name);
+    ASSERT_EQ(sink.status(), error::Error::OK);
+    ASSERT_EQ(collector.attach(name), error::Error::OK);
+
+    sink.write(record("one", 1s));
+    sink.write(record("two", 2s));
+    ASSERT_EQ(collector.poll(10s), 2u);
+    ASSERT_EQ(lines, (std::vector<std::string> { text_of(record("one", 1s)),
+                         text_of(record("two", 2s)) }));
+}
+
+TEST_F(TestShmSink, captured_arguments_are_formatted_by_the_collector)
+{
+    static constinit logging::LogSite site { "src/b.cpp", 20,
+        logging::Level::ERROR, "received {} bytes from {}" };
+    const auto id = site.get_id();
+    ASSERT_NE(id, logging::NO_LOG_SITE);
+
+    const uint32_t bytes = 1234;
+    const char* from = "192.168.1.1";
+    const std::tuple<const uint32_t&, const char* const&> refs(bytes, from);
+    const auto d = logging::make_deferred_args(site.fmt, refs);
+    std::string captured(d.size, '\0');
+    d.encode(reinterpret_cast<std::byte*>(captured.data()), d.args);
+
+    const auto name = ring_name("args");
+    logging::ShmSink sink(name);
+    ASSERT_EQ(collector.attach(name), error::Error::OK);
+    const logging::SinkRecord rec { site.line, site.file, site.level,
+        captured, 3600s, id, true };
+    sink.write(rec);
+    sink.write(rec);
+    collector.flush();
+    const auto expected = "src/b.cpp:20: [01:00:00.000000000] ERROR - "
+                          "received 1234 bytes from 192.168.1.1\n";
+    ASSERT_EQ(lines, (std::vector<std::string> { expected, expected }));
+}
+
+TEST_F(TestShmSink, merges_rings_by_time)
+{
+    const auto name_a = ring_name("a");
+    const auto name_b = ring_name("b");
+    logging::ShmSink a(name_a);
+    logging::ShmSink b(name_b);
+    ASSERT_EQ(collector.attach(name_a), error::Error::OK);
+    ASSERT_EQ(collector.attach(name_b), error::Error::OK);
+    ASSERT_EQ(collector.rings(), 2u);
+
+    a.write(record("a1", 1s));
+    a.write(record("a3", 3s));
+    b.write(record("b2", 2s));
+    // a3 waits: b may still send something older
+    ASSERT_EQ(collector.poll(3s), 2u);
+    b.write(record("b4", 4s));
+    ASSERT_EQ(collector.poll(4s), 1u);
+    // b4 is older than the reorder window by now
+    ASSERT_EQ(collector.poll(5s), 1u);
+    ASSERT_EQ(lines,
+        (std::vector<std::string> { text_of(record("a1", 1s)),
+            text_of(record("b2", 2s)), text_of(record("a3", 3s)),
+            text_of(record("b4", 4s)) }));
+}
+
+TEST_F(TestShmSink, full_ring_drops_and_counts)
+{
+    const auto name = ring_name("full");
+    logging::ShmSink sink(name);
+    ASSERT_EQ(collector.attach(name), error::Error::OK);
+
+    const std::string msg(1000, 'x');
+    const uint32_t count = logging::shm_log::RING_SIZE / 1000 + 100;
+    for (uint32_t i = 0; i < count; i++)
+    {
+        sink.write(record(msg, 1s));
+    }
+    ASSERT_GT(sink.dropped(), 0u);
+    collector.flush();
+    ASSERT_EQ(lines.size() + sink.dropped(), count);
+    ASSERT_EQ(collector.dropped(), sink.dropped());
+}
+
+TEST_F(TestShmSink, closed_ring_is_removed_once_read)
+{
+    const auto name = ring_name("closed");
+    {
+        logging::ShmSink sink(name);
+        ASSERT_EQ(collector.attach(name), error::Error::OK);
+        sink.write(record("last words", 1s));
+    }
+    ASSERT_TRUE(ring_exists(name));
+    collector.poll(10s);
+    ASSERT_EQ(lines.size(), 1u);
+    ASSERT_EQ(collector.rings(), 0u);
+    ASSERT_FALSE(ring_exists(name));
+}
+
+TEST_F(TestShmSink, ring_recreated_under_the_same_name_is_kept)
+{
+    const auto name = ring_name("reused");
+    auto old_sink = std::make_unique<logging::ShmSink>(name);
+    ASSERT_EQ(collector.attach(name), error::Error::OK);
+    old_sink->write(record("old", 1s));
+    old_sink.reset();
+
+    // the process restarted before the collector noticed
+    logging::ShmSink sink(name);
+    collector.poll(10s);
+    ASSERT_EQ(collector.rings(), 0u);
+    ASSERT_TRUE(ring_exists(name));
+
+    ASSERT_EQ(collector.attach(name), error::Error::OK);
+    sink.write(record("new", 2s));
+    collector.flush();
+    ASSERT_EQ(lines, (std::vector<std::string> { text_of(record("old", 1s)),
+                         text_of(record("new", 2s)) }));
+}
+
+TEST_F(TestShmSink, live_ring_is_not_replaced)
+{
+    const auto name = ring_name("live");
+    logging::ShmSink live(name);
+    ASSERT_EQ(live.status(), error::Error::OK);
+
+    logging::ShmSink second(name);
+    ASSERT_EQ(second.status(), error::Error::BUSY);
+    ASSERT_EQ(collector.attach(name), error::Error::OK);
+    second.write(record("dropped", 1s));
+    live.write(record("kept", 2s));
+    collector.flush();
+    ASSERT_EQ(lines, std::vector<std::string> { text_of(record("kept", 2s)) });
+
+    // no heartbeat for producer_timeout: taken for abandoned
+    live.poll(1s);
+    logging::ShmSink third(name);
+    ASSERT_EQ(third.status(), error::Error::OK);
+}
+
+TEST_F(TestShmSink, abandoned_ring_is_removed_after_the_timeout)
+{
+    const auto name = ring_name("abandoned");
+    logging::ShmSink sink(name);
+    ASSERT_EQ(collector.attach(name), error::Error::OK);
+    sink.write(record("before the crash", 1s));
+    sink.poll(100s);
+
+    collector.poll(100s + logging::ShmCollectorConfig().producer_timeout);
+    ASSERT_EQ(collector.rings(), 1u);
+    collector.poll(101s + logging::ShmCollectorConfig().producer_timeout);
+    ASSERT_EQ(collector.rings(), 0u);
+    ASSERT_EQ(lines.size(), 1u);
+    ASSERT_FALSE(ring_exists(name));
+}
+
+TEST_F(TestShmSink, attach_all_finds_the_rings)
+{
+    const auto name = ring_name("scan");
+    logging::ShmSink sink(name);
+    ASSERT_GE(collector.attach_all(), 1u);
+    ASSERT_EQ(collector.attach(name), error::Error::OK);
+    sink.write(record("found", 1s));
+    collector.flush();
+    // rings of other processes may have been found as well
+    const auto found = text_of(record("found", 1s));
+    ASSERT_NE(std::find(lines.begin(), lines.end(), found), lines.end());
+}
+
+} // namespace Tests
@@ -0,0 +1,137 @@
+#include <gtest/gtest.h>
+
+#include <slogger/DirectConsoleLogger.hpp>
+#include <slogger/ThreadBuffers.hpp>
+
+#include <format>
+#include <memory>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace Tests
+{
+
+TEST(TestThreadBuffers, each_thread_gets_its_own_buffer)
+{
+    auto& registry = logging::ThreadBufferRegistry::instance();
+
+    auto* main_buf = &registry.local_buffer();
+    ASSERT_EQ(main_buf, &registry.local_buffer());
+
+    logging::ThreadBuffer* other_buf = nullptr;
+    std::thread t([&]() { other_buf = &registry.local_buffer(); });
+    t.join();
+    ASSERT_NE(other_buf, main_buf);
+
+    // the exited thread's (empty) buffer is reclaimed by the next drain
+    const auto before = registry.count_buffers();
+    registry.drain(UINT32_MAX, [](const logging::LogEntry&) {});
+    ASSERT_EQ(registry.count_buffers(), before - 1);
+}
+
+TEST(TestThreadBuffers, drains_entries_of_exited_threads_then_reclaims)
+{
+    static constexpr uint32_t THREADS = 4;
+    static constexpr uint32_t PER_THREAD = 100;
+    auto& registry = logging::ThreadBufferRegistry::instance();
+    registry.drain(UINT32_MAX, [](const logging::LogEntry&) {});
+    const auto before = registry.count_buffers();
+
+    std::vector<std::thread> threads;
+    for (uint32_t t = 0; t < THREADS; t++)
+    {
+        threads.emplace_back([&registry, t]() {
+            for (uint32_t i = 0; i < PER_THREAD; i++)
+            {
+                registry.local_buffer().ring.add(logging::LogEntry {
+                    i, "thread", logging::Level::INFO, std::to_string(t) });
+            }
+        });
+    }
+    for (auto& t : threads)
+    {
+        t.join();
+    }
+    ASSERT_EQ(registry.count_buffers(), before + THREADS);
+
+    // a bounded drain leaves the rest queued and keeps the buffers alive
+    ASSERT_EQ(registry.drain(10, [](const logging::LogEntry&) {}), 10U);
+    ASSERT_GT(registry.count_buffers(), before);
+
+    std::vector<uint32_t> next(THREADS, 0);
+    uint32_t total = 10;
+    total += registry.drain(UINT32_MAX, [&](const logging::LogEntry& e) {
+        const auto t = std::stoul(e.msg);
+        ASSERT_LT(t, THREADS);
+        if (next[t] != 0)
+        {
+            ASSERT_EQ(e.line, next[t]);
+        }
+        next[t] = e.line + 1;
+    });
+    ASSERT_EQ(total, THREADS * PER_THREAD);
+    ASSERT_EQ(registry.count_buffers(), before);
+}
+
+TEST(TestThreadBuffers, logger_drains_short_lived_threads)
+{
+    /** keeps the messages it is given */
+    class MessageSink : public logging::ISink
+    {
+    public:
+        explicit MessageSink(std::set<std::string>& msgs)
+            : m_msgs(msgs)
+        {
+        }
+
+        void write(const logging::SinkRecord& rec) override
+        {
+            m_msgs.emplace(rec.msg);
+        }
+
+    private:
+        std::set<std::string>& m_msgs;
+    };
+
+    static constexpr uint32_t THREADS = 8;
+    static constexpr uint32_t PER_THREAD = 50;
+    auto& registry = logging::ThreadBufferRegistry::instance();
+    registry.drain(UINT32_MAX, [](const logging::LogEntry&) {});
+    const auto before = registry.count_buffers();
+
+    std::set<std::string> msgs;
+    logging::DirectConsoleLogger logger(true, true,
+        std::make_unique<MessageSink>(msgs),
+        logging::LogMode::THREAD_LOCAL_BUFFERS);
+
+    // one after another, so no buffer fills up before it is drained
+    for (uint32_t t = 0; t < THREADS; t++)
+    {
+        std::thread thread([&logger, t]() {
+            for (uint32_t i = 0; i < PER_THREAD; i++)
+            {
+                LOG_INFO(logger, "thread {} entry {}", t, i);
+            }
+        });
+        thread.join();
+        ASSERT_EQ(registry.count_buffers(), before + 1);
+        while (logger.poll(std::chrono::seconds(1)).remaining != 0)
+        {
+        }
+        // the exited thread's buffer was reclaimed once drained
+        ASSERT_EQ(registry.count_buffers(), before);
+    }
+
+    ASSERT_EQ(msgs.size(), THREADS * PER_THREAD);
+    for (uint32_t t = 0; t < THREADS; t++)
+    {
+        for (uint32_t i = 0; i < PER_THREAD; i++)
+        {
+            ASSERT_TRUE(msgs.contains(std::format("thread {} entry {}", t, i)));
+        }
+    }
+}
+
+} // namespace Tests
@@ -0,0 +1,94 @@
+#include <gtest/gtest.h>
+
+#include <slogger/TimestampFormatter.hpp>
+
+#include <chrono>
+#include <ctime>
+#include <format>
+#include <string>
+
+namespace Tests
+{
+using time_utils::TimestampFormatter;
+
+namespace
+{
+    /** the gmtime() based rendering the formatter replaces */
+    std::string reference(std::chrono::nanoseconds t, int digits = 9)
+    {
+        const auto secs = std::chrono::floor<std::chrono::seconds>(t);
+        const std::time_t tt = secs.count();
+        struct tm tm;
+        gmtime_r(&tt, &tm);
+        auto frac = (t - secs).count();
+        if (digits == 6)
+        {
+            return std::format("{:02}:{:02}:{:02}.{:06}", tm.tm_hour,
+                tm.tm_min, tm.tm_sec, frac / 1000);
+        }
+        return std::format("{:02}:{:02}:{:02}.{:09}", tm.tm_hour, tm.tm_min,
+            tm.tm_sec, frac);
+    }
+
+    std::string render(TimestampFormatter& f, std::chrono::nanoseconds t)
+    {
+        std::string out;
+        f.append(out, t);
+        return out;
+    }
+}
+
+TEST(TestTimestampFormatter, matches_gmtime_across_boundaries)
+{
+    using namespace std::chrono;
+    TimestampFormatter f;
+    // 2024-02-29 23:58:58, steps of 0.25s cross minute, hour and day
+    const nanoseconds start = seconds(1709251138);
+    for (int i = 0; i < 40; i++)
+    {
+        const auto t = start + milliseconds(250) * i + nanoseconds(7);
+        ASSERT_EQ(render(f, t), reference(t)) << i;
+    }
+}
+
+TEST(TestTimestampFormatter, handles_jumps_and_going_back)
+{
+    using namespace std::chrono;
+    TimestampFormatter f;
+    const nanoseconds times[] = { seconds(1700000000), seconds(1700000059),
+        seconds(1700003600) + nanoseconds(999999999), seconds(1700000001),
+        seconds(0), nanoseconds(-1), seconds(86399) };
+    for (const auto t : times)
+    {
+        EXPECT_EQ(render(f, t), reference(t));
+    }
+}
+
+TEST(TestTimestampFormatter, micros_precision)
+{
+    using namespace std::chrono;
+    TimestampFormatter f(TimestampFormatter::Precision::MICROS);
+    const nanoseconds t = seconds(1700000000) + nanoseconds(123456789);
+    EXPECT_EQ(f.size(), 15u);
+    EXPECT_EQ(render(f, t), reference(t, 6));
+    EXPECT_EQ(render(f, t), "22:13:20.123456");
+}
+
+TEST(TestTimestampFormatter, tai_time)
+{
+    TimestampFormatter f;
+    const time_utils::tai::nanoseconds t(
+        1700000037ULL * time_utils::tai::NANOS_PER_SEC + 5);
+    std::string out;
+    f.append(out, t);
+    EXPECT_EQ(out, "22:13:57.000000005");
+}
+
+TEST(TestTimestampFormatter, format_time_of_day)
+{
+    using namespace std::chrono;
+    const nanoseconds t = seconds(1700000000) + nanoseconds(42);
+    EXPECT_EQ(time_utils::format_time_of_day(t), reference(t));
+}
+
+} // namespace Tests
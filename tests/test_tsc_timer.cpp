@@ -0,0 +1,84 @@
+#include <gtest/gtest.h>
+
+#include <slogger/ClockRawTimer.hpp>
+#include <slogger/ThreadedLogger.hpp>
+#include <slogger/TimeUtils.hpp>
+#include <slogger/TscTimer.hpp>
+
+#include <chrono>
+#include <thread>
+
+using namespace std::chrono_literals;
+
+namespace Tests
+{
+
+TEST(TestTscTimer, follows_clock_monotonic_raw)
+{
+    const auto& tsc = time_utils::TscTimer::instance();
+    time_utils::ClockRawTimer raw;
+
+    for (int i = 0; i < 3; i++)
+    {
+        const auto diff = tsc.get_time_ns() - raw.get_time_ns();
+        ASSERT_LT(std::chrono::abs(diff), 1ms);
+        std::this_thread::sleep_for(10ms);
+    }
+    ASSERT_GT(tsc.ticks_per_ns(), 0.0);
+}
+
+TEST(TestTscTimer, ticks_are_ordered)
+{
+    const auto& tsc = time_utils::TscTimer::instance();
+    const auto t1 = tsc.now_ticks();
+    const auto t2 = tsc.now_ticks();
+    std::this_thread::sleep_for(1ms);
+    const auto t3 = tsc.now_ticks();
+
+    ASSERT_LE(t1, t2);
+    ASSERT_GE(tsc.to_ns(t3) - tsc.to_ns(t1), 1ms);
+}
+
+TEST(TestTscTimer, wall_clock_conversion)
+{
+    const auto& tsc = time_utils::TscTimer::instance();
+    const auto wall = tsc.to_wall_ns(tsc.now_ticks());
+    const auto now = std::chrono::system_clock::now().time_since_epoch();
+    ASSERT_LT(std::chrono::abs(now - wall), 10ms);
+
+    ASSERT_EQ(time_utils::format_time_of_day(3723s + 5ns),
+        "01:02:03.000000005");
+}
+
+TEST(TestTscTimer, calibration_and_wall_offset_updates)
+{
+    const auto& tsc = time_utils::TscTimer::instance();
+    tsc.calibrate();
+    // once calibrated this does not wait
+    const auto start = std::chrono::steady_clock::now();
+    tsc.calibrate();
+    ASSERT_LT(std::chrono::steady_clock::now() - start, 5ms);
+
+    tsc.update_wall_offset();
+    const auto wall = tsc.to_wall_ns(tsc.now_ticks());
+    const auto now = std::chrono::system_clock::now().time_since_epoch();
+    ASSERT_LT(std::chrono::abs(now - wall), 10ms);
+}
+
+TEST(TestTscTimer, entries_are_stamped_when_logged)
+{
+    logging::Hard_RT_RecordThreadedLogger logger(true, true);
+    const auto before = logging::now_ticks();
+    LOG_INFO(logger, "first");
+    logger.log(1, "src/a.cpp", logging::Level::ERROR, "second");
+    const auto after = logging::now_ticks();
+
+    auto e1 = logger.remove();
+    auto e2 = logger.remove();
+    ASSERT_TRUE(e1 && e2);
+    ASSERT_LE(before, e1->ticks);
+    ASSERT_LE(e1->ticks, e2->ticks);
+    ASSERT_LE(e2->ticks, after);
+}
+
+} // namespace Tests
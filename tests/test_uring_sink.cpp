@@ -0,0 +1,149 @@
+#include <gtest/gtest.h>
+
+#include <slogger/UringSink.hpp>
+
+#include <format>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace Tests
+{
+
+class TestUringSink : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        char tmpl[] = "/tmp/slogger_uring_XXXXXX";
+        fd = mkstemp(tmpl);
+        ASSERT_GE(fd, 0);
+        path = tmpl;
+    }
+
+    void TearDown() override
+    {
+        close(fd);
+        unlink(path.c_str());
+    }
+
+    std::string read_file() const
+    {
+        std::ifstream in(path, std::ios::binary);
+        std::stringstream ss;
+        ss << in.rdbuf();
+        return ss.str();
+    }
+
+    /** writes count records in batches of about 1KB
+     * @returns the text FdSink would have written
+     */
+    static std::string write_records(logging::UringSink& sink, uint32_t count)
+    {
+        std::string text;
+        for (uint32_t i = 0; i < count; i++)
+        {
+            const auto msg = std::format("message number {}", i);
+            const logging::SinkRecord rec { 12, "src/a.cpp",
+                logging::Level::INFO, msg, std::chrono::milliseconds(i) };
+            logging::append_text_line(text, rec);
+            sink.write(rec);
+        }
+        return text;
+    }
+
+    static logging::UringSinkConfig small_config()
+    {
+        logging::UringSinkConfig cfg;
+        cfg.sink.buffer_size = 1024;
+        cfg.queue_depth = 2;
+        return cfg;
+    }
+
+    int fd;
+    std::string path;
+};
+
+TEST_F(TestUringSink, writes_batches_in_order)
+{
+    std::string text;
+    {
+        logging::UringSink sink(fd, false, small_config());
+        text = write_records(sink, 5000);
+        sink.flush();
+        sink.wait_idle();
+        ASSERT_EQ(sink.in_flight(), 0u);
+        ASSERT_EQ(sink.failed(), 0u);
+        if (sink.uses_uring())
+        {
+            ASSERT_GT(sink.submitted(), 5000u * 40 / 1024);
+        }
+    }
+    ASSERT_EQ(read_file(), text);
+}
+
+TEST_F(TestUringSink, leaves_the_file_position_after_the_data)
+{
+    std::string text;
+    {
+        logging::UringSink sink(fd, false, small_config());
+        text = write_records(sink, 100);
+    }
+    ASSERT_EQ(write(fd, "tail\n", 5), 5);
+    ASSERT_EQ(read_file(), text + "tail\n");
+}
+
+TEST_F(TestUringSink, keeps_order_with_o_append)
+{
+    const int append_fd = open(path.c_str(), O_WRONLY | O_APPEND);
+    ASSERT_GE(append_fd, 0);
+    std::string text;
+    {
+        logging::UringSink sink(append_fd, true, small_config());
+        text = write_records(sink, 2000);
+    }
+    ASSERT_EQ(read_file(), text);
+}
+
+TEST_F(TestUringSink, keeps_order_on_a_pipe)
+{
+    int fds[2];
+    ASSERT_EQ(pipe(fds), 0);
+    std::string received;
+    std::thread reader([&] {
+        char buf[4096];
+        ssize_t n;
+        while ((n = read(fds[0], buf, sizeof(buf))) > 0)
+        {
+            received.append(buf, n);
+        }
+    });
+    std::string text;
+    {
+        logging::UringSink sink(fds[1], true, small_config());
+        text = write_records(sink, 2000);
+    }
+    reader.join();
+    close(fds[0]);
+    ASSERT_EQ(received, text);
+}
+
+TEST_F(TestUringSink, splits_a_batch_larger_than_a_buffer)
+{
+    const std::string msg(5000, 'x');
+    const logging::SinkRecord rec { 1, "src/a.cpp", logging::Level::ERROR,
+        msg, std::chrono::seconds(1) };
+    std::string text;
+    logging::append_text_line(text, rec);
+    {
+        logging::UringSink sink(fd, false, small_config());
+        sink.write(rec);
+    }
+    ASSERT_EQ(read_file(), text);
+}
+
+} // namespace Tests
@@ -0,0 +1,125 @@
+/**
+ * @file slogger_collector.cpp
+ * @brief Collects the logs of processes writing through ShmSink: reads
+ * their shared memory rings, merges the records by time and writes them as
+ * text to one output.
+ *
+ * usage: slogger-collector [-o FILE] [-w WINDOW_MS] [NAME...]
+ * Without names every ring in /dev/shm is collected, new ones are picked up
+ * as they appear. Writes to stdout without -o, stops on SIGINT or SIGTERM.
+ */
+
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <slogger/FdSink.hpp>
+#include <slogger/ShmCollector.hpp>
+
+
+namespace
+{
+std::atomic<bool> g_stop { false };
+
+void on_signal(int)
+{
+    g_stop = true;
+}
+
+int usage()
+{
+    std::cerr << "usage: slogger-collector [-o FILE] [-w WINDOW_MS] "
+                 "[NAME...]\n";
+    return 2;
+}
+} // namespace
+
+
+int main(int argc, char** argv)
+{
+    std::string output;
+    logging::ShmCollectorConfig cfg;
+    std::vector<std::string> names;
+    for (int i = 1; i < argc; i++)
+    {
+        const std::string arg = argv[i];
+        if ((arg == "-o" || arg == "-w") && i + 1 == argc)
+        {
+            return usage();
+        }
+        if (arg == "-o")
+        {
+            output = argv[++i];
+        }
+        else if (arg == "-w")
+        {
+            cfg.reorder_window =
+                std::chrono::milliseconds(std::atoi(argv[++i]));
+        }
+        else if (arg.starts_with("-"))
+        {
+            return usage();
+        }
+        else
+        {
+            names.push_back(arg);
+        }
+    }
+
+    int fd = STDOUT_FILENO;
+    if (!output.empty())
+    {
+        fd = open(output.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC,
+            0644);
+        if (fd < 0)
+        {
+            std::cerr << "slogger-collector: cannot open " << output << "\n";
+            return 1;
+        }
+    }
+    logging::ShmCollector collector(
+        std::make_unique<logging::FdSink>(fd, fd != STDOUT_FILENO), cfg);
+
+    std::signal(SIGINT, on_signal);
+    std::signal(SIGTERM, on_signal);
+
+    constexpr auto ATTACH_PERIOD = std::chrono::milliseconds(500);
+    auto next_attach = std::chrono::steady_clock::time_point();
+    while (!g_stop)
+    {
+        const auto now = std::chrono::steady_clock::now();
+        if (now >= next_attach)
+        {
+            if (names.empty())
+            {
+                collector.attach_all();
+            }
+            for (const auto& name : names)
+            {
+                collector.attach(name);
+            }
+            next_attach = now + ATTACH_PERIOD;
+        }
+        const auto wall = std::chrono::system_clock::now().time_since_epoch();
+        if (collector.poll(wall) == 0)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }
+    collector.flush();
+    if (collector.dropped() != 0)
+    {
+        std::cerr << "slogger-collector: producers dropped "
+                  << collector.dropped() << " records\n";
+    }
+    return 0;
+}
@@ -0,0 +1,73 @@
+/**
+ * @file slogger_decode.cpp
+ * @brief Converts binary logs written by BinarySink, and compressed logs
+ * written by CompressedFileSink, back into text lines.
+ *
+ * usage: slogger-decode [FILE...], reads stdin without arguments.
+ */
+
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string_view>
+
+#include <slogger/BinaryLog.hpp>
+#include <slogger/CompressedLog.hpp>
+
+
+namespace
+{
+/** @param in must be seekable, the format is told by the magic bytes */
+int decode(std::istream& in, const char* name)
+{
+    char magic[8] = {};
+    in.read(magic, sizeof(magic));
+    in.clear();
+    in.seekg(0);
+
+    const auto err =
+        std::string_view(magic, sizeof(magic)) == logging::compressed_log::MAGIC
+        ? logging::decode_compressed_log(in, std::cout)
+        : logging::decode_binary_log(in, std::cout);
+    if (err == error::Error::RANGE)
+    {
+        std::cerr << "slogger-decode: " << name
+                  << ": written on a host of the other byte order\n";
+        return 1;
+    }
+    if (err != error::Error::OK)
+    {
+        std::cerr << "slogger-decode: " << name
+                  << ": not a binary or compressed log, or corrupt\n";
+        return 1;
+    }
+    return 0;
+}
+} // namespace
+
+
+int main(int argc, char** argv)
+{
+    std::ios::sync_with_stdio(false);
+    if (argc < 2)
+    {
+        // a pipe cannot seek back over the magic bytes
+        std::stringstream in;
+        in << std::cin.rdbuf();
+        return decode(in, "<stdin>");
+    }
+
+    int status = 0;
+    for (int i = 1; i < argc; i++)
+    {
+        std::ifstream in(argv[i], std::ios::binary);
+        if (!in)
+        {
+            std::cerr << "slogger-decode: cannot open " << argv[i] << "\n";
+            status = 1;
+            continue;
+        }
+        status |= decode(in, argv[i]);
+    }
+    return status;
+}